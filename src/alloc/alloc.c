@@ -0,0 +1,106 @@
+#include "alloc.h"
+#ifdef OS_WINDOWS
+#	define HARBOL_LIB
+#endif
+
+
+HARBOL_THREAD_LOCAL const struct HarbolAllocator *g_allocator;
+
+/// external definitions of the inline allocation functions, for callers the compiler doesn't inline into.
+extern void *harbol_raw_alloc(size_t num, size_t size);
+extern void *harbol_raw_realloc(void *ptr, size_t bytes);
+extern void harbol_raw_free(void *ptr);
+#ifdef HARBOL_ALLOC_STATS
+extern void *harbol_alloc_in(size_t num, size_t size, enum HarbolAllocCategory category);
+extern void *harbol_realloc_in(void *ptr, size_t bytes, enum HarbolAllocCategory category);
+#else
+extern void *harbol_alloc(size_t num, size_t size);
+extern void *harbol_realloc(void *ptr, size_t bytes);
+#endif
+extern void harbol_free(void *ptr);
+extern void harbol_clean(void **ptrref);
+
+static const char *const g_category_names[HarbolAllocCategory_Count] = {
+	"other", "string", "vector", "map", "cfg", "token"
+};
+
+#ifdef HARBOL_ALLOC_STATS
+/// not atomic, meant for profiling single-threaded runs.
+static struct HarbolAllocStats g_stats[HarbolAllocCategory_Count], g_total;
+
+static void _record(struct HarbolAllocStats *const stats, const size_t old_bytes, const size_t new_bytes)
+{
+	if( old_bytes==0 && new_bytes > 0 )
+		stats->allocs++;
+	else if( new_bytes==0 )
+		stats->frees++;
+	else stats->reallocs++;
+	
+	if( new_bytes > old_bytes )
+		stats->bytes += new_bytes - old_bytes;
+	stats->live_bytes = stats->live_bytes - old_bytes + new_bytes;
+	if( stats->live_bytes > stats->peak_bytes )
+		stats->peak_bytes = stats->live_bytes;
+}
+
+void harbol_alloc_stats_record(const enum HarbolAllocCategory category, const size_t old_bytes, const size_t new_bytes)
+{
+	_record(&g_stats[( category < HarbolAllocCategory_Count ) ? category : HarbolAllocCategory_Other], old_bytes, new_bytes);
+	_record(&g_total, old_bytes, new_bytes);
+}
+#endif
+
+
+HARBOL_EXPORT bool harbol_alloc_get_stats(const enum HarbolAllocCategory category, struct HarbolAllocStats *const stats)
+{
+#ifdef HARBOL_ALLOC_STATS
+	if( category >= HarbolAllocCategory_Count )
+		return false;
+	*stats = g_stats[category];
+	return true;
+#else
+	( void )category;
+	memset(stats, 0, sizeof *stats);
+	return false;
+#endif
+}
+
+HARBOL_EXPORT bool harbol_alloc_get_total_stats(struct HarbolAllocStats *const stats)
+{
+#ifdef HARBOL_ALLOC_STATS
+	*stats = g_total;
+	return true;
+#else
+	memset(stats, 0, sizeof *stats);
+	return false;
+#endif
+}
+
+HARBOL_EXPORT void harbol_alloc_reset_stats(void)
+{
+#ifdef HARBOL_ALLOC_STATS
+	for( size_t i=0; i<=HarbolAllocCategory_Count; i++ ) {
+		struct HarbolAllocStats *const stats = ( i < HarbolAllocCategory_Count ) ? &g_stats[i] : &g_total;
+		const size_t live = stats->live_bytes;
+		memset(stats, 0, sizeof *stats);
+		stats->live_bytes = stats->peak_bytes = live;
+	}
+#endif
+}
+
+HARBOL_EXPORT const char *harbol_alloc_category_name(const enum HarbolAllocCategory category)
+{
+	return( category < HarbolAllocCategory_Count ) ? g_category_names[category] : NULL;
+}
+
+HARBOL_EXPORT const struct HarbolAllocator *harbol_allocator_swap(const struct HarbolAllocator *const allocator)
+{
+	const struct HarbolAllocator *const prev = g_allocator;
+	g_allocator = allocator;
+	return prev;
+}
+
+HARBOL_EXPORT const struct HarbolAllocator *harbol_allocator_get(void)
+{
+	return g_allocator;
+}
@@ -0,0 +1,36 @@
+#ifndef HARBOL_ALLOC_INCLUDED
+#	define HARBOL_ALLOC_INCLUDED
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "../harbol_common_defines.h"
+#include "../harbol_common_includes.h"
+
+
+/// counters for one allocation category, all byte counts are requested bytes.
+struct HarbolAllocStats {
+	size_t allocs, reallocs, frees;
+	size_t bytes, live_bytes, peak_bytes;
+};
+
+/// false if the library was built without HARBOL_ALLOC_STATS.
+HARBOL_EXPORT NO_NULL bool harbol_alloc_get_stats(enum HarbolAllocCategory category, struct HarbolAllocStats *stats);
+HARBOL_EXPORT NO_NULL bool harbol_alloc_get_total_stats(struct HarbolAllocStats *stats);
+
+/// zeroes the call & byte counters, live bytes are kept and peaks restart from them.
+HARBOL_EXPORT void harbol_alloc_reset_stats(void);
+
+HARBOL_EXPORT const char *harbol_alloc_category_name(enum HarbolAllocCategory category);
+
+/// installs `allocator` (NULL for the built-in one) for the calling thread & returns the one it replaced.
+HARBOL_EXPORT const struct HarbolAllocator *harbol_allocator_swap(const struct HarbolAllocator *allocator);
+HARBOL_EXPORT const struct HarbolAllocator *harbol_allocator_get(void);
+/********************************************************************/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HARBOL_ALLOC_INCLUDED */
@@ -0,0 +1,101 @@
+/// lexeme storage is the arena's only user, so its chunks count as token allocations.
+#define HARBOL_ALLOC_CATEGORY    HarbolAllocCategory_Token
+#include <stddef.h>
+#include "arena.h"
+#ifdef OS_WINDOWS
+#	define HARBOL_LIB
+#endif
+
+
+union HarbolArenaAlign {
+	long double align_ld;
+	intmax_t align_int;
+	void *align_ptr;
+};
+
+struct HarbolArenaChunk {
+	struct HarbolArenaChunk *next;
+	size_t size, used;
+	union HarbolArenaAlign data[];   /// allocations start here.
+};
+
+#define HARBOL_ARENA_ALIGN    (sizeof(union HarbolArenaAlign))
+
+
+HARBOL_EXPORT struct HarbolArena harbol_arena_create(const size_t chunk_size)
+{
+	struct HarbolArena arena = { .chunk_size = ( chunk_size==0 ) ? HARBOL_ARENA_CHUNK_SIZE : chunk_size };
+	return arena;
+}
+
+HARBOL_EXPORT void harbol_arena_clear(struct HarbolArena *const arena)
+{
+	for( struct HarbolArenaChunk *chunk = arena->head; chunk != NULL; ) {
+		struct HarbolArenaChunk *next = chunk->next;
+		harbol_free(chunk), chunk=NULL;
+		chunk = next;
+	}
+	arena->head = arena->curr = NULL;
+	arena->held = 0;
+}
+
+HARBOL_EXPORT void harbol_arena_reset(struct HarbolArena *const arena)
+{
+	/// later chunks are rewound as the arena reaches them again.
+	arena->curr = arena->head;
+	if( arena->head != NULL )
+		arena->head->used = 0;
+}
+
+HARBOL_EXPORT void *harbol_arena_alloc(struct HarbolArena *const arena, const size_t bytes)
+{
+	const size_t block_size = harbol_align_size(( bytes==0 ) ? 1 : bytes, HARBOL_ARENA_ALIGN);
+	struct HarbolArenaChunk *chunk = arena->curr;
+	while( chunk != NULL && chunk->size - chunk->used < block_size ) {
+		chunk = chunk->next;
+		if( chunk != NULL )
+			chunk->used = 0;
+	}
+	
+	if( chunk==NULL ) {
+		const size_t chunk_size = ( arena->chunk_size==0 ) ? HARBOL_ARENA_CHUNK_SIZE : arena->chunk_size;
+		const size_t data_size = ( block_size > chunk_size ) ? block_size : chunk_size;
+		chunk = harbol_alloc(sizeof *chunk + data_size, sizeof(uint8_t));
+		if( chunk==NULL )
+			return NULL;
+		
+		chunk->size = data_size;
+		chunk->used = 0;
+		/// splice in after the current chunk so chunks past it stay reachable for reuse.
+		if( arena->curr==NULL ) {
+			chunk->next = arena->head;
+			arena->head = chunk;
+		} else {
+			chunk->next = arena->curr->next;
+			arena->curr->next = chunk;
+		}
+		arena->held += data_size;
+	}
+	arena->curr = chunk;
+	
+	uint8_t *const block = ( uint8_t* )(chunk->data) + chunk->used;
+	chunk->used += block_size;
+	return block;
+}
+
+HARBOL_EXPORT char *harbol_arena_dup(struct HarbolArena *const arena, const char str[const], const size_t len)
+{
+	char *const dup = harbol_arena_alloc(arena, len + 1);
+	if( dup==NULL )
+		return NULL;
+	
+	if( len > 0 )
+		memcpy(dup, str, len);
+	dup[len] = 0;
+	return dup;
+}
+
+HARBOL_EXPORT size_t harbol_arena_mem_held(const struct HarbolArena *const arena)
+{
+	return arena->held;
+}
@@ -0,0 +1,51 @@
+#ifndef HARBOL_ARENA_INCLUDED
+#	define HARBOL_ARENA_INCLUDED
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "../harbol_common_defines.h"
+#include "../harbol_common_includes.h"
+
+
+#ifndef HARBOL_ARENA_CHUNK_SIZE
+#	define HARBOL_ARENA_CHUNK_SIZE    (64u * 1024u)
+#endif
+
+
+struct HarbolArenaChunk;
+
+/* bump allocator: allocations are carved linearly out of chunks and are never freed one by one.
+ * resetting rewinds to the first chunk and keeps every chunk for reuse.
+ * a zeroed arena is valid and uses the default chunk size.
+ */
+struct HarbolArena {
+	struct HarbolArenaChunk *head, *curr;
+	size_t chunk_size, held;
+};
+
+
+HARBOL_EXPORT struct HarbolArena harbol_arena_create(size_t chunk_size);
+
+/// returns all chunks to the system.
+HARBOL_EXPORT NO_NULL void harbol_arena_clear(struct HarbolArena *arena);
+
+/// frees every allocation at once in O(1), keeping the chunks for reuse.
+HARBOL_EXPORT NO_NULL void harbol_arena_reset(struct HarbolArena *arena);
+
+/// memory is NOT zeroed & is aligned for any basic type.
+HARBOL_EXPORT NO_NULL void *harbol_arena_alloc(struct HarbolArena *arena, size_t bytes);
+
+/// copies `len` bytes of `str` & null terminates the copy.
+HARBOL_EXPORT NEVER_NULL(1) char *harbol_arena_dup(struct HarbolArena *arena, const char str[], size_t len);
+
+/// bytes held from the system.
+HARBOL_EXPORT NO_NULL size_t harbol_arena_mem_held(const struct HarbolArena *arena);
+/********************************************************************/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HARBOL_ARENA_INCLUDED */
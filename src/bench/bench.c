@@ -0,0 +1,356 @@
+#ifndef _POSIX_C_SOURCE
+#	define _POSIX_C_SOURCE 200809L
+#endif
+
+#include <time.h>
+#include <sys/resource.h>
+#include "../targum_lexer.h"
+
+/* Targum Lexer end-to-end benchmark.
+ * Lexes each corpus repeatedly in C-style and Go-style mode and prints the results as JSON.
+ * Allocations are counted by wrapping the libc allocator at link time (see the `bench` make target).
+ */
+
+#define BENCH_HUGE_SIZE       (4u * 1024u * 1024u)
+#define BENCH_SYNTH_SIZE      (512u * 1024u)
+#define BENCH_MIN_SECONDS     0.5
+#define BENCH_MIN_RUNS        3
+
+#ifdef HARBOL_USE_MEMPOOL
+#	define BENCH_ALLOCATOR    "mempool"
+#else
+#	define BENCH_ALLOCATOR    "libc"
+#endif
+
+/// count of heap allocations (malloc/calloc/realloc) made through the libc allocator.
+static size_t g_alloc_count;
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t count, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+
+void *__wrap_malloc(const size_t size)
+{
+	g_alloc_count++;
+	return __real_malloc(size);
+}
+
+void *__wrap_calloc(const size_t count, const size_t size)
+{
+	g_alloc_count++;
+	return __real_calloc(count, size);
+}
+
+void *__wrap_realloc(void *const ptr, const size_t size)
+{
+	g_alloc_count++;
+	return __real_realloc(ptr, size);
+}
+
+
+struct BenchCorpus {
+	const char *name;
+	struct HarbolString text;
+	bool whitespace;
+};
+
+struct BenchResult {
+	size_t bytes, tokens, runs, allocs;
+	double seconds, best_seconds;
+	long peak_rss_kb;
+	bool ok, has_alloc_stats;
+	struct HarbolAllocStats alloc_stats[HarbolAllocCategory_Count];
+};
+
+static double _now(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/// peak RSS of the whole process so far, `_reset_case_peak_rss` doesn't touch `ru_maxrss` so this never goes down.
+static long _peak_rss_kb(void)
+{
+	struct rusage usage;
+	return( getrusage(RUSAGE_SELF, &usage)==0 ) ? usage.ru_maxrss : -1;
+}
+
+/// resets the kernel's RSS high-water mark, false where that isn't supported (non-Linux or an old kernel).
+static bool _reset_case_peak_rss(void)
+{
+	FILE *restrict file = fopen("/proc/self/clear_refs", "w");
+	if( file==NULL )
+		return false;
+	const bool written = fputs("5", file) != EOF;
+	return (fclose(file)==0) && written;
+}
+
+/// peak RSS since the last `_reset_case_peak_rss`, -1 if it's unknown.
+static long _case_peak_rss_kb(const bool was_reset)
+{
+	long peak_kb = -1;
+	FILE *restrict file = was_reset ? fopen("/proc/self/status", "r") : NULL;
+	if( file==NULL )
+		return peak_kb;
+	
+	char line[256];
+	while( fgets(line, sizeof line, file) != NULL && sscanf(line, "VmHWM: %ld kB", &peak_kb) != 1 );
+	fclose(file);
+	return peak_kb;
+}
+
+/// small LCG so the synthetic corpora are the same on every run.
+static uint32_t _rand(uint64_t *const state)
+{
+	*state = *state * 6364136223846793005ull + 1442695040888963407ull;
+	return ( uint32_t )(*state >> 33);
+}
+
+static NO_NULL void _make_repeated(struct HarbolString *const out, const struct HarbolString *const sample, const size_t size)
+{
+	while( out->len < size ) {
+		harbol_string_add_str(out, sample);
+		harbol_string_add_char(out, '\n');
+	}
+}
+
+static NO_NULL void _make_comment_heavy(struct HarbolString *const out, const size_t size)
+{
+	static const char *const words[] = { "lexer", "token", "config", "buffer", "stream", "parse", "offset", "cache", "table", "value" };
+	uint64_t seed = 0xc0ffee;
+	while( out->len < size ) {
+		const uint32_t r = _rand(&seed);
+		if( r % 3==0 ) {
+			harbol_string_add_cstr(out, "/*");
+			for( uint32_t i=0; i < 8 + r % 24; i++ )
+				harbol_string_add_format(out, "%s%s", (i % 8==7) ? "\n * " : " ", words[_rand(&seed) % 10]);
+			harbol_string_add_cstr(out, " */\n");
+		} else {
+			harbol_string_add_cstr(out, "//");
+			for( uint32_t i=0; i < 4 + r % 12; i++ )
+				harbol_string_add_format(out, " %s", words[_rand(&seed) % 10]);
+			harbol_string_add_char(out, '\n');
+		}
+		if( r % 5==0 )
+			harbol_string_add_format(out, "int %s_%u = %u;\n", words[r % 10], r % 1000, r % 100);
+	}
+}
+
+static NO_NULL void _make_literal_heavy(struct HarbolString *const out, const size_t size)
+{
+	uint64_t seed = 0x1234abcd;
+	while( out->len < size ) {
+		harbol_string_add_cstr(out, "x = {");
+		for( uint32_t i=0; i<16; i++ ) {
+			const uint32_t r = _rand(&seed);
+			switch( r % 6 ) {
+				case 0: harbol_string_add_format(out, " %u,", r % 100000); break;
+				case 1: harbol_string_add_format(out, " 0x%x,", r); break;
+				case 2: harbol_string_add_format(out, " %u.%ue%u,", r % 1000, r % 97, r % 20); break;
+				case 3: harbol_string_add_format(out, " \"str %u\\t\\\"q\\\"\\n\",", r % 1000); break;
+				case 4: harbol_string_add_format(out, " '%c',", 'a' + r % 26); break;
+				case 5: harbol_string_add_cstr(out, " '\\n',"); break;
+			}
+		}
+		harbol_string_add_cstr(out, " };\n");
+	}
+}
+
+/// turns on whitespace tokens by splicing a whitespace section in front of the keywords.
+static NO_NULL struct HarbolLinkMap *_parse_cfg(const struct HarbolString *const cfg_text, const bool whitespace)
+{
+	if( !whitespace )
+		return harbol_cfg_parse_cstr(harbol_string_cstr(cfg_text));
+
+	const char *const keywords = strstr(harbol_string_cstr(cfg_text), "'keywords'");
+	if( keywords==NULL )
+		return NULL;
+
+	struct HarbolString spliced = EMPTY_HARBOL_STRING;
+	for( const char *iter = harbol_string_cstr(cfg_text); iter < keywords; iter++ )
+		harbol_string_add_char(&spliced, *iter);
+	harbol_string_add_cstr(&spliced, "'whitespace': { 'space': 1000 'tab': 1001 'newline': 1002 }\n\t");
+	harbol_string_add_cstr(&spliced, keywords);
+	struct HarbolLinkMap *const cfg = harbol_cfg_parse_cstr(harbol_string_cstr(&spliced));
+	harbol_string_clear(&spliced);
+	return cfg;
+}
+
+static NO_NULL void _rewind_lexer(struct TargumLexer *const lexer)
+{
+	targum_lexer_clear_tokens(lexer);
+	harbol_vector_clear_TargumDiagnostic(&lexer->diags);
+	lexer->iter = lexer->line_start = harbol_string_cstr(&lexer->src);
+	lexer->line = 1;
+	lexer->curr_tok = NULL;
+}
+
+static NO_NULL struct BenchResult _run(const struct BenchCorpus *const corpus, struct HarbolLinkMap *const cfg, const size_t min_runs, const double min_seconds)
+{
+	struct BenchResult result = { .bytes = corpus->text.len, .best_seconds = 1e30 };
+	const bool rss_reset = _reset_case_peak_rss();
+	struct TargumLexer lexer = targum_lexer_create_from_buffer(harbol_string_cstr(&corpus->text), cfg);
+
+	/// warm up: compiles the lexer tables and faults in the source.
+	result.ok = targum_lexer_generate_tokens(&lexer);
+	result.tokens = targum_lexer_get_token_count(&lexer);
+
+	harbol_alloc_reset_stats();
+	while( result.runs < min_runs || result.seconds < min_seconds ) {
+		_rewind_lexer(&lexer);
+		const size_t allocs = g_alloc_count;
+		const double start = _now();
+		result.ok &= targum_lexer_generate_tokens(&lexer);
+		const double elapsed = _now() - start;
+		result.allocs += g_alloc_count - allocs;
+		result.seconds += elapsed;
+		if( elapsed < result.best_seconds )
+			result.best_seconds = elapsed;
+		result.runs++;
+	}
+	result.peak_rss_kb = _case_peak_rss_kb(rss_reset);
+	for( size_t i=0; i<HarbolAllocCategory_Count; i++ )
+		result.has_alloc_stats = harbol_alloc_get_stats(i, &result.alloc_stats[i]);
+	targum_lexer_clear(&lexer, false);
+	return result;
+}
+
+/// the cfg workload: parsing the config text over and over.
+static NO_NULL struct BenchResult _run_cfg(const struct HarbolString *const cfg_text, const size_t min_runs, const double min_seconds)
+{
+	struct BenchResult result = { .bytes = cfg_text->len, .best_seconds = 1e30, .ok = true };
+	const bool rss_reset = _reset_case_peak_rss();
+	while( result.runs < min_runs || result.seconds < min_seconds ) {
+		const size_t allocs = g_alloc_count;
+		const double start = _now();
+		struct HarbolLinkMap *cfg = harbol_cfg_parse_cstr(harbol_string_cstr(cfg_text));
+		result.ok &= cfg != NULL;
+		harbol_cfg_free(&cfg);
+		const double elapsed = _now() - start;
+		result.allocs += g_alloc_count - allocs;
+		result.seconds += elapsed;
+		if( elapsed < result.best_seconds )
+			result.best_seconds = elapsed;
+		result.runs++;
+	}
+	result.peak_rss_kb = _case_peak_rss_kb(rss_reset);
+	return result;
+}
+
+static NO_NULL void _print_result(const char corpus[static 1], const char mode[static 1], const struct BenchResult *const r, const bool last)
+{
+	const double mean = r->seconds / r->runs;
+	printf("\t\t{ \"corpus\": \"%s\", \"mode\": \"%s\", \"ok\": %s, \"bytes\": %zu, \"tokens\": %zu, \"runs\": %zu,"
+		" \"mean_seconds\": %.9f, \"best_seconds\": %.9f, \"mb_per_s\": %.3f, \"tokens_per_s\": %.1f, \"ns_per_token\": %.3f,"
+		" \"allocs_per_token\": %.3f, \"peak_rss_kb\": %ld",
+		corpus, mode, r->ok ? "true" : "false", r->bytes, r->tokens, r->runs,
+		mean, r->best_seconds, (r->bytes / (1024.0 * 1024.0)) / mean, r->tokens / mean, (mean * 1e9) / r->tokens,
+		( double )r->allocs / (( double )r->tokens * r->runs), r->peak_rss_kb);
+	
+	/// only with a HARBOL_ALLOC_STATS build: per category calls & bytes per run.
+	if( r->has_alloc_stats ) {
+		printf(", \"alloc_categories\": {");
+		for( size_t i=0; i<HarbolAllocCategory_Count; i++ ) {
+			const struct HarbolAllocStats *const st = &r->alloc_stats[i];
+			printf("%s \"%s\": { \"allocs\": %zu, \"reallocs\": %zu, \"frees\": %zu, \"bytes\": %zu, \"peak_bytes\": %zu }",
+				i > 0 ? "," : "", harbol_alloc_category_name(i),
+				st->allocs / r->runs, st->reallocs / r->runs, st->frees / r->runs, st->bytes / r->runs, st->peak_bytes);
+		}
+		printf(" }");
+	}
+	printf(" }%s\n", last ? "" : ",");
+}
+
+int32_t main(const int32_t argc, char *argv[restrict static 1])
+{
+	const char *cfg_file = "tokens.cfg", *sample_file = "test.txt";
+	size_t min_runs = BENCH_MIN_RUNS;
+	double min_seconds = BENCH_MIN_SECONDS;
+	for( int32_t i=1; i<argc; i++ ) {
+		if( !strcmp(argv[i], "--help") ) {
+			puts("Targum Lexer Benchmark - 'targum_bench [--cfg tokens.cfg] [--sample test.txt] [--runs N] [--seconds S]'");
+			return 0;
+		} else if( !strcmp(argv[i], "--cfg") && i + 1 < argc ) {
+			cfg_file = argv[++i];
+		} else if( !strcmp(argv[i], "--sample") && i + 1 < argc ) {
+			sample_file = argv[++i];
+		} else if( !strcmp(argv[i], "--runs") && i + 1 < argc ) {
+			min_runs = strtoul(argv[++i], NULL, 10);
+		} else if( !strcmp(argv[i], "--seconds") && i + 1 < argc ) {
+			min_seconds = strtod(argv[++i], NULL);
+		} else {
+			fprintf(stderr, "Targum Lexer Benchmark Error: unknown option '%s'.\n", argv[i]);
+			return -1;
+		}
+	}
+	if( min_runs==0 )
+		min_runs = 1;
+
+	struct HarbolString cfg_text = EMPTY_HARBOL_STRING, sample = EMPTY_HARBOL_STRING;
+	FILE *restrict file = fopen(cfg_file, "r");
+	const bool cfg_read = file != NULL && harbol_string_read_file(&cfg_text, file);
+	if( file != NULL )
+		fclose(file), file=NULL;
+	file = fopen(sample_file, "r");
+	const bool sample_read = file != NULL && harbol_string_read_file(&sample, file);
+	if( file != NULL )
+		fclose(file), file=NULL;
+	if( !cfg_read || !sample_read ) {
+		fprintf(stderr, "Targum Lexer Benchmark Error: failed to read '%s'.\n", !cfg_read ? cfg_file : sample_file);
+		harbol_string_clear(&cfg_text);
+		harbol_string_clear(&sample);
+		return -1;
+	}
+
+	struct BenchCorpus corpora[] = {
+		{ "small",         EMPTY_HARBOL_STRING, false },
+		{ "huge",          EMPTY_HARBOL_STRING, false },
+		{ "comment-heavy", EMPTY_HARBOL_STRING, false },
+		{ "literal-heavy", EMPTY_HARBOL_STRING, false },
+		{ "whitespace-on", EMPTY_HARBOL_STRING, true  },
+	};
+	harbol_string_copy_str(&corpora[0].text, &sample);
+	_make_repeated(&corpora[1].text, &sample, BENCH_HUGE_SIZE);
+	_make_comment_heavy(&corpora[2].text, BENCH_SYNTH_SIZE);
+	_make_literal_heavy(&corpora[3].text, BENCH_SYNTH_SIZE);
+	harbol_string_copy_str(&corpora[4].text, &sample);
+
+	const size_t corpus_count = sizeof corpora / sizeof corpora[0];
+	printf("{\n\t\"version\": \"%s\",\n\t\"allocator\": \"%s\",\n\t\"config\": \"%s\",\n\t\"sample\": \"%s\",\n\t\"results\": [\n", TARGUM_LEXER_VERSION_STRING, BENCH_ALLOCATOR, cfg_file, sample_file);
+	int32_t status = 0;
+	long peak_rss_kb = -1;
+	for( size_t i=0; i<corpus_count; i++ ) {
+		for( size_t golang=0; golang<2; golang++ ) {
+			struct HarbolLinkMap *cfg = _parse_cfg(&cfg_text, corpora[i].whitespace);
+			if( cfg==NULL || !harbol_cfg_set_bool(cfg, "tokens.use golang-style", golang, true) ) {
+				fprintf(stderr, "Targum Lexer Benchmark Error: failed to load config '%s'.\n", cfg_file);
+				harbol_cfg_free(&cfg);
+				status = -1;
+				continue;
+			}
+			const struct BenchResult result = _run(&corpora[i], cfg, min_runs, min_seconds);
+			_print_result(corpora[i].name, golang ? "go" : "c", &result, i + 1==corpus_count && golang==1);
+			if( result.peak_rss_kb > peak_rss_kb )
+				peak_rss_kb = result.peak_rss_kb;
+			harbol_cfg_free(&cfg);
+		}
+	}
+	const struct BenchResult cfg_result = _run_cfg(&cfg_text, min_runs, min_seconds);
+	const double cfg_mean = cfg_result.seconds / cfg_result.runs;
+	printf("\t],\n\t\"cfg_parse\": { \"ok\": %s, \"bytes\": %zu, \"runs\": %zu, \"mean_seconds\": %.9f, \"best_seconds\": %.9f, \"mb_per_s\": %.3f, \"allocs_per_parse\": %.1f },\n",
+		cfg_result.ok ? "true" : "false", cfg_result.bytes, cfg_result.runs, cfg_mean, cfg_result.best_seconds,
+		(cfg_result.bytes / (1024.0 * 1024.0)) / cfg_mean, ( double )cfg_result.allocs / cfg_result.runs);
+	/// every case reset the high-water mark, so the process-wide peak is the largest one seen.
+	if( cfg_result.peak_rss_kb > peak_rss_kb )
+		peak_rss_kb = cfg_result.peak_rss_kb;
+	if( _peak_rss_kb() > peak_rss_kb )
+		peak_rss_kb = _peak_rss_kb();
+	printf("\t\"peak_rss_kb\": %ld\n}\n", peak_rss_kb);
+
+	for( size_t i=0; i<corpus_count; i++ )
+		harbol_string_clear(&corpora[i].text);
+	harbol_string_clear(&cfg_text);
+	harbol_string_clear(&sample);
+	return status;
+}
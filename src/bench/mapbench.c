@@ -0,0 +1,473 @@
+#ifndef _POSIX_C_SOURCE
+#	define _POSIX_C_SOURCE 200809L
+#endif
+
+#include <time.h>
+#include "../map/map.h"
+
+/* HarbolMap benchmark.
+ * Times building & probing the open-addressing HarbolMap against the separate-chaining map it replaced,
+ * and freezing it into a perfect-hashed HarbolFrozenMap, on cfg-sized, keyword-sized and large key sets. Probes mix hits & misses and results print as JSON.
+ * Each set also times the key hash by itself, the old shift-xor `string_hash` against the seeded wyhash the map uses now,
+ * and the spread of single-insert times while building the open map, where a grow that moves everything at once shows up as the max.
+ */
+
+#define MAPBENCH_DEFAULT_SEED    0x6d61u
+#define MAPBENCH_MIN_SECONDS     0.25
+#define MAPBENCH_MIN_PASSES      5
+#define MAPBENCH_PROBES          (64u * 1024u)
+
+/// keeps the compiler from throwing away results.
+static volatile size_t g_sink;
+
+static double _now(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static uint32_t _rand(uint64_t *const state)
+{
+	*state = *state * 6364136223846793005ull + 1442695040888963407ull;
+	return ( uint32_t )(*state >> 33);
+}
+
+
+/// the previous HarbolMap: a vector of buckets holding kv pointers, `get` checks `has_key` first.
+struct ChainedMap {
+	struct HarbolVector *buckets;
+	size_t len, count, datasize;
+};
+
+static NO_NULL bool _chained_has_key(const struct ChainedMap *const map, const char key[static 1])
+{
+	if( map->buckets==NULL )
+		return false;
+
+	struct HarbolVector *const bucket = &map->buckets[string_hash(key) % map->len];
+	for( uindex_t i=0; i<bucket->count; i++ ) {
+		struct HarbolKeyVal **const kv = harbol_vector_get(bucket, i);
+		if( !strcmp((*kv)->key, key) )
+			return true;
+	}
+	return false;
+}
+
+static NO_NULL bool _chained_insert_kv(struct ChainedMap *map, struct HarbolKeyVal *kv);
+
+static NO_NULL bool _chained_rehash(struct ChainedMap *const map, const size_t new_len)
+{
+	const size_t old_len = map->len;
+	struct HarbolVector *curr = map->buckets;
+	map->buckets = harbol_alloc(new_len, sizeof *map->buckets);
+	if( map->buckets==NULL ) {
+		map->buckets = curr;
+		return false;
+	}
+	map->len = new_len;
+	map->count = 0;
+	for( uindex_t i=0; curr != NULL && i<old_len; i++ ) {
+		for( uindex_t a=0; a<curr[i].count; a++ )
+			_chained_insert_kv(map, *(struct HarbolKeyVal **)harbol_vector_get(&curr[i], a));
+		harbol_free(curr[i].table), curr[i].table = NULL;
+	}
+	harbol_free(curr), curr=NULL;
+	return true;
+}
+
+static NO_NULL bool _chained_insert_kv(struct ChainedMap *const map, struct HarbolKeyVal *kv)
+{
+	if( _chained_has_key(map, kv->key) )
+		return false;
+	else if( map->len==0 || map->count >= map->len )
+		_chained_rehash(map, (map->len==0) ? MAP_DEFAULT_SIZE : map->len << 1);
+
+	struct HarbolVector *const bucket = &map->buckets[string_hash(kv->key) % map->len];
+	if( bucket->datasize==0 )
+		bucket->datasize = sizeof(struct HarbolKeyVal *);
+	harbol_vector_insert(bucket, &kv);
+	map->count++;
+	return true;
+}
+
+static NO_NULL bool _chained_insert(struct ChainedMap *const map, const char key[static 1], void *const val)
+{
+	struct HarbolKeyVal *kv = harbol_kvpair_new(key, val, map->datasize);
+	if( kv==NULL )
+		return false;
+	else if( !_chained_insert_kv(map, kv) ) {
+		harbol_kvpair_free(&kv, NULL);
+		return false;
+	}
+	else return true;
+}
+
+static NO_NULL void *_chained_get(const struct ChainedMap *const map, const char key[static 1])
+{
+	if( map->buckets==NULL || !_chained_has_key(map, key) )
+		return NULL;
+
+	struct HarbolVector *const bucket = &map->buckets[string_hash(key) % map->len];
+	for( uindex_t i=0; i<bucket->count; i++ ) {
+		struct HarbolKeyVal **const kv = harbol_vector_get(bucket, i);
+		if( !strcmp((*kv)->key, key) )
+			return (*kv)->data;
+	}
+	return NULL;
+}
+
+static NO_NULL void _chained_clear(struct ChainedMap *const map)
+{
+	for( uindex_t i=0; map->buckets != NULL && i<map->len; i++ ) {
+		for( uindex_t a=0; a<map->buckets[i].count; a++ )
+			harbol_kvpair_free(harbol_vector_get(&map->buckets[i], a), NULL);
+		harbol_vector_clear(&map->buckets[i], NULL);
+	}
+	harbol_free(map->buckets), map->buckets=NULL;
+	map->len = map->count = 0;
+}
+
+
+/// NUL-separated keys in one buffer: the first `count` get inserted, the probes index into all of them.
+struct MapBenchKeys {
+	struct HarbolString buf;
+	struct HarbolVector offsets, probes;
+	size_t count;
+};
+
+struct MapBenchCase {
+	const char *name;
+	void (*make)(struct MapBenchKeys *keys, uint64_t *seed);
+};
+
+static NO_NULL void _add_key(struct MapBenchKeys *const keys, const char key[static 1])
+{
+	const size_t offset = keys->buf.len;
+	harbol_vector_insert(&keys->offsets, ( void* )&offset);
+	harbol_string_add_cstr(&keys->buf, key);
+	harbol_string_add_char(&keys->buf, 0);
+}
+
+static NO_NULL const char *_key(const struct MapBenchKeys *const keys, const size_t i)
+{
+	const size_t *const offset = harbol_vector_get(&keys->offsets, i);
+	return &harbol_string_cstr(&keys->buf)[*offset];
+}
+
+/// random identifiers, what misses look like when the lexer probes a keyword table.
+static NO_NULL void _add_idents(struct MapBenchKeys *const keys, uint64_t *const seed, const size_t count)
+{
+	for( size_t i=0; i<count; i++ ) {
+		char ident[24] = {0};
+		const size_t len = 1 + _rand(seed) % 12;
+		for( size_t n=0; n<len; n++ )
+			ident[n] = ( n > 0 && _rand(seed) % 5==0 ) ? '_' : 'a' + _rand(seed) % 26;
+		_add_key(keys, ident);
+	}
+}
+
+/// key names from a tokens cfg section.
+static NO_NULL void _make_cfg(struct MapBenchKeys *const keys, uint64_t *const seed)
+{
+	static const char *const names[] = {
+		"use golang-style", "on demand", "error recovery", "comments", "invalid", "comment", "identifier",
+		"integer", "float", "string", "rune", "keywords", "operators", "whitespace", "space", "tab",
+		"newline", "carriage return", "error", "version", "name", "author", "license", "description",
+	};
+	for( size_t i=0; i < sizeof names / sizeof names[0]; i++ )
+		_add_key(keys, names[i]);
+	keys->count = keys->offsets.count;
+	_add_idents(keys, seed, keys->count);
+}
+
+/// the C keyword set, with the near-collisions like "_Alignas"/"_Alignof" the old hash was weak on.
+static NO_NULL void _make_keywords(struct MapBenchKeys *const keys, uint64_t *const seed)
+{
+	static const char *const names[] = {
+		"auto", "break", "case", "char", "const", "continue", "default", "do", "double", "else", "enum",
+		"extern", "float", "for", "goto", "if", "inline", "int", "long", "register", "restrict", "return",
+		"short", "signed", "sizeof", "static", "struct", "switch", "typedef", "union", "unsigned", "void",
+		"volatile", "while", "_Alignas", "_Alignof", "_Atomic", "_Bool", "_Complex", "_Generic",
+		"_Imaginary", "_Noreturn", "_Static_assert", "_Thread_local",
+	};
+	for( size_t i=0; i < sizeof names / sizeof names[0]; i++ )
+		_add_key(keys, names[i]);
+	keys->count = keys->offsets.count;
+	_add_idents(keys, seed, keys->count);
+}
+
+/// an interning-table sized set.
+static NO_NULL void _make_large(struct MapBenchKeys *const keys, uint64_t *const seed)
+{
+	for( size_t i=0; i<50000; i++ ) {
+		char key[32];
+		snprintf(key, sizeof key, "sym_%" PRIu32 "_%zu", _rand(seed) % 1000u, i);
+		_add_key(keys, key);
+	}
+	keys->count = keys->offsets.count;
+	_add_idents(keys, seed, keys->count / 4);
+}
+
+
+static NO_NULL size_t _build_open(const struct MapBenchKeys *const keys, struct HarbolMap *const map)
+{
+	for( size_t i=0; i<keys->count; i++ )
+		harbol_map_insert(map, _key(keys, i), &i);
+	return keys->count;
+}
+
+static NO_NULL size_t _probe_open(const struct MapBenchKeys *const keys, const struct HarbolMap *const map)
+{
+	const uint32_t *const end = harbol_vector_get_iter_end_count(&keys->probes);
+	for( const uint32_t *iter = harbol_vector_get_iter(&keys->probes); iter != NULL && iter<end; iter++ )
+		g_sink += harbol_map_get(map, _key(keys, *iter)) != NULL;
+	return keys->probes.count;
+}
+
+static NO_NULL size_t _probe_frozen(const struct MapBenchKeys *const keys, const struct HarbolFrozenMap *const fmap)
+{
+	const uint32_t *const end = harbol_vector_get_iter_end_count(&keys->probes);
+	for( const uint32_t *iter = harbol_vector_get_iter(&keys->probes); iter != NULL && iter<end; iter++ )
+		g_sink += harbol_frozen_map_get(fmap, _key(keys, *iter)) != NULL;
+	return keys->probes.count;
+}
+
+static NO_NULL size_t _build_chained(const struct MapBenchKeys *const keys, struct ChainedMap *const map)
+{
+	for( size_t i=0; i<keys->count; i++ )
+		_chained_insert(map, _key(keys, i), &i);
+	return keys->count;
+}
+
+static NO_NULL size_t _probe_chained(const struct MapBenchKeys *const keys, const struct ChainedMap *const map)
+{
+	const uint32_t *const end = harbol_vector_get_iter_end_count(&keys->probes);
+	for( const uint32_t *iter = harbol_vector_get_iter(&keys->probes); iter != NULL && iter<end; iter++ )
+		g_sink += _chained_get(map, _key(keys, *iter)) != NULL;
+	return keys->probes.count;
+}
+
+
+/// one timing per map: nanoseconds per inserted key for a fresh build, nanoseconds per lookup for the probes.
+struct MapBenchTiming {
+	double build_ns, best_build_ns, probe_ns, best_probe_ns;
+};
+
+static NO_NULL struct MapBenchTiming _time_open(const struct MapBenchKeys *const keys)
+{
+	struct MapBenchTiming t = { 0.0, 1e30, 0.0, 1e30 };
+	size_t passes = 0;
+	double seconds = 0.0;
+	while( passes < MAPBENCH_MIN_PASSES || seconds < MAPBENCH_MIN_SECONDS ) {
+		struct HarbolMap map = harbol_map_create(sizeof(size_t));
+		const double start = _now();
+		const size_t built = _build_open(keys, &map);
+		const double mid = _now();
+		const size_t probed = _probe_open(keys, &map);
+		const double stop = _now();
+		harbol_map_clear(&map, NULL);
+
+		const double build = (mid - start) * 1e9 / built, probe = (stop - mid) * 1e9 / probed;
+		t.build_ns += build, t.probe_ns += probe;
+		if( build < t.best_build_ns )
+			t.best_build_ns = build;
+		if( probe < t.best_probe_ns )
+			t.best_probe_ns = probe;
+		seconds += stop - start, passes++;
+	}
+	t.build_ns /= passes, t.probe_ns /= passes;
+	return t;
+}
+
+/// the build time here is freezing an already built map.
+static NO_NULL struct MapBenchTiming _time_frozen(const struct MapBenchKeys *const keys)
+{
+	struct MapBenchTiming t = { 0.0, 1e30, 0.0, 1e30 };
+	struct HarbolMap map = harbol_map_create(sizeof(size_t));
+	_build_open(keys, &map);
+	size_t passes = 0;
+	double seconds = 0.0;
+	while( passes < MAPBENCH_MIN_PASSES || seconds < MAPBENCH_MIN_SECONDS ) {
+		const double start = _now();
+		struct HarbolFrozenMap *fmap = harbol_map_freeze(&map);
+		const double mid = _now();
+		const size_t probed = _probe_frozen(keys, fmap);
+		const double stop = _now();
+		harbol_frozen_map_free(&fmap);
+		
+		const double build = (mid - start) * 1e9 / keys->count, probe = (stop - mid) * 1e9 / probed;
+		t.build_ns += build, t.probe_ns += probe;
+		if( build < t.best_build_ns )
+			t.best_build_ns = build;
+		if( probe < t.best_probe_ns )
+			t.best_probe_ns = probe;
+		seconds += stop - start, passes++;
+	}
+	harbol_map_clear(&map, NULL);
+	t.build_ns /= passes, t.probe_ns /= passes;
+	return t;
+}
+
+static NO_NULL struct MapBenchTiming _time_chained(const struct MapBenchKeys *const keys)
+{
+	struct MapBenchTiming t = { 0.0, 1e30, 0.0, 1e30 };
+	size_t passes = 0;
+	double seconds = 0.0;
+	while( passes < MAPBENCH_MIN_PASSES || seconds < MAPBENCH_MIN_SECONDS ) {
+		struct ChainedMap map = { NULL, 0, 0, sizeof(size_t) };
+		const double start = _now();
+		const size_t built = _build_chained(keys, &map);
+		const double mid = _now();
+		const size_t probed = _probe_chained(keys, &map);
+		const double stop = _now();
+		_chained_clear(&map);
+
+		const double build = (mid - start) * 1e9 / built, probe = (stop - mid) * 1e9 / probed;
+		t.build_ns += build, t.probe_ns += probe;
+		if( build < t.best_build_ns )
+			t.best_build_ns = build;
+		if( probe < t.best_probe_ns )
+			t.best_probe_ns = probe;
+		seconds += stop - start, passes++;
+	}
+	t.build_ns /= passes, t.probe_ns /= passes;
+	return t;
+}
+
+/// insert latency percentiles over a few fresh builds of the open map.
+struct MapBenchLatency {
+	double p50_ns, p99_ns, p999_ns, max_ns;
+};
+
+static int _cmp_double(const void *const a, const void *const b)
+{
+	const double x = *( const double* )a, y = *( const double* )b;
+	return( x > y ) - ( x < y );
+}
+
+static NO_NULL struct MapBenchLatency _time_inserts(const struct MapBenchKeys *const keys)
+{
+	struct MapBenchLatency lat = { 0.0, 0.0, 0.0, 0.0 };
+	const size_t samples = keys->count * MAPBENCH_MIN_PASSES;
+	double *const ns = malloc(samples * sizeof *ns);
+	if( ns==NULL )
+		return lat;
+	
+	for( size_t pass=0; pass<MAPBENCH_MIN_PASSES; pass++ ) {
+		struct HarbolMap map = harbol_map_create(sizeof(size_t));
+		for( size_t i=0; i<keys->count; i++ ) {
+			const double start = _now();
+			harbol_map_insert(&map, _key(keys, i), &i);
+			ns[pass * keys->count + i] = (_now() - start) * 1e9;
+		}
+		harbol_map_clear(&map, NULL);
+	}
+	qsort(ns, samples, sizeof *ns, _cmp_double);
+	lat.p50_ns = ns[samples / 2];
+	lat.p99_ns = ns[samples * 99 / 100];
+	lat.p999_ns = ns[samples * 999 / 1000];
+	lat.max_ns = ns[samples - 1];
+	free(ns);
+	return lat;
+}
+
+static NO_NULL size_t _hash_shift_xor(const char key[static 1], const size_t len)
+{
+	(void)len;
+	return string_hash(key);
+}
+
+static NO_NULL size_t _hash_wy(const char key[static 1], const size_t len)
+{
+	return harbol_strview_hash(harbol_strview_n(key, len));
+}
+
+/// best nanoseconds per key to hash every key in the set once.
+static NO_NULL double _time_hash(const struct MapBenchKeys *const keys, size_t hash(const char[], size_t))
+{
+	double best = 1e30, seconds = 0.0;
+	size_t passes = 0;
+	while( passes < MAPBENCH_MIN_PASSES || seconds < MAPBENCH_MIN_SECONDS ) {
+		const double start = _now();
+		for( size_t i=0; i<keys->count; i++ ) {
+			const char *const key = _key(keys, i);
+			g_sink += hash(key, strlen(key));
+		}
+		const double stop = _now();
+		const double ns = (stop - start) * 1e9 / keys->count;
+		if( ns < best )
+			best = ns;
+		seconds += stop - start, passes++;
+	}
+	return best;
+}
+
+static NO_NULL void _bench_case(const struct MapBenchCase *const mc, const uint64_t seed, const bool last)
+{
+	struct MapBenchKeys keys = { EMPTY_HARBOL_STRING, harbol_vector_create(sizeof(size_t), 0), harbol_vector_create(sizeof(uint32_t), MAPBENCH_PROBES), 0 };
+	uint64_t state = seed;
+	mc->make(&keys, &state);
+	for( size_t i=0; i<MAPBENCH_PROBES; i++ ) {
+		const uint32_t probe = _rand(&state) % keys.offsets.count;
+		harbol_vector_insert(&keys.probes, ( void* )&probe);
+	}
+
+	const struct MapBenchTiming
+		open = _time_open(&keys),
+		frozen = _time_frozen(&keys),
+		chained = _time_chained(&keys)
+	;
+	const double
+		shift_xor_ns = _time_hash(&keys, _hash_shift_xor),
+		wy_ns = _time_hash(&keys, _hash_wy)
+	;
+	const struct MapBenchLatency lat = _time_inserts(&keys);
+	printf("\t\t{ \"name\": \"%s\", \"keys\": %zu, \"probes\": %zu, \"hit_ratio\": %.2f,\n"
+		"\t\t  \"open\": { \"build_ns_per_key\": %.2f, \"best_build_ns_per_key\": %.2f, \"ns_per_lookup\": %.2f, \"best_ns_per_lookup\": %.2f },\n"
+		"\t\t  \"frozen\": { \"freeze_ns_per_key\": %.2f, \"best_freeze_ns_per_key\": %.2f, \"ns_per_lookup\": %.2f, \"best_ns_per_lookup\": %.2f },\n"
+		"\t\t  \"chained\": { \"build_ns_per_key\": %.2f, \"best_build_ns_per_key\": %.2f, \"ns_per_lookup\": %.2f, \"best_ns_per_lookup\": %.2f },\n"
+		"\t\t  \"hash\": { \"shift_xor_ns_per_key\": %.2f, \"wyhash_ns_per_key\": %.2f },\n"
+		"\t\t  \"insert_latency\": { \"p50_ns\": %.0f, \"p99_ns\": %.0f, \"p999_ns\": %.0f, \"max_ns\": %.0f },\n"
+		"\t\t  \"lookup_speedup\": %.2f }%s\n",
+		mc->name, keys.count, keys.probes.count, ( double )keys.count / keys.offsets.count,
+		open.build_ns, open.best_build_ns, open.probe_ns, open.best_probe_ns,
+		frozen.build_ns, frozen.best_build_ns, frozen.probe_ns, frozen.best_probe_ns,
+		chained.build_ns, chained.best_build_ns, chained.probe_ns, chained.best_probe_ns,
+		shift_xor_ns, wy_ns,
+		lat.p50_ns, lat.p99_ns, lat.p999_ns, lat.max_ns,
+		chained.best_probe_ns / open.best_probe_ns, last ? "" : ",");
+
+	harbol_string_clear(&keys.buf);
+	harbol_vector_clear(&keys.offsets, NULL);
+	harbol_vector_clear(&keys.probes, NULL);
+}
+
+int32_t main(const int32_t argc, char *argv[restrict static 1])
+{
+	const struct MapBenchCase cases[] = {
+		{ "cfg",      _make_cfg      },
+		{ "keywords", _make_keywords },
+		{ "large",    _make_large    },
+	};
+	const size_t case_count = sizeof cases / sizeof cases[0];
+
+	uint64_t seed = MAPBENCH_DEFAULT_SEED;
+	for( int32_t i=1; i<argc; i++ ) {
+		if( !strcmp(argv[i], "--help") ) {
+			puts("HarbolMap Benchmark - 'targum_mapbench [--seed N]'");
+			return 0;
+		} else if( !strcmp(argv[i], "--seed") && i + 1 < argc ) {
+			seed = strtoull(argv[++i], NULL, 0);
+		} else {
+			fprintf(stderr, "HarbolMap Benchmark Error: unknown option '%s'.\n", argv[i]);
+			return -1;
+		}
+	}
+
+	printf("{\n\t\"seed\": %" PRIu64 ",\n\t\"results\": [\n", seed);
+	for( size_t i=0; i<case_count; i++ )
+		_bench_case(&cases[i], seed, i + 1==case_count);
+	puts("\t]\n}");
+	return 0;
+}
@@ -0,0 +1,445 @@
+#ifndef _POSIX_C_SOURCE
+#	define _POSIX_C_SOURCE 200809L
+#endif
+
+#include <time.h>
+#include "../vector/vector.h"
+#include "../lex/lex.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#	include <x86intrin.h>
+#	define MICRO_HAS_TSC
+#endif
+
+/* Targum Lexer microbenchmarks for the lex module primitives.
+ * Every primitive runs over a seeded, randomized input set so results are reproducible,
+ * and reports ns/byte plus TSC cycles/byte where the CPU has a timestamp counter.
+ */
+
+#define MICRO_DEFAULT_INPUTS     4096
+#define MICRO_DEFAULT_SEED       0x7a52u
+#define MICRO_MIN_SECONDS        0.25
+#define MICRO_MIN_PASSES         5
+#define MICRO_RUNES_PER_INPUT    16
+
+/// NUL-separated inputs in one buffer, `offsets` points at the start of each.
+struct MicroInputs {
+	struct HarbolString buf;
+	struct HarbolVector offsets, runes;
+	size_t bytes;  /// bytes a single pass is expected to consume.
+};
+
+struct MicroCase {
+	const char *name;
+	void (*make)(struct MicroInputs *inputs, size_t count, uint64_t *seed);
+	size_t (*run)(const struct MicroInputs *inputs, struct HarbolString *scratch);
+};
+
+/// keeps the compiler from throwing away results.
+static volatile size_t g_sink;
+
+static double _now(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static uint64_t _cycles(void)
+{
+#ifdef MICRO_HAS_TSC
+	return __rdtsc();
+#else
+	return 0;
+#endif
+}
+
+static uint32_t _rand(uint64_t *const state)
+{
+	*state = *state * 6364136223846793005ull + 1442695040888963407ull;
+	return ( uint32_t )(*state >> 33);
+}
+
+static NO_NULL void _begin_input(struct MicroInputs *const inputs)
+{
+	const size_t offset = inputs->buf.len;
+	harbol_vector_insert(&inputs->offsets, ( void* )&offset);
+}
+
+static NO_NULL void _end_input(struct MicroInputs *const inputs)
+{
+	harbol_string_add_char(&inputs->buf, 0);
+}
+
+static NO_NULL const char *_input(const struct MicroInputs *const inputs, const size_t i)
+{
+	const size_t *const offset = harbol_vector_get(&inputs->offsets, i);
+	return &harbol_string_cstr(&inputs->buf)[*offset];
+}
+
+/// appends char by char, the inputs buffer has embedded NULs that `harbol_string_add_cstr` would stop at.
+static NO_NULL void _append(struct HarbolString *const buf, const char cstr[static 1])
+{
+	while( *cstr != 0 )
+		harbol_string_add_char(buf, *cstr++);
+}
+
+static NO_NULL void _add_digits(struct HarbolString *const buf, uint64_t *const seed, const char digits[static 1], const size_t base, const size_t count, const bool underscores)
+{
+	for( size_t i=0; i<count; i++ ) {
+		if( underscores && i > 0 && _rand(seed) % 4==0 )
+			harbol_string_add_char(buf, '_');
+		harbol_string_add_char(buf, digits[_rand(seed) % base]);
+	}
+}
+
+
+static NO_NULL void _make_c_numbers(struct MicroInputs *const inputs, const size_t count, uint64_t *const seed)
+{
+	static const char *const suffixes[] = { "", "", "u", "l", "ul", "ll", "ull" };
+	for( size_t i=0; i<count; i++ ) {
+		_begin_input(inputs);
+		struct HarbolString *const buf = &inputs->buf;
+		const uint32_t r = _rand(seed);
+		switch( r % 4 ) {
+			case 0:
+				harbol_string_add_char(buf, '1' + r % 9);
+				_add_digits(buf, seed, "0123456789", 10, r % 12, false);
+				_append(buf, suffixes[_rand(seed) % 7]);
+				break;
+			case 1:
+				_append(buf, "0x");
+				_add_digits(buf, seed, "0123456789abcdefABCDEF", 22, 1 + r % 12, false);
+				_append(buf, suffixes[_rand(seed) % 7]);
+				break;
+			case 2:
+				harbol_string_add_char(buf, '0');
+				_add_digits(buf, seed, "01234567", 8, 1 + r % 10, false);
+				break;
+			case 3:
+				/// a leading 0 would make the C lexer read the integer part as octal.
+				harbol_string_add_char(buf, '1' + _rand(seed) % 9);
+				_add_digits(buf, seed, "0123456789", 10, r % 6, false);
+				harbol_string_add_char(buf, '.');
+				_add_digits(buf, seed, "0123456789", 10, 1 + r % 8, false);
+				if( r & 16 )
+					harbol_string_add_format(buf, "e%s%u", (r & 32) ? "-" : "", r % 300);
+				if( r & 64 )
+					harbol_string_add_char(buf, 'f');
+				break;
+		}
+		_end_input(inputs);
+	}
+}
+
+static NO_NULL void _make_go_numbers(struct MicroInputs *const inputs, const size_t count, uint64_t *const seed)
+{
+	for( size_t i=0; i<count; i++ ) {
+		_begin_input(inputs);
+		struct HarbolString *const buf = &inputs->buf;
+		const uint32_t r = _rand(seed);
+		switch( r % 5 ) {
+			case 0:
+				harbol_string_add_char(buf, '1' + r % 9);
+				_add_digits(buf, seed, "0123456789", 10, r % 12, true);
+				break;
+			case 1:
+				_append(buf, "0x");
+				_add_digits(buf, seed, "0123456789abcdefABCDEF", 22, 1 + r % 12, true);
+				break;
+			case 2:
+				/// `lex_go_style_number` only takes digit separators in decimal & hex literals.
+				_append(buf, "0o");
+				_add_digits(buf, seed, "01234567", 8, 1 + r % 10, false);
+				break;
+			case 3:
+				_append(buf, "0b");
+				_add_digits(buf, seed, "01", 2, 1 + r % 24, false);
+				break;
+			case 4:
+				_add_digits(buf, seed, "0123456789", 10, 1 + r % 6, false);
+				harbol_string_add_char(buf, '.');
+				_add_digits(buf, seed, "0123456789", 10, 1 + r % 8, false);
+				if( r & 16 )
+					harbol_string_add_format(buf, "e%s%u", (r & 32) ? "-" : "", r % 300);
+				break;
+		}
+		_end_input(inputs);
+	}
+}
+
+/// string bodies: plain ascii, simple/hex/octal escapes, and multi-byte utf-8.
+static NO_NULL void _add_str_body(struct HarbolString *const buf, uint64_t *const seed, const size_t len, const int32_t quote)
+{
+	static const char *const escapes[] = { "\\n", "\\t", "\\\\", "\\x41", "\\101", "\\u00e9", "\\U0001F600" };
+	for( size_t n=0; n<len; n++ ) {
+		const uint32_t r = _rand(seed);
+		if( r % 8==0 ) {
+			_append(buf, escapes[_rand(seed) % 7]);
+		} else if( r % 8==1 ) {
+			write_utf8_str(buf, 0xa0 + r % 0x700);
+		} else if( r % 8==2 && quote != '\'' ) {
+			harbol_string_add_char(buf, '\\');
+			harbol_string_add_char(buf, quote);
+		} else {
+			harbol_string_add_char(buf, 'a' + r % 26);
+		}
+	}
+}
+
+static NO_NULL void _make_c_strings(struct MicroInputs *const inputs, const size_t count, uint64_t *const seed)
+{
+	for( size_t i=0; i<count; i++ ) {
+		_begin_input(inputs);
+		const uint32_t r = _rand(seed);
+		const int32_t quote = ( r % 4==0 ) ? '\'' : '"';
+		harbol_string_add_char(&inputs->buf, quote);
+		_add_str_body(&inputs->buf, seed, ( quote=='\'' ) ? 1 : 1 + r % 48, quote);
+		harbol_string_add_char(&inputs->buf, quote);
+		_end_input(inputs);
+	}
+}
+
+static NO_NULL void _make_go_strings(struct MicroInputs *const inputs, const size_t count, uint64_t *const seed)
+{
+	for( size_t i=0; i<count; i++ ) {
+		_begin_input(inputs);
+		const uint32_t r = _rand(seed);
+		if( r % 4==0 ) {
+			/// raw strings can span lines but have no escapes.
+			harbol_string_add_char(&inputs->buf, '`');
+			for( size_t n=0; n < 1 + r % 64; n++ )
+				harbol_string_add_char(&inputs->buf, ( _rand(seed) % 16==0 ) ? '\n' : 'a' + n % 26);
+			harbol_string_add_char(&inputs->buf, '`');
+		} else {
+			const int32_t quote = ( r % 4==1 ) ? '\'' : '"';
+			harbol_string_add_char(&inputs->buf, quote);
+			_add_str_body(&inputs->buf, seed, ( quote=='\'' ) ? 1 : 1 + r % 48, quote);
+			harbol_string_add_char(&inputs->buf, quote);
+		}
+		_end_input(inputs);
+	}
+}
+
+static NO_NULL void _make_comments(struct MicroInputs *const inputs, const size_t count, uint64_t *const seed)
+{
+	for( size_t i=0; i<count; i++ ) {
+		_begin_input(inputs);
+		const uint32_t r = _rand(seed);
+		_append(&inputs->buf, "/*");
+		for( size_t n=0; n < 8 + r % 256; n++ ) {
+			const uint32_t c = _rand(seed) % 32;
+			harbol_string_add_char(&inputs->buf, ( c==0 ) ? '\n' : ( c==1 ) ? '*' : ( c < 6 ) ? ' ' : 'a' + c % 26);
+		}
+		_append(&inputs->buf, "*/");
+		_end_input(inputs);
+	}
+}
+
+/// runs of random runes, 1 to 4 bytes each once encoded.
+static NO_NULL void _make_utf8(struct MicroInputs *const inputs, const size_t count, uint64_t *const seed)
+{
+	static const int32_t ranges[][2] = { {0x20, 0x7f}, {0x80, 0x800}, {0xe000, 0x10000}, {0x10000, 0x110000} };
+	for( size_t i=0; i<count; i++ ) {
+		_begin_input(inputs);
+		for( size_t n=0; n < MICRO_RUNES_PER_INPUT; n++ ) {
+			const uint32_t r = _rand(seed);
+			const int32_t *const range = ranges[r % 4];
+			write_utf8_str(&inputs->buf, range[0] + ( int32_t )(_rand(seed) % ( uint32_t )(range[1] - range[0])));
+		}
+		_end_input(inputs);
+	}
+}
+
+/// same runes as `_make_utf8` but decoded up front, so only the encoding gets timed.
+static NO_NULL void _make_runes(struct MicroInputs *const inputs, const size_t count, uint64_t *const seed)
+{
+	_make_utf8(inputs, count, seed);
+	for( size_t i=0; i<inputs->offsets.count; i++ ) {
+		const char *str = _input(inputs, i);
+		size_t len = strlen(str);
+		int32_t rune = 0;
+		for( size_t n; len > 0 && (n = read_utf8(str, len, &rune)) > 0; str += n, len -= n )
+			harbol_vector_insert(&inputs->runes, &rune);
+	}
+}
+
+static NO_NULL void _make_hex_escapes(struct MicroInputs *const inputs, const size_t count, uint64_t *const seed)
+{
+	for( size_t i=0; i<count; i++ ) {
+		_begin_input(inputs);
+		_add_digits(&inputs->buf, seed, "0123456789abcdefABCDEF", 22, 2 + _rand(seed) % 7, false);
+		_end_input(inputs);
+	}
+}
+
+
+#define MICRO_LEX_RUNNER(name, call) \
+	static NO_NULL size_t name(const struct MicroInputs *const inputs, struct HarbolString *const scratch) \
+	{ \
+		size_t bytes = 0; \
+		for( size_t i=0; i<inputs->offsets.count; i++ ) { \
+			const char *const str = _input(inputs, i); \
+			const char *end = str; \
+			bool is_float = false; \
+			(void)is_float; \
+			g_sink += call; \
+			bytes += (uintptr_t)(end - str); \
+			harbol_string_reset(scratch); \
+		} \
+		return bytes; \
+	}
+
+MICRO_LEX_RUNNER(_run_c_number, lex_c_style_number(str, &end, scratch, &is_float))
+MICRO_LEX_RUNNER(_run_go_number, lex_go_style_number(str, &end, scratch, &is_float))
+MICRO_LEX_RUNNER(_run_c_str, lex_c_style_str(str, &end, scratch))
+MICRO_LEX_RUNNER(_run_go_str, lex_go_style_str(str, &end, scratch))
+MICRO_LEX_RUNNER(_run_comment, lex_multi_line_comment(str, &end, "*/", 2, scratch))
+MICRO_LEX_RUNNER(_run_hex_escape, ( size_t )lex_hex_escape_char(str, &end))
+
+static NO_NULL size_t _run_read_utf8(const struct MicroInputs *const inputs, struct HarbolString *const scratch)
+{
+	(void)scratch;
+	size_t bytes = 0;
+	for( size_t i=0; i<inputs->offsets.count; i++ ) {
+		const char *str = _input(inputs, i);
+		size_t len = strlen(str);
+		while( len > 0 ) {
+			int32_t rune = 0;
+			const size_t n = read_utf8(str, len, &rune);
+			if( n==0 )
+				break;
+			g_sink += rune;
+			str += n, len -= n, bytes += n;
+		}
+	}
+	return bytes;
+}
+
+/// encodes one input's worth of runes per string, like the lexer does per token.
+static NO_NULL size_t _run_write_utf8(const struct MicroInputs *const inputs, struct HarbolString *const scratch)
+{
+	size_t bytes = 0, n = 0;
+	const int32_t *const end = harbol_vector_get_iter_end_count(&inputs->runes);
+	for( const int32_t *iter = harbol_vector_get_iter(&inputs->runes); iter != NULL && iter<end; iter++ ) {
+		g_sink += write_utf8_str(scratch, *iter);
+		if( ++n % MICRO_RUNES_PER_INPUT==0 ) {
+			bytes += scratch->len;
+			harbol_string_reset(scratch);
+		}
+	}
+	bytes += scratch->len;
+	harbol_string_reset(scratch);
+	return bytes;
+}
+
+
+/// false if the primitive didn't consume all of its inputs, timing a pass that stops early says nothing.
+static NO_NULL bool _bench_case(const struct MicroCase *const mc, const size_t count, const uint64_t seed, const bool last)
+{
+	struct MicroInputs inputs = { EMPTY_HARBOL_STRING, harbol_vector_create(sizeof(size_t), count), harbol_vector_create(sizeof(int32_t), 0), 0 };
+	uint64_t state = seed;
+	mc->make(&inputs, count, &state);
+
+	struct HarbolString scratch = EMPTY_HARBOL_STRING;
+	/// warm-up pass, also tells how many bytes a pass consumes.
+	inputs.bytes = mc->run(&inputs, &scratch);
+	const size_t input_bytes = inputs.buf.len - inputs.offsets.count;
+	const bool ok = inputs.bytes==input_bytes;
+	if( !ok )
+		fprintf(stderr, "Targum Lexer Microbenchmarks Error: '%s' consumed %zu of %zu input bytes.\n", mc->name, inputs.bytes, input_bytes);
+
+	size_t passes = 0;
+	double seconds = 0.0, best_seconds = 1e30;
+	uint64_t cycles = 0, best_cycles = UINT64_MAX;
+	while( ok && (passes < MICRO_MIN_PASSES || seconds < MICRO_MIN_SECONDS) ) {
+		const double start = _now();
+		const uint64_t start_cycles = _cycles();
+		mc->run(&inputs, &scratch);
+		const uint64_t pass_cycles = _cycles() - start_cycles;
+		const double elapsed = _now() - start;
+		seconds += elapsed, cycles += pass_cycles, passes++;
+		if( elapsed < best_seconds )
+			best_seconds = elapsed;
+		if( pass_cycles < best_cycles )
+			best_cycles = pass_cycles;
+	}
+
+	const double bytes = ( inputs.bytes > 0 ) ? inputs.bytes : 1;
+	const double runs = ( passes > 0 ) ? passes : 1;
+	printf("\t\t{ \"name\": \"%s\", \"ok\": %s, \"inputs\": %zu, \"bytes_per_pass\": %zu, \"passes\": %zu,"
+		" \"ns_per_byte\": %.4f, \"best_ns_per_byte\": %.4f, \"cycles_per_byte\": %.4f, \"best_cycles_per_byte\": %.4f }%s\n",
+		mc->name, ok ? "true" : "false", count, inputs.bytes, passes,
+		(seconds / runs) * 1e9 / bytes, ok ? best_seconds * 1e9 / bytes : 0.0,
+#ifdef MICRO_HAS_TSC
+		(( double )cycles / runs) / bytes, ok ? ( double )best_cycles / bytes : 0.0,
+#else
+		-1.0, -1.0,
+#endif
+		last ? "" : ",");
+
+	harbol_string_clear(&scratch);
+	harbol_string_clear(&inputs.buf);
+	harbol_vector_clear(&inputs.offsets, NULL);
+	harbol_vector_clear(&inputs.runes, NULL);
+	return ok;
+}
+
+int32_t main(const int32_t argc, char *argv[restrict static 1])
+{
+	const struct MicroCase cases[] = {
+		{ "lex_c_style_number",     _make_c_numbers,   _run_c_number   },
+		{ "lex_go_style_number",    _make_go_numbers,  _run_go_number  },
+		{ "lex_c_style_str",        _make_c_strings,   _run_c_str      },
+		{ "lex_go_style_str",       _make_go_strings,  _run_go_str     },
+		{ "lex_multi_line_comment", _make_comments,    _run_comment    },
+		{ "read_utf8",              _make_utf8,        _run_read_utf8  },
+		{ "write_utf8_str",         _make_runes,       _run_write_utf8 },
+		{ "lex_hex_escape_char",    _make_hex_escapes, _run_hex_escape },
+	};
+	const size_t case_count = sizeof cases / sizeof cases[0];
+
+	size_t inputs = MICRO_DEFAULT_INPUTS;
+	uint64_t seed = MICRO_DEFAULT_SEED;
+	const char *filter = NULL;
+	for( int32_t i=1; i<argc; i++ ) {
+		if( !strcmp(argv[i], "--help") ) {
+			puts("Targum Lexer Microbenchmarks - 'targum_microbench [--seed N] [--inputs N] [--only name]'");
+			return 0;
+		} else if( !strcmp(argv[i], "--seed") && i + 1 < argc ) {
+			seed = strtoull(argv[++i], NULL, 0);
+		} else if( !strcmp(argv[i], "--inputs") && i + 1 < argc ) {
+			inputs = strtoul(argv[++i], NULL, 10);
+		} else if( !strcmp(argv[i], "--only") && i + 1 < argc ) {
+			filter = argv[++i];
+		} else {
+			fprintf(stderr, "Targum Lexer Microbenchmarks Error: unknown option '%s'.\n", argv[i]);
+			return -1;
+		}
+	}
+	if( inputs==0 )
+		inputs = 1;
+
+	size_t last = case_count;
+	for( size_t i=0; i<case_count; i++ )
+		if( filter==NULL || !strcmp(filter, cases[i].name) )
+			last = i;
+	if( last==case_count ) {
+		fprintf(stderr, "Targum Lexer Microbenchmarks Error: no benchmark named '%s'.\n", filter);
+		return -1;
+	}
+
+	printf("{\n\t\"seed\": %" PRIu64 ",\n\t\"tsc\": %s,\n\t\"results\": [\n", seed,
+#ifdef MICRO_HAS_TSC
+		"true"
+#else
+		"false"
+#endif
+	);
+	int32_t status = 0;
+	for( size_t i=0; i<case_count; i++ )
+		if( (filter==NULL || !strcmp(filter, cases[i].name)) && !_bench_case(&cases[i], inputs, seed, i==last) )
+			status = -1;
+	puts("\t]\n}");
+	return status;
+}
@@ -1,4 +1,6 @@
+#define HARBOL_ALLOC_CATEGORY    HarbolAllocCategory_Cfg
 #include "cfg.h"
+#include "../alloc/alloc.h"
 
 #ifdef OS_WINDOWS
 #	define HARBOL_LIB
@@ -81,8 +83,29 @@ static bool NO_NULL _lex_number(const char **restrict strref, struct HarbolStrin
 	}
 }
 
+/// a key without escapes is used right where it sits in the source, only escaped keys get decoded into `keystr`.
+static NO_NULL bool _lex_key(const char **const restrict strref, struct HarbolString *const restrict keystr, struct HarbolStrView *const restrict key)
+{
+	const char quote = **strref;
+	const char *end = *strref + 1;
+	while( *end != quote && *end != '\\' && *end != 0 )
+		end++;
+	
+	if( *end==quote ) {
+		/// an empty key stays an empty view, same as an empty decoded key, so the map turns it down.
+		*key = ( end - *strref > 1 ) ? harbol_strview_n(*strref + 1, ( size_t )(end - *strref - 1)) : (struct HarbolStrView)EMPTY_HARBOL_STRVIEW;
+		*strref = end + 1;
+		return true;
+	} else if( !lex_c_style_str(*strref, strref, keystr) ) {
+		return false;
+	} else {
+		*key = harbol_string_view(keystr);
+		return true;
+	}
+}
+
 static NO_NULL bool harbol_cfg_parse_section(struct HarbolLinkMap *, const char **);
-static NO_NULL bool harbol_cfg_parse_number(struct HarbolLinkMap *, const struct HarbolString *, const char **);
+static NEVER_NULL(1, 3) bool harbol_cfg_parse_number(struct HarbolLinkMap *, struct HarbolStrView, const char **);
 
 // keyval = <string> [':'] (<value>|<section>) [','] ;
 static bool harbol_cfg_parse_key_val(struct HarbolLinkMap *const restrict map, const char **cfgcoderef)
@@ -99,16 +122,17 @@ static bool harbol_cfg_parse_key_val(struct HarbolLinkMap *const restrict map, c
 		return false;
 	}
 	
-	struct HarbolString keystr = {NULL, 0};
-	const bool strresult = lex_c_style_str(*cfgcoderef, cfgcoderef, &keystr);
+	struct HarbolString keystr = EMPTY_HARBOL_STRING;
+	struct HarbolStrView key = EMPTY_HARBOL_STRVIEW;
+	const bool strresult = _lex_key(cfgcoderef, &keystr, &key);
 	if( !strresult ) {
 		if( _g_cfg_err.count < HARBOL_CFG_ERR_STK_SIZE )
-			harbol_string_format(&_g_cfg_err.errs[_g_cfg_err.count++], "Harbol Config Parser :: invalid string key '%s'. Line: %zu\n", keystr.cstr, _g_cfg_err.curr_line);
+			harbol_string_format(&_g_cfg_err.errs[_g_cfg_err.count++], "Harbol Config Parser :: invalid string key '%s'. Line: %zu\n", harbol_string_cstr(&keystr), _g_cfg_err.curr_line);
 		harbol_string_clear(&keystr);
 		return false;
-	} else if( harbol_linkmap_has_key(map, keystr.cstr) ) {
+	} else if( harbol_linkmap_has_key_view(map, key) ) {
 		if( _g_cfg_err.count < HARBOL_CFG_ERR_STK_SIZE )
-			harbol_string_format(&_g_cfg_err.errs[_g_cfg_err.count++], "Harbol Config Parser :: duplicate string key '%s'. Line: %zu\n", keystr.cstr, _g_cfg_err.curr_line);
+			harbol_string_format(&_g_cfg_err.errs[_g_cfg_err.count++], "Harbol Config Parser :: duplicate string key '%.*s'. Line: %zu\n", ( int )key.len, key.cstr, _g_cfg_err.curr_line);
 		harbol_string_clear(&keystr);
 		return false;
 	}
@@ -122,9 +146,9 @@ static bool harbol_cfg_parse_key_val(struct HarbolLinkMap *const restrict map, c
 		struct HarbolLinkMap *subsection = harbol_linkmap_new(sizeof(struct HarbolVariant));
 		res = harbol_cfg_parse_section(subsection, cfgcoderef);
 		struct HarbolVariant var = harbol_variant_create(&subsection, sizeof(struct HarbolLinkMap *), HarbolCfgType_Linkmap);
-		const bool inserted = harbol_linkmap_insert(map, keystr.cstr, &var);
+		const bool inserted = harbol_linkmap_insert_view(map, key, &var);
 		if( !inserted )
-			harbol_variant_clear(&var, (void(*)(void**))&harbol_cfg_free);
+			harbol_cfg_free(&subsection);
 		_g_iota.local = old;
 	} else if( **cfgcoderef=='"'||**cfgcoderef=='\'' ) {
 		// string value.
@@ -136,11 +160,11 @@ static bool harbol_cfg_parse_key_val(struct HarbolLinkMap *const restrict map, c
 					harbol_string_format(&_g_cfg_err.errs[_g_cfg_err.count++], "Harbol Config Parser :: unable to allocate string value. Line: %zu\n", _g_cfg_err.curr_line);
 			} else {
 				if( _g_cfg_err.count < HARBOL_CFG_ERR_STK_SIZE )
-					harbol_string_format(&_g_cfg_err.errs[_g_cfg_err.count++], "Harbol Config Parser :: invalid string value '%s'. Line: %zu\n", str->cstr, _g_cfg_err.curr_line);
+					harbol_string_format(&_g_cfg_err.errs[_g_cfg_err.count++], "Harbol Config Parser :: invalid string value '%s'. Line: %zu\n", harbol_string_cstr(str), _g_cfg_err.curr_line);
 			} return false;
 		}
 		struct HarbolVariant var = harbol_variant_create(&str, sizeof(struct HarbolString *), HarbolCfgType_String);
-		harbol_linkmap_insert(map, keystr.cstr, &var);
+		harbol_linkmap_insert_view(map, key, &var);
 	} else if( **cfgcoderef=='c' || **cfgcoderef=='v' ) {
 		// color or vector value!
 		const char valtype = *(*cfgcoderef)++;
@@ -162,22 +186,22 @@ static bool harbol_cfg_parse_key_val(struct HarbolLinkMap *const restrict map, c
 		
 		size_t iterations = 0;
 		while( **cfgcoderef != 0 && **cfgcoderef != ']' ) {
-			struct HarbolString numstr = {NULL, 0};
+			struct HarbolString numstr = EMPTY_HARBOL_STRING;
 			enum HarbolCfgType type = HarbolCfgType_Null;
 			const bool result = _lex_number(cfgcoderef, &numstr, &type);
 			if( iterations<4 ) {
 				if( valtype=='c' ) {
 					switch( iterations ) {
-						case 0: matrix_value.color.bytes.r = (uint8_t)strtoul(numstr.cstr, NULL, 0); break;
-						case 1: matrix_value.color.bytes.g = (uint8_t)strtoul(numstr.cstr, NULL, 0); break;
-						case 2: matrix_value.color.bytes.b = (uint8_t)strtoul(numstr.cstr, NULL, 0); break;
-						case 3: matrix_value.color.bytes.a = (uint8_t)strtoul(numstr.cstr, NULL, 0); break;
+						case 0: matrix_value.color.bytes.r = (uint8_t)strtoul(harbol_string_cstr(&numstr), NULL, 0); break;
+						case 1: matrix_value.color.bytes.g = (uint8_t)strtoul(harbol_string_cstr(&numstr), NULL, 0); break;
+						case 2: matrix_value.color.bytes.b = (uint8_t)strtoul(harbol_string_cstr(&numstr), NULL, 0); break;
+						case 3: matrix_value.color.bytes.a = (uint8_t)strtoul(harbol_string_cstr(&numstr), NULL, 0); break;
 					}
 					iterations++;
 				} else {
 					/// gotta use `harbol_string_scan` for possible hex floats.
 					float32_t f = 0;
-					const bool is_hex = !strncmp(numstr.cstr, "0x", 2) || !strncmp(numstr.cstr, "0X", 2);
+					const bool is_hex = !strncmp(harbol_string_cstr(&numstr), "0x", 2) || !strncmp(harbol_string_cstr(&numstr), "0X", 2);
 					switch( iterations ) {
 						case 0:
 							harbol_string_scan(&numstr, is_hex ? "%" SCNxf32 "" : "%" SCNf32 "", &f);
@@ -217,7 +241,7 @@ static bool harbol_cfg_parse_key_val(struct HarbolLinkMap *const restrict map, c
 		
 		struct HarbolVariant var = (valtype=='c') ?
 			harbol_variant_create(&matrix_value.color, sizeof(union HarbolColor), HarbolCfgType_Color) : harbol_variant_create(&matrix_value.vec4d, sizeof(struct HarbolVec4D), HarbolCfgType_Vec4D);
-		res = harbol_linkmap_insert(map, keystr.cstr, &var);
+		res = harbol_linkmap_insert_view(map, key, &var);
 	} else if( **cfgcoderef=='t' ) {
 		// true bool value.
 		if( strncmp("true", *cfgcoderef, sizeof("true")-1) ) {
@@ -228,7 +252,7 @@ static bool harbol_cfg_parse_key_val(struct HarbolLinkMap *const restrict map, c
 		}
 		*cfgcoderef += sizeof("true") - 1;
 		struct HarbolVariant var = harbol_variant_create(&(bool){true}, sizeof(bool), HarbolCfgType_Bool);
-		res = harbol_linkmap_insert(map, keystr.cstr, &var);
+		res = harbol_linkmap_insert_view(map, key, &var);
 	} else if( **cfgcoderef=='f' ) {
 		// false bool value
 		if( strncmp("false", *cfgcoderef, sizeof("false")-1) ) {
@@ -239,7 +263,7 @@ static bool harbol_cfg_parse_key_val(struct HarbolLinkMap *const restrict map, c
 		}
 		*cfgcoderef += sizeof("false") - 1;
 		struct HarbolVariant var = harbol_variant_create(&(bool){false}, sizeof(bool), HarbolCfgType_Bool);
-		res = harbol_linkmap_insert(map, keystr.cstr, &var);
+		res = harbol_linkmap_insert_view(map, key, &var);
 	} else if( **cfgcoderef=='n' ) {
 		// null value.
 		if( strncmp("null", *cfgcoderef, sizeof("null")-1) ) {
@@ -250,7 +274,7 @@ static bool harbol_cfg_parse_key_val(struct HarbolLinkMap *const restrict map, c
 		}
 		*cfgcoderef += sizeof("null") - 1;
 		struct HarbolVariant var = harbol_variant_create(&(char){0}, sizeof(char), HarbolCfgType_Null);
-		res = harbol_linkmap_insert(map, keystr.cstr, &var);
+		res = harbol_linkmap_insert_view(map, key, &var);
 	} else if( **cfgcoderef=='I' ) {
 		// global iota value.
 		if( strncmp("Iota", *cfgcoderef, sizeof("Iota")-1) ) {
@@ -261,7 +285,7 @@ static bool harbol_cfg_parse_key_val(struct HarbolLinkMap *const restrict map, c
 		}
 		*cfgcoderef += sizeof("Iota") - 1;
 		struct HarbolVariant var = harbol_variant_create(&(intmax_t){_g_iota.global++}, sizeof(intmax_t), HarbolCfgType_Int);
-		res = harbol_linkmap_insert(map, keystr.cstr, &var);
+		res = harbol_linkmap_insert_view(map, key, &var);
 	} else if( **cfgcoderef=='i' ) {
 		// local iota value.
 		if( strncmp("iota", *cfgcoderef, sizeof("iota")-1) ) {
@@ -272,10 +296,10 @@ static bool harbol_cfg_parse_key_val(struct HarbolLinkMap *const restrict map, c
 		}
 		*cfgcoderef += sizeof("iota") - 1;
 		struct HarbolVariant var = harbol_variant_create(&(intmax_t){(*_g_iota.local)++}, sizeof(intmax_t), HarbolCfgType_Int);
-		res = harbol_linkmap_insert(map, keystr.cstr, &var);
+		res = harbol_linkmap_insert_view(map, key, &var);
 	} else if( is_decimal(**cfgcoderef) || **cfgcoderef=='.' || **cfgcoderef=='-' || **cfgcoderef=='+' ) {
 		// numeric value.
-		res = harbol_cfg_parse_number(map, &keystr, cfgcoderef);
+		res = harbol_cfg_parse_number(map, key, cfgcoderef);
 	} else if( **cfgcoderef=='[' ) {
 		if( _g_cfg_err.count < HARBOL_CFG_ERR_STK_SIZE )
 			harbol_string_format(&_g_cfg_err.errs[_g_cfg_err.count++], "Harbol Config Parser :: array bracket missing 'c' or 'v' tag. Line: %zu\n", _g_cfg_err.curr_line);
@@ -291,9 +315,9 @@ static bool harbol_cfg_parse_key_val(struct HarbolLinkMap *const restrict map, c
 	return res;
 }
 
-static bool harbol_cfg_parse_number(struct HarbolLinkMap *const restrict map, const struct HarbolString *const restrict key, const char **cfgcoderef)
+static bool harbol_cfg_parse_number(struct HarbolLinkMap *const restrict map, const struct HarbolStrView key, const char **cfgcoderef)
 {
-	struct HarbolString numstr = {NULL, 0};
+	struct HarbolString numstr = EMPTY_HARBOL_STRING;
 	enum HarbolCfgType type = HarbolCfgType_Null;
 	const bool result = _lex_number(cfgcoderef, &numstr, &type);
 	if( !result ) {
@@ -308,10 +332,10 @@ static bool harbol_cfg_parse_number(struct HarbolLinkMap *const restrict map, co
 			harbol_string_scan(&numstr, "%" SCNxfMAX "", &f);
 			var = harbol_variant_create(&f, sizeof(floatmax_t), type);
 		} else {
-			var = harbol_variant_create(&(intmax_t){strtoll(numstr.cstr, NULL, 0)}, sizeof(intmax_t), HarbolCfgType_Int);
+			var = harbol_variant_create(&(intmax_t){strtoll(harbol_string_cstr(&numstr), NULL, 0)}, sizeof(intmax_t), HarbolCfgType_Int);
 		}
 		harbol_string_clear(&numstr);
-		return harbol_linkmap_insert(map, key->cstr, &var);
+		return harbol_linkmap_insert_view(map, key, &var);
 	}
 }
 
@@ -341,24 +365,37 @@ static bool harbol_cfg_parse_section(struct HarbolLinkMap *const restrict map, c
 }
 
 
+/// prints & frees the errors from a parse, so they never outlive the allocator that was installed for it.
+static void _flush_cfg_errs(void)
+{
+	for( uindex_t i=0; i<_g_cfg_err.count; i++ ) {
+		if( harbol_string_cstr(&_g_cfg_err.errs[i]) != NULL )
+			fputs(harbol_string_cstr(&_g_cfg_err.errs[i]), stderr);
+		harbol_string_clear(&_g_cfg_err.errs[i]);
+	}
+	_g_cfg_err.count = 0;
+}
+
 HARBOL_EXPORT struct HarbolLinkMap *harbol_cfg_parse_file(const char filename[restrict static 1])
 {
 	FILE *restrict cfgfile = fopen(filename, "r");
 	if( cfgfile==NULL ) {
 		if( _g_cfg_err.count < HARBOL_CFG_ERR_STK_SIZE )
 			harbol_string_format(&_g_cfg_err.errs[_g_cfg_err.count++], "Harbol Config Parser :: unable to find file '%s'.\n", filename);
+		_flush_cfg_errs();
 		return NULL;
 	} else {
-		struct HarbolString cfg = {NULL, 0};
+		struct HarbolString cfg = EMPTY_HARBOL_STRING;
 		const bool read_result = harbol_string_read_file(&cfg, cfgfile);
 		fclose(cfgfile);
 		
 		if( !read_result ) {
 			if( _g_cfg_err.count < HARBOL_CFG_ERR_STK_SIZE )
 				harbol_string_format(&_g_cfg_err.errs[_g_cfg_err.count++], "Harbol Config Parser :: failed to read file '%s' into a string.\n", filename);
+			_flush_cfg_errs();
 			return NULL;
 		} else {
-			struct HarbolLinkMap *const restrict objs = harbol_cfg_parse_cstr(cfg.cstr);
+			struct HarbolLinkMap *const restrict objs = harbol_cfg_parse_cstr(harbol_string_cstr(&cfg));
 			harbol_string_clear(&cfg);
 			return objs;
 		}
@@ -377,17 +414,27 @@ HARBOL_EXPORT struct HarbolLinkMap *harbol_cfg_parse_cstr(const char cfgcode[])
 		_g_iota.global = 0;
 		_g_iota.local = &(intmax_t){0};
 		while( harbol_cfg_parse_key_val(objs, &iter) );
-		if( _g_cfg_err.count > 0 ) {
-			for( uindex_t i=0; i<_g_cfg_err.count; i++ ) {
-				fputs(_g_cfg_err.errs[i].cstr, stderr);
-				harbol_string_clear(&_g_cfg_err.errs[i]);
-			}
-			_g_cfg_err.count = 0;
-		}
+		_flush_cfg_errs();
 		return objs;
 	}
 }
 
+HARBOL_EXPORT struct HarbolLinkMap *harbol_cfg_parse_file_with_allocator(const char filename[restrict static 1], const struct HarbolAllocator *const allocator)
+{
+	const struct HarbolAllocator *const prev = harbol_allocator_swap(allocator);
+	struct HarbolLinkMap *const restrict objs = harbol_cfg_parse_file(filename);
+	harbol_allocator_swap(prev);
+	return objs;
+}
+
+HARBOL_EXPORT struct HarbolLinkMap *harbol_cfg_parse_cstr_with_allocator(const char cfgcode[restrict static 1], const struct HarbolAllocator *const allocator)
+{
+	const struct HarbolAllocator *const prev = harbol_allocator_swap(allocator);
+	struct HarbolLinkMap *const restrict objs = harbol_cfg_parse_cstr(cfgcode);
+	harbol_allocator_swap(prev);
+	return objs;
+}
+
 union ConfigVal {
 	uint8_t *restrict data;
 	struct HarbolLinkMap **restrict section;
@@ -401,7 +448,7 @@ union ConfigVal {
 
 static void __harbol_cfgkey_del(struct HarbolVariant *const var)
 {
-	union ConfigVal cv = {var->data};
+	union ConfigVal cv = {harbol_variant_get(var)};
 	switch( var->tag ) {
 		case HarbolCfgType_Linkmap:
 			harbol_cfg_free(cv.section);
@@ -421,9 +468,9 @@ HARBOL_EXPORT bool harbol_cfg_free(struct HarbolLinkMap **mapref)
 	if( *mapref==NULL )
 		return false;
 	else {
-		struct HarbolKeyVal **const end = harbol_linkmap_get_iter_end_count(*mapref);
-		for( struct HarbolKeyVal **iter = harbol_linkmap_get_iter(*mapref); iter && iter<end; iter++ )
-			__harbol_cfgkey_del((struct HarbolVariant *)(*iter)->data);
+		struct HarbolVariant *const end = harbol_linkmap_get_iter_end_count(*mapref);
+		for( struct HarbolVariant *iter = harbol_linkmap_get_iter(*mapref); iter && iter<end; iter++ )
+			__harbol_cfgkey_del(iter);
 		
 		harbol_linkmap_free(mapref, NULL);
 		return *mapref==NULL;
@@ -440,14 +487,12 @@ HARBOL_EXPORT struct HarbolString harbol_cfg_to_str(const struct HarbolLinkMap *
 {
 	static size_t tabs = 0;
 	struct HarbolString str = harbol_string_create("");
-	for( uindex_t i=0; i<map->vec.count; i++ ) {
-		struct HarbolKeyVal **const iter = harbol_vector_get(&map->vec, i);
-		const struct HarbolVariant *var = (const struct HarbolVariant *)(*iter)->data;
+	for( uindex_t i=0; i<harbol_linkmap_count(map); i++ ) {
+		const struct HarbolVariant *var = harbol_linkmap_index_get(map, i);
 		
-		const union ConfigVal cv = { var->data };
-		// using double pointer iterators as we need the key.
+		const union ConfigVal cv = { harbol_variant_get(var) };
 		__concat_tabs(&str, tabs);
-		harbol_string_add_format(&str, "\"%s\": ", (*iter)->key.cstr);
+		harbol_string_add_format(&str, "\"%s\": ", harbol_linkmap_index_get_key(map, i).cstr);
 		switch( var->tag ) {
 			case HarbolCfgType_Null:
 				harbol_string_add_cstr(&str, "null\n");
@@ -456,14 +501,14 @@ HARBOL_EXPORT struct HarbolString harbol_cfg_to_str(const struct HarbolLinkMap *
 				harbol_string_add_cstr(&str, "{\n");
 				tabs++;
 				struct HarbolString inner_str = harbol_cfg_to_str(*cv.section);
-				harbol_string_add_format(&str, "%s", inner_str.cstr);
+				harbol_string_add_format(&str, "%s", harbol_string_cstr(&inner_str));
 				__concat_tabs(&str, --tabs);
 				harbol_string_add_cstr(&str, "}\n");
 				harbol_string_clear(&inner_str);
 				break;
 			}
 			case HarbolCfgType_String:
-				harbol_string_add_format(&str, "\"%s\"\n", (*cv.str)->cstr);
+				harbol_string_add_format(&str, "\"%s\"\n", harbol_string_cstr(*cv.str));
 				break;
 			case HarbolCfgType_Float:
 				harbol_string_add_format(&str, "%" PRIfMAX "\n", *cv.f);
@@ -485,135 +530,149 @@ HARBOL_EXPORT struct HarbolString harbol_cfg_to_str(const struct HarbolLinkMap *
 	return str;
 }
 
-static NO_NULL bool harbol_cfg_parse_target_path(const char key[static 1], struct HarbolString *const restrict str)
-{
-	// parse something like: "root.section1.section2.section3./.dotsection"
-	const char *iter = key;
-	/*
-		iterate to the null terminator and then work backwards to the last dot.
-		ughhh too many while loops lmao.
-	*/
-	iter += strlen(key) - 1;
-	while( iter != key ) {
-		// Patch: allow keys to use dot without interfering with dot path.
-		// check if we hit a dot.
-		if( *iter=='.' ) {
-			// if we hit a dot, check if the previous char is an "escape" char.
-			if( iter[-1]=='/' || iter[-1]=='\\' )
-				iter--;
-			else {
-				iter++;
-				break;
+/// walks a key path like "root.section1.section2./.dotsection", a dot right after '/' or '\\' belongs to the key.
+static NO_NULL struct HarbolVariant *__get_var(struct HarbolLinkMap *const restrict cfgmap, const struct HarbolStrView keypath)
+{
+	const char *iter = keypath.cstr;
+	const char *const end = keypath.cstr + keypath.len;
+	struct HarbolString unescaped = EMPTY_HARBOL_STRING;
+	struct HarbolLinkMap *restrict itermap = cfgmap;
+	struct HarbolVariant *restrict var = NULL;
+	bool nested = false;
+	
+	while( itermap != NULL ) {
+		const char *const start = iter;
+		bool escaped = false;
+		while( iter < end && *iter != '.' ) {
+			if( (*iter=='/' || *iter=='\\') && iter + 1 < end && iter[1]=='.' ) {
+				escaped = true;
+				iter += 2;
 			}
-		} else iter--;
-	}
-	// now we save the target section and then use the resulting string.
-	while( *iter != 0 ) {
-		if( *iter=='/' ) {
-			iter++;
-			continue;
+			else iter++;
 		}
-		else harbol_string_add_char(str, *iter++);
-	}
-	return str->len > 0;
-}
-
-static NO_NULL struct HarbolVariant *__get_var(struct HarbolLinkMap *const restrict cfgmap, const char key[static 1])
-{
-	/* first check if we're getting a singular value OR we iterate through a sectional path. */
-	const char *dot = strchr(key, '.');
-	// Patch: dot and escaped dot glitching out the hashmap hashing...
-	if( dot==NULL || (dot>key && (dot[-1] == '/' || dot[-1] == '\\')) ) {
-		struct HarbolVariant *const restrict var = harbol_linkmap_key_get(cfgmap, key);
-		return( var==NULL || var->tag==HarbolCfgType_Null ) ? NULL : var;
-	}
-	/* ok, not a singular value, iterate to the specific linkmap section then. */
-	else {
-		// parse the target key first.
-		const char *iter = key;
-		struct HarbolString
-			sectionstr = {NULL, 0},
-			targetstr = {NULL, 0}
-		;
-		harbol_cfg_parse_target_path(key, &targetstr);
-		struct HarbolLinkMap *restrict itermap = cfgmap;
-		struct HarbolVariant *restrict var = NULL;
 		
-		while( itermap != NULL ) {
-			harbol_string_clear(&sectionstr);
-			// Patch: allow keys to use dot without interfering with dot path.
-			while( *iter != 0 ) {
-				if( (*iter=='/' || *iter=='\\') && iter[1]=='.' ) {
-					iter++;
-					harbol_string_add_char(&sectionstr, *iter++);
-				} else if( *iter=='.' ) {
-					iter++;
-					break;
-				}
-				else harbol_string_add_char(&sectionstr, *iter++);
+		struct HarbolStrView section = { start, (uintptr_t)(iter - start) };
+		/// only a section with escaped dots needs copying, every other one is looked up straight from the path.
+		if( escaped ) {
+			harbol_string_reset(&unescaped);
+			for( const char *c = start; c < iter; c++ ) {
+				if( (*c=='/' || *c=='\\') && c + 1 < iter && c[1]=='.' )
+					c++;
+				harbol_string_add_char(&unescaped, *c);
 			}
-			var = harbol_linkmap_key_get(itermap, sectionstr.cstr);
-			if( var==NULL || !harbol_string_cmpstr(&sectionstr, &targetstr) )
-				break;
-			else if( var->tag==HarbolCfgType_Linkmap )
-				itermap = *(struct HarbolLinkMap **)var->data;
+			section = harbol_string_view(&unescaped);
 		}
-		harbol_string_clear(&sectionstr);
-		harbol_string_clear(&targetstr);
-		return var;
+		
+		var = harbol_linkmap_key_get_view(itermap, section);
+		if( var==NULL || iter >= end )
+			break;
+		
+		/// a value in the middle of the path can't hold the rest of it.
+		itermap = ( var->tag==HarbolCfgType_Linkmap ) ? *(struct HarbolLinkMap **)harbol_variant_get(var) : NULL;
+		var = NULL;
+		nested = true;
+		iter++;
 	}
+	harbol_string_clear(&unescaped);
+	/// a null top-level key reads as missing.
+	return( var != NULL && !nested && var->tag==HarbolCfgType_Null ) ? NULL : var;
 }
 
 HARBOL_EXPORT struct HarbolLinkMap *harbol_cfg_get_section(struct HarbolLinkMap *const restrict cfgmap, const char key[restrict static 1])
+{
+	return harbol_cfg_get_section_view(cfgmap, harbol_strview(key));
+}
+
+HARBOL_EXPORT struct HarbolLinkMap *harbol_cfg_get_section_view(struct HarbolLinkMap *const restrict cfgmap, const struct HarbolStrView key)
 {
 	const struct HarbolVariant *const restrict var = __get_var(cfgmap, key);
-	return( var==NULL || var->tag != HarbolCfgType_Linkmap ) ? NULL : *(struct HarbolLinkMap **)var->data;
+	return( var==NULL || var->tag != HarbolCfgType_Linkmap ) ? NULL : *(struct HarbolLinkMap **)harbol_variant_get(var);
 }
 
 HARBOL_EXPORT char *harbol_cfg_get_cstr(struct HarbolLinkMap *const restrict cfgmap, const char key[restrict static 1])
+{
+	return harbol_cfg_get_cstr_view(cfgmap, harbol_strview(key));
+}
+
+HARBOL_EXPORT char *harbol_cfg_get_cstr_view(struct HarbolLinkMap *const restrict cfgmap, const struct HarbolStrView key)
 {
 	const struct HarbolVariant *const restrict var = __get_var(cfgmap, key);
-	return( var==NULL || var->tag != HarbolCfgType_String ) ? NULL : (*(struct HarbolString **)var->data)->cstr;
+	return( var==NULL || var->tag != HarbolCfgType_String ) ? NULL : harbol_string_cstr(*(struct HarbolString **)harbol_variant_get(var));
 }
 
 HARBOL_EXPORT struct HarbolString *harbol_cfg_get_str(struct HarbolLinkMap *const restrict cfgmap, const char key[restrict static 1])
+{
+	return harbol_cfg_get_str_view(cfgmap, harbol_strview(key));
+}
+
+HARBOL_EXPORT struct HarbolString *harbol_cfg_get_str_view(struct HarbolLinkMap *const restrict cfgmap, const struct HarbolStrView key)
 {
 	const struct HarbolVariant *const restrict var = __get_var(cfgmap, key);
-	return( var==NULL || var->tag != HarbolCfgType_String ) ? NULL : *(struct HarbolString **)var->data;
+	return( var==NULL || var->tag != HarbolCfgType_String ) ? NULL : *(struct HarbolString **)harbol_variant_get(var);
 }
 
 HARBOL_EXPORT floatmax_t *harbol_cfg_get_float(struct HarbolLinkMap *const restrict cfgmap, const char key[restrict static 1])
+{
+	return harbol_cfg_get_float_view(cfgmap, harbol_strview(key));
+}
+
+HARBOL_EXPORT floatmax_t *harbol_cfg_get_float_view(struct HarbolLinkMap *const restrict cfgmap, const struct HarbolStrView key)
 {
 	const struct HarbolVariant *const restrict var = __get_var(cfgmap, key);
-	return( var==NULL || var->tag != HarbolCfgType_Float ) ? NULL : (floatmax_t *)var->data;
+	return( var==NULL || var->tag != HarbolCfgType_Float ) ? NULL : (floatmax_t *)harbol_variant_get(var);
 }
 
 HARBOL_EXPORT intmax_t *harbol_cfg_get_int(struct HarbolLinkMap *const restrict cfgmap, const char key[restrict static 1])
+{
+	return harbol_cfg_get_int_view(cfgmap, harbol_strview(key));
+}
+
+HARBOL_EXPORT intmax_t *harbol_cfg_get_int_view(struct HarbolLinkMap *const restrict cfgmap, const struct HarbolStrView key)
 {
 	const struct HarbolVariant *const restrict var = __get_var(cfgmap, key);
-	return( var==NULL || var->tag != HarbolCfgType_Int ) ? NULL : (intmax_t *)var->data;
+	return( var==NULL || var->tag != HarbolCfgType_Int ) ? NULL : (intmax_t *)harbol_variant_get(var);
 }
 
 HARBOL_EXPORT bool *harbol_cfg_get_bool(struct HarbolLinkMap *const restrict cfgmap, const char key[restrict static 1])
+{
+	return harbol_cfg_get_bool_view(cfgmap, harbol_strview(key));
+}
+
+HARBOL_EXPORT bool *harbol_cfg_get_bool_view(struct HarbolLinkMap *const restrict cfgmap, const struct HarbolStrView key)
 {
 	const struct HarbolVariant *const restrict var = __get_var(cfgmap, key);
-	return( var==NULL || var->tag != HarbolCfgType_Bool ) ? NULL : (bool *)var->data;
+	return( var==NULL || var->tag != HarbolCfgType_Bool ) ? NULL : (bool *)harbol_variant_get(var);
 }
 
 HARBOL_EXPORT union HarbolColor *harbol_cfg_get_color(struct HarbolLinkMap *const restrict cfgmap, const char key[restrict static 1])
+{
+	return harbol_cfg_get_color_view(cfgmap, harbol_strview(key));
+}
+
+HARBOL_EXPORT union HarbolColor *harbol_cfg_get_color_view(struct HarbolLinkMap *const restrict cfgmap, const struct HarbolStrView key)
 {
 	const struct HarbolVariant *const restrict var = __get_var(cfgmap, key);
-	return( var==NULL || var->tag != HarbolCfgType_Color ) ? NULL : (union HarbolColor *)var->data;
+	return( var==NULL || var->tag != HarbolCfgType_Color ) ? NULL : (union HarbolColor *)harbol_variant_get(var);
 }
 
 
 HARBOL_EXPORT struct HarbolVec4D *harbol_cfg_get_vec4D(struct HarbolLinkMap *const restrict cfgmap, const char key[restrict static 1])
+{
+	return harbol_cfg_get_vec4D_view(cfgmap, harbol_strview(key));
+}
+
+HARBOL_EXPORT struct HarbolVec4D *harbol_cfg_get_vec4D_view(struct HarbolLinkMap *const restrict cfgmap, const struct HarbolStrView key)
 {
 	const struct HarbolVariant *const restrict var = __get_var(cfgmap, key);
-	return( var==NULL || var->tag != HarbolCfgType_Vec4D ) ? NULL : (struct HarbolVec4D *)var->data;
+	return( var==NULL || var->tag != HarbolCfgType_Vec4D ) ? NULL : (struct HarbolVec4D *)harbol_variant_get(var);
 }
 
 HARBOL_EXPORT enum HarbolCfgType harbol_cfg_get_type(struct HarbolLinkMap *const restrict cfgmap, const char key[restrict static 1])
+{
+	return harbol_cfg_get_type_view(cfgmap, harbol_strview(key));
+}
+
+HARBOL_EXPORT enum HarbolCfgType harbol_cfg_get_type_view(struct HarbolLinkMap *const restrict cfgmap, const struct HarbolStrView key)
 {
 	const struct HarbolVariant *const restrict var = __get_var(cfgmap, key);
 	return( var==NULL ) ? -1 : var->tag;
@@ -621,12 +680,12 @@ HARBOL_EXPORT enum HarbolCfgType harbol_cfg_get_type(struct HarbolLinkMap *const
 
 HARBOL_EXPORT bool harbol_cfg_set_str(struct HarbolLinkMap *const restrict cfgmap, const char keypath[restrict static 1], const struct HarbolString str, const bool override_convert)
 {
-	return harbol_cfg_set_cstr(cfgmap, keypath, str.cstr, override_convert);
+	return harbol_cfg_set_cstr(cfgmap, keypath, harbol_string_cstr(&str), override_convert);
 }
 
 HARBOL_EXPORT bool harbol_cfg_set_cstr(struct HarbolLinkMap *const restrict cfgmap, const char key[restrict static 1], const char cstr[restrict static 1], const bool override_convert)
 {
-	struct HarbolVariant *const restrict var = __get_var(cfgmap, key);
+	struct HarbolVariant *const restrict var = __get_var(cfgmap, harbol_strview(key));
 	if( var==NULL )
 		return false;
 	else if( var->tag != HarbolCfgType_String ) {
@@ -638,14 +697,14 @@ HARBOL_EXPORT bool harbol_cfg_set_cstr(struct HarbolLinkMap *const restrict cfgm
 		}
 		else return false;
 	} else {
-		harbol_string_copy_cstr(*(struct HarbolString **)var->data, cstr);
+		harbol_string_copy_cstr(*(struct HarbolString **)harbol_variant_get(var), cstr);
 		return true;
 	}
 }
 
 HARBOL_EXPORT bool harbol_cfg_set_float(struct HarbolLinkMap *const restrict cfgmap, const char key[restrict static 1], floatmax_t val, const bool override_convert)
 {
-	struct HarbolVariant *const restrict var = __get_var(cfgmap, key);
+	struct HarbolVariant *const restrict var = __get_var(cfgmap, harbol_strview(key));
 	if( var==NULL )
 		return false;
 	else if( var->tag != HarbolCfgType_Float ) {
@@ -656,14 +715,14 @@ HARBOL_EXPORT bool harbol_cfg_set_float(struct HarbolLinkMap *const restrict cfg
 		}
 		else return false;
 	} else {
-		*(floatmax_t *)var->data = val;
+		*(floatmax_t *)harbol_variant_get(var) = val;
 		return true;
 	}
 }
 
 HARBOL_EXPORT bool harbol_cfg_set_int(struct HarbolLinkMap *const restrict cfgmap, const char key[restrict static 1], intmax_t val, const bool override_convert)
 {
-	struct HarbolVariant *const restrict var = __get_var(cfgmap, key);
+	struct HarbolVariant *const restrict var = __get_var(cfgmap, harbol_strview(key));
 	if( var==NULL )
 		return false;
 	else if( var->tag != HarbolCfgType_Int ) {
@@ -674,14 +733,14 @@ HARBOL_EXPORT bool harbol_cfg_set_int(struct HarbolLinkMap *const restrict cfgma
 		}
 		else return false;
 	} else {
-		*(intmax_t *)var->data = val;
+		*(intmax_t *)harbol_variant_get(var) = val;
 		return true;
 	}
 }
 
 HARBOL_EXPORT bool harbol_cfg_set_bool(struct HarbolLinkMap *const restrict cfgmap, const char key[restrict static 1], bool val, const bool override_convert)
 {
-	struct HarbolVariant *const restrict var = __get_var(cfgmap, key);
+	struct HarbolVariant *const restrict var = __get_var(cfgmap, harbol_strview(key));
 	if( var==NULL )
 		return false;
 	else if( var->tag != HarbolCfgType_Bool ) {
@@ -692,14 +751,14 @@ HARBOL_EXPORT bool harbol_cfg_set_bool(struct HarbolLinkMap *const restrict cfgm
 		}
 		else return false;
 	} else {
-		*(bool *)var->data = val;
+		*(bool *)harbol_variant_get(var) = val;
 		return true;
 	}
 }
 
 HARBOL_EXPORT bool harbol_cfg_set_color(struct HarbolLinkMap *const restrict cfgmap, const char key[restrict static 1], union HarbolColor val, const bool override_convert)
 {
-	struct HarbolVariant *const restrict var = __get_var(cfgmap, key);
+	struct HarbolVariant *const restrict var = __get_var(cfgmap, harbol_strview(key));
 	if( var==NULL )
 		return false;
 	else if( var->tag != HarbolCfgType_Color ) {
@@ -710,14 +769,14 @@ HARBOL_EXPORT bool harbol_cfg_set_color(struct HarbolLinkMap *const restrict cfg
 		}
 		else return false;
 	} else {
-		*(union HarbolColor *)var->data = val;
+		*(union HarbolColor *)harbol_variant_get(var) = val;
 		return true;
 	}
 }
 
 HARBOL_EXPORT bool harbol_cfg_set_vec4D(struct HarbolLinkMap *const restrict cfgmap, const char key[restrict static 1], struct HarbolVec4D val, const bool override_convert)
 {
-	struct HarbolVariant *const restrict var = __get_var(cfgmap, key);
+	struct HarbolVariant *const restrict var = __get_var(cfgmap, harbol_strview(key));
 	if( var==NULL ) {
 		return false;
 	} else if( var->tag != HarbolCfgType_Vec4D ) {
@@ -728,14 +787,14 @@ HARBOL_EXPORT bool harbol_cfg_set_vec4D(struct HarbolLinkMap *const restrict cfg
 		}
 		else return false;
 	} else {
-		*(struct HarbolVec4D *)var->data = val;
+		*(struct HarbolVec4D *)harbol_variant_get(var) = val;
 		return true;
 	}
 }
 
 HARBOL_EXPORT bool harbol_cfg_set_to_null(struct HarbolLinkMap *const restrict cfgmap, const char key[restrict static 1])
 {
-	struct HarbolVariant *const restrict var = __get_var(cfgmap, key);
+	struct HarbolVariant *const restrict var = __get_var(cfgmap, harbol_strview(key));
 	if( var==NULL ) {
 		return false;
 	} else {
@@ -753,15 +812,13 @@ static inline NO_NULL void __write_tabs(FILE *const file, const size_t tabs)
 
 static NO_NULL bool __harbol_cfg_build_file(const struct HarbolLinkMap *const map, FILE *const file, const size_t tabs)
 {
-	const struct HarbolKeyVal **const end = harbol_linkmap_get_iter_end_count(map);
-	for( const struct HarbolKeyVal **iter = harbol_linkmap_get_iter(map); iter && iter<end; iter++ ) {
-		const struct HarbolVariant *v = (const struct HarbolVariant *)(*iter)->data;
+	for( uindex_t i=0; i<harbol_linkmap_count(map); i++ ) {
+		const struct HarbolVariant *v = harbol_linkmap_index_get(map, i);
 		const int32_t type = v->tag;
 		__write_tabs(file, tabs);
-		// using double pointer iterators as we need the key.
-		fprintf(file, "\"%s\": ", (*iter)->key.cstr);
+		fprintf(file, "\"%s\": ", harbol_linkmap_index_get_key(map, i).cstr);
 		
-		const union ConfigVal cv = {v->data};
+		const union ConfigVal cv = {harbol_variant_get(v)};
 		switch( type ) {
 			case HarbolCfgType_Null:
 				fputs("null\n", file); break;
@@ -773,7 +830,7 @@ static NO_NULL bool __harbol_cfg_build_file(const struct HarbolLinkMap *const ma
 				break;
 			
 			case HarbolCfgType_String:
-				fprintf(file, "\"%s\"\n", (*cv.str)->cstr); break;
+				fprintf(file, "\"%s\"\n", harbol_string_cstr(*cv.str)); break;
 			case HarbolCfgType_Float:
 				fprintf(file, "%" PRIfMAX "\n", *cv.f); break;
 			case HarbolCfgType_Int:
@@ -35,6 +35,9 @@ struct HarbolVec4D {
 
 HARBOL_EXPORT NO_NULL struct HarbolLinkMap *harbol_cfg_parse_file(const char filename[]);
 HARBOL_EXPORT NO_NULL struct HarbolLinkMap *harbol_cfg_parse_cstr(const char cstr[]);
+/// parses with `allocator` installed, free the config with the same allocator installed (or through a lexer created with it).
+HARBOL_EXPORT NEVER_NULL(1) struct HarbolLinkMap *harbol_cfg_parse_file_with_allocator(const char filename[], const struct HarbolAllocator *allocator);
+HARBOL_EXPORT NEVER_NULL(1) struct HarbolLinkMap *harbol_cfg_parse_cstr_with_allocator(const char cstr[], const struct HarbolAllocator *allocator);
 HARBOL_EXPORT NO_NULL bool harbol_cfg_free(struct HarbolLinkMap **cfgref);
 HARBOL_EXPORT NO_NULL struct HarbolString harbol_cfg_to_str(const struct HarbolLinkMap *cfg);
 
@@ -48,6 +51,17 @@ HARBOL_EXPORT NO_NULL union HarbolColor *harbol_cfg_get_color(struct HarbolLinkM
 HARBOL_EXPORT NO_NULL struct HarbolVec4D *harbol_cfg_get_vec4D(struct HarbolLinkMap *cfg, const char keypath[]);
 HARBOL_EXPORT NO_NULL enum HarbolCfgType harbol_cfg_get_type(struct HarbolLinkMap *cfg, const char keypath[]);
 
+/// the getters above with the key path as a view, it doesn't need to be null terminated.
+HARBOL_EXPORT NO_NULL struct HarbolLinkMap *harbol_cfg_get_section_view(struct HarbolLinkMap *cfg, struct HarbolStrView keypath);
+HARBOL_EXPORT NO_NULL char *harbol_cfg_get_cstr_view(struct HarbolLinkMap *cfg, struct HarbolStrView keypath);
+HARBOL_EXPORT NO_NULL struct HarbolString *harbol_cfg_get_str_view(struct HarbolLinkMap *cfg, struct HarbolStrView keypath);
+HARBOL_EXPORT NO_NULL floatmax_t *harbol_cfg_get_float_view(struct HarbolLinkMap *cfg, struct HarbolStrView keypath);
+HARBOL_EXPORT NO_NULL intmax_t *harbol_cfg_get_int_view(struct HarbolLinkMap *cfg, struct HarbolStrView keypath);
+HARBOL_EXPORT NO_NULL bool *harbol_cfg_get_bool_view(struct HarbolLinkMap *cfg, struct HarbolStrView keypath);
+HARBOL_EXPORT NO_NULL union HarbolColor *harbol_cfg_get_color_view(struct HarbolLinkMap *cfg, struct HarbolStrView keypath);
+HARBOL_EXPORT NO_NULL struct HarbolVec4D *harbol_cfg_get_vec4D_view(struct HarbolLinkMap *cfg, struct HarbolStrView keypath);
+HARBOL_EXPORT NO_NULL enum HarbolCfgType harbol_cfg_get_type_view(struct HarbolLinkMap *cfg, struct HarbolStrView keypath);
+
 HARBOL_EXPORT NO_NULL bool harbol_cfg_set_str(struct HarbolLinkMap *cfg, const char keypath[], struct HarbolString str, bool override_convert);
 HARBOL_EXPORT NO_NULL bool harbol_cfg_set_cstr(struct HarbolLinkMap *cfg, const char keypath[], const char cstr[], bool override_convert);
 HARBOL_EXPORT NO_NULL bool harbol_cfg_set_float(struct HarbolLinkMap *cfg, const char keypath[], floatmax_t fltval, bool override_convert);
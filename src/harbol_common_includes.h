@@ -165,13 +165,62 @@ typedef char cstring_t[];
 
 //#define HARBOL_USE_MEMPOOL
 
+/* opt-in allocation accounting, must be enabled for the library AND every program using it.
+ * a translation unit picks its category by defining HARBOL_ALLOC_CATEGORY before its includes.
+ */
+//#define HARBOL_ALLOC_STATS
+
+enum HarbolAllocCategory {
+	HarbolAllocCategory_Other,
+	HarbolAllocCategory_String,
+	HarbolAllocCategory_Vector,
+	HarbolAllocCategory_Map,
+	HarbolAllocCategory_Cfg,
+	HarbolAllocCategory_Token,
+	HarbolAllocCategory_Count
+};
+
+#ifndef HARBOL_ALLOC_CATEGORY
+#	define HARBOL_ALLOC_CATEGORY    HarbolAllocCategory_Other
+#endif
+
 #ifdef HARBOL_USE_MEMPOOL
 	struct HarbolMemPool;
 	extern struct HarbolMemPool *g_pool;
 #endif
 
-inline void *harbol_alloc(const size_t num, const size_t size)
+/* pluggable allocator, installed per thread with `harbol_allocator_swap` from alloc/alloc.h.
+ * blocks must go back to the allocator they came from, so install the same one when freeing.
+ */
+struct HarbolAllocator {
+	void *(*alloc)(void *userdata, size_t bytes);
+	void *(*realloc)(void *userdata, void *ptr, size_t bytes);
+	void (*free)(void *userdata, void *ptr);
+	void *userdata;
+};
+
+#if defined(COMPILER_GCC) || defined(COMPILER_CLANG)
+#	define HARBOL_THREAD_LOCAL    __thread
+#elif defined(COMPILER_MSVC)
+#	define HARBOL_THREAD_LOCAL    __declspec(thread)
+#else
+#	define HARBOL_THREAD_LOCAL
+#endif
+
+/// the calling thread's allocator, NULL uses calloc (or `g_pool`).
+extern HARBOL_THREAD_LOCAL const struct HarbolAllocator *g_allocator;
+
+inline void *harbol_raw_alloc(const size_t num, const size_t size)
 {
+	if( g_allocator != NULL ) {
+		if( size != 0 && num > SIZE_MAX / size )
+			return NULL;
+		/// harbol allocations are zeroed like calloc's, whatever allocator hands them out.
+		void *const ptr = g_allocator->alloc(g_allocator->userdata, num * size);
+		if( ptr != NULL )
+			memset(ptr, 0, num * size);
+		return ptr;
+	}
 #ifdef HARBOL_USE_MEMPOOL
 	void *harbol_mempool_alloc(struct HarbolMemPool *mempool, size_t bytes);
 	return harbol_mempool_alloc(g_pool, num * size);
@@ -180,8 +229,10 @@ inline void *harbol_alloc(const size_t num, const size_t size)
 #endif
 }
 
-inline void *harbol_realloc(void *const ptr, const size_t bytes)
+inline void *harbol_raw_realloc(void *const ptr, const size_t bytes)
 {
+	if( g_allocator != NULL )
+		return g_allocator->realloc(g_allocator->userdata, ptr, bytes);
 #ifdef HARBOL_USE_MEMPOOL
 	void *harbol_mempool_realloc(struct HarbolMemPool *mempool, void *ptr, size_t bytes);
 	return harbol_mempool_realloc(g_pool, ptr, bytes);
@@ -190,8 +241,13 @@ inline void *harbol_realloc(void *const ptr, const size_t bytes)
 #endif
 }
 
-inline void harbol_free(void *const ptr)
+inline void harbol_raw_free(void *const ptr)
 {
+	if( g_allocator != NULL ) {
+		if( ptr != NULL )
+			g_allocator->free(g_allocator->userdata, ptr);
+		return;
+	}
 #ifdef HARBOL_USE_MEMPOOL
 	bool harbol_mempool_free(struct HarbolMemPool *mempool, void *ptr);
 	harbol_mempool_free(g_pool, ptr);
@@ -200,15 +256,94 @@ inline void harbol_free(void *const ptr)
 #endif
 }
 
+#ifdef HARBOL_ALLOC_STATS
+/// stats builds put this in front of every block so frees know what they're giving back.
+union HarbolAllocHeader {
+	struct {
+		size_t bytes;
+		uint32_t category;
+	} info;
+	long double align_ld;
+	intmax_t align_int;
+	void *align_ptr;
+};
+
+HARBOL_EXPORT void harbol_alloc_stats_record(enum HarbolAllocCategory category, size_t old_bytes, size_t new_bytes);
+
+inline void *harbol_alloc_in(const size_t num, const size_t size, const enum HarbolAllocCategory category)
+{
+	if( size != 0 && num > (SIZE_MAX - sizeof(union HarbolAllocHeader)) / size )
+		return NULL;
+	union HarbolAllocHeader *const header = harbol_raw_alloc(1, sizeof *header + num * size);
+	if( header==NULL )
+		return NULL;
+	header->info.bytes = num * size;
+	header->info.category = category;
+	harbol_alloc_stats_record(category, 0, header->info.bytes);
+	return header + 1;
+}
+
+inline void harbol_free(void *const ptr)
+{
+	if( ptr==NULL )
+		return;
+	union HarbolAllocHeader *const header = ( union HarbolAllocHeader* )ptr - 1;
+	harbol_alloc_stats_record(header->info.category, header->info.bytes, 0);
+	harbol_raw_free(header);
+}
+
+/// `category` is only used when `ptr` is NULL, a block keeps the category it was allocated with.
+inline void *harbol_realloc_in(void *const ptr, const size_t bytes, const enum HarbolAllocCategory category)
+{
+	if( ptr==NULL )
+		return harbol_alloc_in(1, bytes, category);
+	else if( bytes==0 ) {
+		harbol_free(ptr);
+		return NULL;
+	} else if( bytes > SIZE_MAX - sizeof(union HarbolAllocHeader) )
+		return NULL;
+	union HarbolAllocHeader *const old_header = ( union HarbolAllocHeader* )ptr - 1;
+	const size_t old_bytes = old_header->info.bytes;
+	const uint32_t block_category = old_header->info.category;
+	union HarbolAllocHeader *const header = harbol_raw_realloc(old_header, sizeof *header + bytes);
+	if( header==NULL )
+		return NULL;
+	header->info.bytes = bytes;
+	harbol_alloc_stats_record(block_category, old_bytes, bytes);
+	return header + 1;
+}
+
+/// the category is picked at the call site, the shared out-of-line copies in alloc.c can't see a translation unit's define.
+#	define harbol_alloc(num, size)       harbol_alloc_in((num), (size), HARBOL_ALLOC_CATEGORY)
+#	define harbol_realloc(ptr, bytes)    harbol_realloc_in((ptr), (bytes), HARBOL_ALLOC_CATEGORY)
+#else
+inline void *harbol_alloc(const size_t num, const size_t size)
+{
+	return harbol_raw_alloc(num, size);
+}
+
+inline void *harbol_realloc(void *const ptr, const size_t bytes)
+{
+	return harbol_raw_realloc(ptr, bytes);
+}
+
+inline void harbol_free(void *const ptr)
+{
+	harbol_raw_free(ptr);
+}
+#endif
+
 inline void harbol_clean(void **const ptrref)
 {
-#ifdef HARBOL_USE_MEMPOOL
+#if defined(HARBOL_USE_MEMPOOL) && !defined(HARBOL_ALLOC_STATS)
 	bool harbol_mempool_cleanup(struct HarbolMemPool *mempool, void **ptrref);
-	harbol_mempool_cleanup(g_pool, ptrref);
-#else
-	free(*ptrref);
-	*ptrref = NULL;
+	if( g_allocator==NULL ) {
+		harbol_mempool_cleanup(g_pool, ptrref);
+		return;
+	}
 #endif
+	harbol_free(*ptrref);
+	*ptrref = NULL;
 }
 
 static inline bool harbol_generic_vector_resizer(void *const vec, const size_t new_size, const size_t element_size)
@@ -270,6 +405,118 @@ static inline NO_NULL size_t string_hash(const char key[])
 	return h;
 }
 
+static inline uint64_t harbol_mix64(uint64_t x)
+{
+	x ^= x >> 33;
+	x *= 0xff51afd7ed558ccdull;
+	x ^= x >> 33;
+	x *= 0xc4ceb9fe1a85ec53ull;
+	x ^= x >> 33;
+	return x;
+}
+
+// word-at-a-time hash for arbitrary byte buffers.
+// result is stable across processes for the same seed (on the same byte order).
+static inline uint64_t bytes_hash64(const void *const data, size_t len, const uint64_t seed)
+{
+	const uint8_t *restrict p = data;
+	uint64_t h = seed ^ (len * 0x9e3779b97f4a7c15ull);
+	while( len >= sizeof(uint64_t) ) {
+		uint64_t w; memcpy(&w, p, sizeof w);
+		h = (h ^ harbol_mix64(w)) * 0x9e3779b97f4a7c15ull;
+		h = (h << 29) | (h >> 35);
+		p += sizeof w, len -= sizeof w;
+	}
+	if( len > 0 ) {
+		uint64_t w = 0; memcpy(&w, p, len);
+		h = (h ^ harbol_mix64(w ^ len)) * 0x9e3779b97f4a7c15ull;
+	}
+	return harbol_mix64(h);
+}
+
+#if defined(__SIZEOF_INT128__)
+__extension__ typedef unsigned __int128    harbol_uint128_t;
+#endif
+
+/// full 64x64 -> 128 bit multiply, `*a` gets the low half & `*b` the high half.
+static inline void harbol_mul128(uint64_t *const a, uint64_t *const b)
+{
+#if defined(__SIZEOF_INT128__)
+	const harbol_uint128_t r = ( harbol_uint128_t )*a * *b;
+	*a = ( uint64_t )r;
+	*b = ( uint64_t )(r >> 64);
+#else
+	const uint64_t
+		ha = *a >> 32, hb = *b >> 32,
+		la = ( uint32_t )*a, lb = ( uint32_t )*b,
+		rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb,
+		t = rl + (rm0 << 32), c = t < rl,
+		lo = t + (rm1 << 32)
+	;
+	*b = rh + (rm0 >> 32) + (rm1 >> 32) + c + (lo < t);
+	*a = lo;
+#endif
+}
+
+static inline uint64_t harbol_mum(uint64_t a, uint64_t b)
+{
+	harbol_mul128(&a, &b);
+	return a ^ b;
+}
+
+static inline uint64_t __harbol_read64(const uint8_t p[const])
+{
+	uint64_t v; memcpy(&v, p, sizeof v);
+	return v;
+}
+
+static inline uint64_t __harbol_read32(const uint8_t p[const])
+{
+	uint32_t v; memcpy(&v, p, sizeof v);
+	return v;
+}
+
+// wyhash (final version 4): reads 16 bytes per round, 48 per round on long keys, and finishes with a 128-bit multiply.
+// short keys are read with overlapping loads instead of a byte loop.
+static inline uint64_t harbol_wyhash(const void *const data, const size_t len, uint64_t seed)
+{
+	static const uint64_t s[4] = { 0xa0761d6478bd642full, 0xe7037ed1a0b428dbull, 0x8ebc6af09c88c6e3ull, 0x589965cc75374cc3ull };
+	const uint8_t *p = data;
+	uint64_t a = 0, b = 0;
+	seed ^= harbol_mum(seed ^ s[0], s[1]);
+	if( len <= 16 ) {
+		if( len >= 4 ) {
+			const size_t mid = (len >> 3) << 2;
+			a = (__harbol_read32(p) << 32) | __harbol_read32(p + mid);
+			b = (__harbol_read32(p + len - 4) << 32) | __harbol_read32(p + len - 4 - mid);
+		} else if( len > 0 ) {
+			a = (( uint64_t )p[0] << 16) | (( uint64_t )p[len >> 1] << 8) | p[len - 1];
+		}
+	} else {
+		size_t i = len;
+		if( i > 48 ) {
+			uint64_t see1 = seed, see2 = seed;
+			do {
+				seed = harbol_mum(__harbol_read64(p) ^ s[1], __harbol_read64(p + 8) ^ seed);
+				see1 = harbol_mum(__harbol_read64(p + 16) ^ s[2], __harbol_read64(p + 24) ^ see1);
+				see2 = harbol_mum(__harbol_read64(p + 32) ^ s[3], __harbol_read64(p + 40) ^ see2);
+				p += 48, i -= 48;
+			} while( i > 48 );
+			seed ^= see1 ^ see2;
+		}
+		while( i > 16 ) {
+			seed = harbol_mum(__harbol_read64(p) ^ s[1], __harbol_read64(p + 8) ^ seed);
+			p += 16, i -= 16;
+		}
+		a = __harbol_read64(p + i - 16);
+		b = __harbol_read64(p + i - 8);
+	}
+	a ^= s[1];
+	b ^= seed;
+	harbol_mul128(&a, &b);
+	return harbol_mum(a ^ s[0] ^ len, b ^ s[1]);
+}
+
 static inline size_t int_hash(const size_t a)
 {
 	return (((a ^ (a>>4)) ^ 0xdeadbeef) + ((a ^ (a>>4))<<5)) ^ ((a>>11) * 37);
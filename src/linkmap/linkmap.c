@@ -1,3 +1,4 @@
+#define HARBOL_ALLOC_CATEGORY    HarbolAllocCategory_Map
 #include "linkmap.h"
 
 #ifdef OS_WINDOWS
@@ -15,14 +16,28 @@ HARBOL_EXPORT struct HarbolLinkMap *harbol_linkmap_new(const size_t datasize)
 
 HARBOL_EXPORT struct HarbolLinkMap harbol_linkmap_create(const size_t datasize)
 {
-	struct HarbolLinkMap map = { harbol_map_create(datasize), harbol_vector_create(sizeof(struct HarbolKeyVal *), MAP_DEFAULT_SIZE)};
+	struct HarbolLinkMap map = {.datasize = datasize};
 	return map;
 }
 
+/// runs `dtor` over every value, values are inline so only what they own gets released.
+static NO_NULL void __harbol_linkmap_destroy_vals(struct HarbolLinkMap *const map, const size_t start, const size_t end, void dtor(void**))
+{
+	for( size_t i=start; i<end; i++ ) {
+		void *val = &map->vals[i * map->datasize];
+		dtor(&val);
+	}
+}
+
 HARBOL_EXPORT bool harbol_linkmap_clear(struct HarbolLinkMap *const map, void dtor(void**))
 {
-	harbol_map_clear(&map->map, dtor);
-	harbol_vector_clear(&map->vec, NULL);
+	if( dtor != NULL )
+		__harbol_linkmap_destroy_vals(map, 0, map->count, dtor);
+	harbol_free(map->keys), map->keys=NULL;
+	harbol_free(map->vals), map->vals=NULL;
+	harbol_free(map->slots), map->slots=NULL;
+	harbol_string_clear(&map->pool);
+	map->count = map->cap = map->len = 0;
 	return true;
 }
 
@@ -35,129 +50,326 @@ HARBOL_EXPORT bool harbol_linkmap_free(struct HarbolLinkMap **const mapref, void
 
 HARBOL_EXPORT size_t harbol_linkmap_count(const struct HarbolLinkMap *const map)
 {
-	return map->vec.count;
+	return map->count;
+}
+
+/// the key of entry `index`, straight out of the pool.
+static inline NO_NULL struct HarbolStrView __harbol_linkmap_key(const struct HarbolLinkMap *const map, const size_t index)
+{
+	return harbol_strview_n(&harbol_string_cstr(&map->pool)[map->keys[index].off], map->keys[index].len);
+}
+
+static inline size_t __harbol_linkmap_dist(const size_t len, const size_t hash, const size_t index)
+{
+	return (index - hash) & (len - 1);
+}
+
+/// the index slot pointing at `key`, NULL if the map doesn't have it.
+static NO_NULL struct HarbolLinkMapSlot *__harbol_linkmap_probe(const struct HarbolLinkMap *const map, const struct HarbolStrView key, const size_t hash)
+{
+	if( map->slots==NULL || key.cstr==NULL )
+		return NULL;
+	
+	const size_t mask = map->len - 1;
+	for( size_t i = hash & mask, dist = 0;; i = (i + 1) & mask, dist++ ) {
+		struct HarbolLinkMapSlot *const slot = &map->slots[i];
+		if( slot->index==0 || __harbol_linkmap_dist(map->len, slot->hash, i) < dist )
+			return NULL;
+		else if( slot->hash==hash && harbol_strview_eq(__harbol_linkmap_key(map, slot->index - 1), key) )
+			return slot;
+	}
+}
+
+static inline NO_NULL struct HarbolLinkMapSlot *__harbol_linkmap_find(const struct HarbolLinkMap *const map, const struct HarbolStrView key)
+{
+	return( key.cstr==NULL || map->slots==NULL ) ? NULL : __harbol_linkmap_probe(map, key, harbol_strview_hash(key));
+}
+
+/// same robin hood placement as HarbolMap's.
+static void __harbol_linkmap_place(struct HarbolLinkMapSlot slots[const static 1], const size_t len, struct HarbolLinkMapSlot entry)
+{
+	const size_t mask = len - 1;
+	for( size_t i = entry.hash & mask, dist = 0;; i = (i + 1) & mask, dist++ ) {
+		struct HarbolLinkMapSlot *const slot = &slots[i];
+		if( slot->index==0 ) {
+			*slot = entry;
+			return;
+		}
+		
+		const size_t slot_dist = __harbol_linkmap_dist(len, slot->hash, i);
+		if( slot_dist < dist ) {
+			const struct HarbolLinkMapSlot displaced = *slot;
+			*slot = entry;
+			entry = displaced;
+			dist = slot_dist;
+		}
+	}
+}
+
+static void __harbol_linkmap_remove_slot(struct HarbolLinkMapSlot slots[const static 1], const size_t len, size_t index)
+{
+	const size_t mask = len - 1;
+	for( size_t next = (index + 1) & mask; slots[next].index != 0 && __harbol_linkmap_dist(len, slots[next].hash, next) > 0; next = (next + 1) & mask ) {
+		slots[index] = slots[next];
+		index = next;
+	}
+	slots[index].index = 0;
+	slots[index].hash = 0;
+}
+
+/// builds a fresh index of `len` slots from the entries, their stored hashes mean no key gets rehashed.
+static NO_NULL bool __harbol_linkmap_reindex(struct HarbolLinkMap *const map, const size_t len)
+{
+	if( len > SIZE_MAX / (2 * sizeof *map->slots) )
+		return false;
+	
+	struct HarbolLinkMapSlot *const slots = harbol_alloc(len, sizeof *slots);
+	if( slots==NULL )
+		return false;
+	
+	for( size_t i=0; i<map->count; i++ )
+		__harbol_linkmap_place(slots, len, (struct HarbolLinkMapSlot){ map->keys[i].hash, i + 1 });
+	harbol_free(map->slots), map->slots=NULL;
+	map->slots = slots;
+	map->len = len;
+	return true;
+}
+
+/// grows the entry arrays to hold `cap` entries.
+static NO_NULL bool __harbol_linkmap_reserve(struct HarbolLinkMap *const map, const size_t cap)
+{
+	if( cap > SIZE_MAX / sizeof *map->keys || cap > SIZE_MAX / map->datasize )
+		return false;
+	
+	struct HarbolLinkMapKey *const keys = harbol_realloc(map->keys, cap * sizeof *keys);
+	if( keys==NULL )
+		return false;
+	map->keys = keys;
+	
+	uint8_t *const vals = harbol_realloc(map->vals, cap * map->datasize);
+	if( vals==NULL )
+		return false;
+	map->vals = vals;
+	map->cap = cap;
+	return true;
+}
+
+/// rewrites the pool with only the keys still in the map.
+static NO_NULL bool __harbol_linkmap_compact_pool(struct HarbolLinkMap *const map)
+{
+	struct HarbolString pool = EMPTY_HARBOL_STRING;
+	for( size_t i=0; i<map->count; i++ ) {
+		const struct HarbolStrView key = __harbol_linkmap_key(map, i);
+		if( !harbol_string_add_buf(&pool, key.cstr, key.len) || !harbol_string_add_char(&pool, '\0') ) {
+			harbol_string_clear(&pool);
+			return false;
+		}
+	}
+	
+	uint32_t off = 0;
+	for( size_t i=0; i<map->count; i++ ) {
+		map->keys[i].off = off;
+		off += map->keys[i].len + 1;
+	}
+	harbol_string_clear(&map->pool);
+	map->pool = pool;
+	return true;
 }
 
 HARBOL_EXPORT bool harbol_linkmap_has_key(const struct HarbolLinkMap *const restrict map, const char key[restrict static 1])
 {
-	return harbol_map_has_key(&map->map, key);
+	return harbol_linkmap_has_key_view(map, harbol_strview(key));
+}
+
+HARBOL_EXPORT bool harbol_linkmap_has_key_view(const struct HarbolLinkMap *const map, const struct HarbolStrView key)
+{
+	return __harbol_linkmap_find(map, key) != NULL;
 }
 
 HARBOL_EXPORT bool harbol_linkmap_insert(struct HarbolLinkMap *const restrict map, const char key[restrict static 1], void *const restrict val)
 {
-	harbol_map_insert(&map->map, key, val);
-	struct HarbolKeyVal *kv = harbol_map_get_kv(&map->map, key);
-	harbol_vector_insert(&map->vec, &kv);
-	return true;
+	return harbol_linkmap_insert_view(map, harbol_strview(key), val);
 }
 
-HARBOL_EXPORT bool harbol_linkmap_insert_kv(struct HarbolLinkMap *const map, struct HarbolKeyVal *kv)
+HARBOL_EXPORT bool harbol_linkmap_insert_view(struct HarbolLinkMap *const restrict map, const struct HarbolStrView key, void *const restrict val)
 {
-	harbol_map_insert_kv(&map->map, kv);
-	harbol_vector_insert(&map->vec, &kv);
+	if( map->datasize==0 || key.cstr==NULL || key.len >= UINT32_MAX - map->pool.len )
+		return false;
+	
+	const size_t hash = harbol_strview_hash(key);
+	if( __harbol_linkmap_probe(map, key, hash) != NULL )
+		return false;
+	/// same 3/4 load limit as HarbolMap, the whole index gets rebuilt since linked maps stay small.
+	else if( (map->count + 1) * 4 > map->len * 3 && !__harbol_linkmap_reindex(map, (map->len==0) ? MAP_DEFAULT_SIZE : map->len << 1) )
+		return false;
+	else if( map->count==map->cap && !__harbol_linkmap_reserve(map, (map->cap==0) ? MAP_DEFAULT_SIZE : map->cap << 1) )
+		return false;
+	
+	/// reserving first means the key's bytes & terminator can't half go in, doubling keeps appends amortized.
+	const uint32_t off = ( uint32_t )map->pool.len;
+	const size_t pool_cap = harbol_string_cap(&map->pool), needed = off + key.len + 1;
+	if( needed > pool_cap && !harbol_string_reserve(&map->pool, (needed < pool_cap * 2) ? pool_cap * 2 : needed) )
+		return false;
+	harbol_string_add_buf(&map->pool, key.cstr, key.len);
+	harbol_string_add_char(&map->pool, '\0');
+	
+	map->keys[map->count] = (struct HarbolLinkMapKey){ hash, off, ( uint32_t )key.len };
+	memcpy(&map->vals[map->count * map->datasize], val, map->datasize);
+	__harbol_linkmap_place(map->slots, map->len, (struct HarbolLinkMapSlot){ hash, map->count + 1 });
+	map->count++;
 	return true;
 }
 
 
 HARBOL_EXPORT void *harbol_linkmap_key_get(const struct HarbolLinkMap *const restrict map, const char key[restrict static 1])
 {
-	return harbol_map_get(&map->map, key);
+	return harbol_linkmap_key_get_view(map, harbol_strview(key));
 }
 
-HARBOL_EXPORT void *harbol_linkmap_index_get(const struct HarbolLinkMap *const map, const uindex_t index)
+HARBOL_EXPORT void *harbol_linkmap_key_get_view(const struct HarbolLinkMap *const map, const struct HarbolStrView key)
 {
-	struct HarbolKeyVal **kv = harbol_vector_get(&map->vec, index);
-	return( kv==NULL ) ? NULL : (*kv)->data;
+	const struct HarbolLinkMapSlot *const slot = __harbol_linkmap_find(map, key);
+	return( slot==NULL ) ? NULL : &map->vals[(slot->index - 1) * map->datasize];
 }
 
+HARBOL_EXPORT bool harbol_linkmap_has_key_n(const struct HarbolLinkMap *const restrict map, const char key[restrict static 1], const size_t len)
+{
+	return harbol_linkmap_has_key_view(map, harbol_strview_n(key, len));
+}
 
-HARBOL_EXPORT struct HarbolKeyVal *harbol_linkmap_key_get_kv(const struct HarbolLinkMap *const map, const char key[restrict static 1])
+HARBOL_EXPORT void *harbol_linkmap_key_get_n(const struct HarbolLinkMap *const restrict map, const char key[restrict static 1], const size_t len)
 {
-	return harbol_map_get_kv(&map->map, key);
+	return harbol_linkmap_key_get_view(map, harbol_strview_n(key, len));
 }
 
-HARBOL_EXPORT struct HarbolKeyVal *harbol_linkmap_index_get_kv(const struct HarbolLinkMap *const map, const uindex_t index)
+HARBOL_EXPORT void *harbol_linkmap_index_get(const struct HarbolLinkMap *const map, const uindex_t index)
 {
-	struct HarbolKeyVal **kv = harbol_vector_get(&map->vec, index);
-	return( kv==NULL ) ? NULL : *kv;
+	return( index >= map->count ) ? NULL : &map->vals[index * map->datasize];
+}
+
+HARBOL_EXPORT struct HarbolStrView harbol_linkmap_index_get_key(const struct HarbolLinkMap *const map, const uindex_t index)
+{
+	return( index >= map->count ) ? (struct HarbolStrView)EMPTY_HARBOL_STRVIEW : __harbol_linkmap_key(map, index);
 }
 
 
 HARBOL_EXPORT bool harbol_linkmap_key_set(struct HarbolLinkMap *const map, const char key[restrict static 1], void *const restrict val)
 {
-	return harbol_map_set(&map->map, key, val);
+	return harbol_linkmap_key_set_view(map, harbol_strview(key), val);
+}
+
+HARBOL_EXPORT bool harbol_linkmap_key_set_view(struct HarbolLinkMap *const map, const struct HarbolStrView key, void *const restrict val)
+{
+	if( map->datasize==0 )
+		return false;
+	
+	const struct HarbolLinkMapSlot *const slot = __harbol_linkmap_find(map, key);
+	if( slot==NULL )
+		return harbol_linkmap_insert_view(map, key, val);
+	else {
+		memcpy(&map->vals[(slot->index - 1) * map->datasize], val, map->datasize);
+		return true;
+	}
 }
 
 HARBOL_EXPORT bool harbol_linkmap_index_set(struct HarbolLinkMap *const map, const uindex_t index, void *const restrict val)
 {
-	struct HarbolKeyVal **kv = harbol_vector_get(&map->vec, index);
-	return( kv==NULL || map->map.datasize==0 ) ? false : memcpy((*kv)->data, val, map->map.datasize) != NULL;
+	return( index >= map->count || map->datasize==0 ) ? false : memcpy(&map->vals[index * map->datasize], val, map->datasize) != NULL;
 }
 
 HARBOL_EXPORT bool harbol_linkmap_key_del(struct HarbolLinkMap *const map, const char key[restrict static 1], void dtor(void**))
 {
-	struct HarbolKeyVal *kv = harbol_map_get_kv(&map->map, key);
-	harbol_map_del(&map->map, key, dtor);
-	harbol_vector_del(&map->vec, harbol_vector_index_of(&map->vec, &kv, 0), NULL);
-	return true;
+	return harbol_linkmap_key_del_view(map, harbol_strview(key), dtor);
+}
+
+HARBOL_EXPORT bool harbol_linkmap_key_del_view(struct HarbolLinkMap *const map, const struct HarbolStrView key, void dtor(void**))
+{
+	const struct HarbolLinkMapSlot *const slot = __harbol_linkmap_find(map, key);
+	return( slot==NULL ) ? false : harbol_linkmap_index_del(map, slot->index - 1, dtor);
 }
 
 HARBOL_EXPORT bool harbol_linkmap_index_del(struct HarbolLinkMap *const map, const uindex_t index, void dtor(void**))
 {
-	struct HarbolKeyVal **kv = harbol_vector_get(&map->vec, index);
-	if( !kv )
+	if( index >= map->count )
 		return false;
-	else {
-		harbol_map_del(&map->map, (*kv)->key.cstr, dtor);
-		harbol_vector_del(&map->vec, index, NULL);
-		return true;
-	}
+	else if( dtor != NULL )
+		__harbol_linkmap_destroy_vals(map, index, index + 1, dtor);
+	
+	/// drop the entry's slot, then every slot past it points one entry lower once the arrays shift down.
+	struct HarbolLinkMapSlot *const slot = __harbol_linkmap_probe(map, __harbol_linkmap_key(map, index), map->keys[index].hash);
+	__harbol_linkmap_remove_slot(map->slots, map->len, (uintptr_t)(slot - map->slots));
+	for( size_t i=0; i<map->len; i++ )
+		if( map->slots[i].index > index + 1 )
+			map->slots[i].index--;
+	
+	const size_t after = map->count - index - 1;
+	memmove(&map->keys[index], &map->keys[index + 1], after * sizeof *map->keys);
+	memmove(&map->vals[index * map->datasize], &map->vals[(index + 1) * map->datasize], after * map->datasize);
+	map->count--;
+	
+	/// deleted keys leave their bytes in the pool, tidy it once they're most of it.
+	size_t live = 0;
+	for( size_t i=0; i<map->count; i++ )
+		live += map->keys[i].len + 1;
+	if( map->pool.len - live > live )
+		__harbol_linkmap_compact_pool(map);
+	return true;
 }
 
 HARBOL_EXPORT index_t harbol_linkmap_get_key_index(const struct HarbolLinkMap *const map, const char key[restrict static 1])
 {
-	if( map->vec.datasize==0 )
-		return -1;
-	else {
-		for( uindex_t i=0; i<map->vec.count; i++ ) {
-			struct HarbolKeyVal **kv = harbol_vector_get(&map->vec, i);
-			if( !harbol_string_cmpcstr(&(*kv)->key, key) )
-				return i;
-		}
-		return -1;
-	}
+	return harbol_linkmap_get_key_index_view(map, harbol_strview(key));
 }
 
-HARBOL_EXPORT index_t harbol_linkmap_get_node_index(const struct HarbolLinkMap *const map, struct HarbolKeyVal *findkv)
+HARBOL_EXPORT index_t harbol_linkmap_get_key_index_view(const struct HarbolLinkMap *const map, const struct HarbolStrView key)
 {
-	return harbol_vector_index_of(&map->vec, &findkv, 0);
+	const struct HarbolLinkMapSlot *const slot = __harbol_linkmap_find(map, key);
+	return( slot==NULL ) ? -1 : ( index_t )(slot->index - 1);
 }
 
 HARBOL_EXPORT index_t harbol_linkmap_get_val_index(const struct HarbolLinkMap *const map, void *const restrict val)
 {
-	if( map->map.datasize==0 )
+	if( map->datasize==0 )
 		return -1;
 	else {
-		for( uindex_t i=0; i<map->vec.count; i++ ) {
-			struct HarbolKeyVal **kv = harbol_vector_get(&map->vec, i);
-			if( !memcmp((*kv)->data, val, map->map.datasize) )
+		for( uindex_t i=0; i<map->count; i++ )
+			if( !memcmp(&map->vals[i * map->datasize], val, map->datasize) )
 				return i;
-		}
 		return -1;
 	}
 }
 
 HARBOL_EXPORT void *harbol_linkmap_get_iter(const struct HarbolLinkMap *const map)
 {
-	return harbol_vector_get_iter(&map->vec);
+	return map->vals;
 }
 
 HARBOL_EXPORT void *harbol_linkmap_get_iter_end_count(const struct HarbolLinkMap *const map)
 {
-	return harbol_vector_get_iter_end_count(&map->vec);
+	return( map->vals==NULL ) ? NULL : &map->vals[map->count * map->datasize];
 }
 
 HARBOL_EXPORT void *harbol_linkmap_get_iter_end_len(const struct HarbolLinkMap *const map)
 {
-	return harbol_vector_get_iter_end_len(&map->vec);
+	return( map->vals==NULL ) ? NULL : &map->vals[map->cap * map->datasize];
+}
+
+HARBOL_EXPORT struct HarbolFrozenMap *harbol_linkmap_freeze(const struct HarbolLinkMap *const map)
+{
+	struct HarbolStrView *keys = harbol_alloc(map->count + 1, sizeof *keys);
+	const void **vals = harbol_alloc(map->count + 1, sizeof *vals);
+	struct HarbolFrozenMap *fmap = NULL;
+	if( keys==NULL || vals==NULL )
+		goto harbol_linkmap_freeze_exit;
+	
+	for( size_t i=0; i<map->count; i++ ) {
+		keys[i] = __harbol_linkmap_key(map, i);
+		vals[i] = &map->vals[i * map->datasize];
+	}
+	fmap = harbol_frozen_map_build(keys, vals, map->count, map->datasize);
+	
+harbol_linkmap_freeze_exit:
+	harbol_free(keys), keys=NULL;
+	harbol_free(vals), vals=NULL;
+	return fmap;
 }
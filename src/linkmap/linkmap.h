@@ -10,13 +10,41 @@ extern "C" {
 #include "../map/map.h"
 
 
+/// where an entry's key sits in the pool, its hash is kept so growing the index never rehashes.
+struct HarbolLinkMapKey {
+	size_t hash;
+	uint32_t off, len;
+};
+
+/// a slot of the hash index, it points at an entry by its insertion order position.
+struct HarbolLinkMapSlot {
+	size_t hash;
+	size_t index;   /// entry index + 1, 0 when the slot is empty.
+};
+
+/* entries sit back to back in insertion order: `keys[i]` & the value at `vals + i * datasize` make up the i-th entry,
+ * key bytes go in one null separated pool & values are stored inline, so walking the map is a linear scan.
+ * a robin hood index like HarbolMap's maps a key to its position.
+ * deleting shifts the later entries down & leaves the key's bytes in the pool, which is compacted once dead bytes outweigh live ones.
+ * both arrays & the pool move when they grow, shift or compact: a value pointer from `key_get`/`index_get`/the iterators
+ * or a key view from `index_get_key` is only good until the next insert or delete.
+ */
 struct HarbolLinkMap {
-	struct HarbolMap map;
-	struct HarbolVector vec;
+	struct HarbolLinkMapKey *keys;
+	uint8_t *vals;
+	struct HarbolString pool;
+	struct HarbolLinkMapSlot *slots;
+	size_t
+		count,
+		cap,      /// entries `keys` & `vals` have room for.
+		len,      /// index slots, always a power of 2.
+		datasize
+	;
 };
 
-#define EMPTY_HARBOL_LINKMAP    { EMPTY_HARBOL_VECTOR, EMPTY_HARBOL_MAP }
+#define EMPTY_HARBOL_LINKMAP    { NULL, NULL, EMPTY_HARBOL_STRING, NULL, 0, 0, 0, 0 }
 
+/// values are inline, so a `dtor` gets the address of a pointer to the value & must only release what the value owns, not keep the pointer.
 HARBOL_EXPORT struct HarbolLinkMap *harbol_linkmap_new(size_t datasize);
 HARBOL_EXPORT struct HarbolLinkMap harbol_linkmap_create(size_t datasize);
 HARBOL_EXPORT NEVER_NULL(1) bool harbol_linkmap_clear(struct HarbolLinkMap *map, void dtor(void**));
@@ -26,13 +54,11 @@ HARBOL_EXPORT NO_NULL size_t harbol_linkmap_count(const struct HarbolLinkMap *ma
 HARBOL_EXPORT NO_NULL bool harbol_linkmap_has_key(const struct HarbolLinkMap *map, const char key[]);
 
 HARBOL_EXPORT NO_NULL bool harbol_linkmap_insert(struct HarbolLinkMap *map, const char key[], void *val);
-HARBOL_EXPORT NO_NULL bool harbol_linkmap_insert_kv(struct HarbolLinkMap *map, struct HarbolKeyVal *kv);
 
 HARBOL_EXPORT NO_NULL void *harbol_linkmap_key_get(const struct HarbolLinkMap *map, const char key[]);
 HARBOL_EXPORT NO_NULL void *harbol_linkmap_index_get(const struct HarbolLinkMap *map, uindex_t index);
-
-HARBOL_EXPORT NO_NULL struct HarbolKeyVal *harbol_linkmap_key_get_kv(const struct HarbolLinkMap *map, const char key[]);
-HARBOL_EXPORT NO_NULL struct HarbolKeyVal *harbol_linkmap_index_get_kv(const struct HarbolLinkMap *map, uindex_t index);
+/// the key of the `index`-th entry, its chars are null terminated. an empty view if there's no such entry.
+HARBOL_EXPORT NO_NULL struct HarbolStrView harbol_linkmap_index_get_key(const struct HarbolLinkMap *map, uindex_t index);
 
 HARBOL_EXPORT NO_NULL bool harbol_linkmap_key_set(struct HarbolLinkMap *map, const char key[], void *val);
 HARBOL_EXPORT NO_NULL bool harbol_linkmap_index_set(struct HarbolLinkMap *map, uindex_t index, void *val);
@@ -41,9 +67,23 @@ HARBOL_EXPORT NEVER_NULL(1, 2) bool harbol_linkmap_key_del(struct HarbolLinkMap
 HARBOL_EXPORT NEVER_NULL(1) bool harbol_linkmap_index_del(struct HarbolLinkMap *map, uindex_t index, void dtor(void**));
 
 HARBOL_EXPORT NO_NULL index_t harbol_linkmap_get_key_index(const struct HarbolLinkMap *linkmap, const char key[]);
-HARBOL_EXPORT NO_NULL index_t harbol_linkmap_get_node_index(const struct HarbolLinkMap *linkmap, struct HarbolKeyVal *kv);
 HARBOL_EXPORT NO_NULL index_t harbol_linkmap_get_val_index(const struct HarbolLinkMap *linkmap, void *val);
 
+/// same as the above but keyed by a view, the key doesn't need to be null terminated.
+HARBOL_EXPORT NO_NULL bool harbol_linkmap_has_key_view(const struct HarbolLinkMap *map, struct HarbolStrView key);
+HARBOL_EXPORT NEVER_NULL(1, 3) bool harbol_linkmap_insert_view(struct HarbolLinkMap *map, struct HarbolStrView key, void *val);
+HARBOL_EXPORT NO_NULL void *harbol_linkmap_key_get_view(const struct HarbolLinkMap *map, struct HarbolStrView key);
+HARBOL_EXPORT NEVER_NULL(1, 3) bool harbol_linkmap_key_set_view(struct HarbolLinkMap *map, struct HarbolStrView key, void *val);
+HARBOL_EXPORT NEVER_NULL(1) bool harbol_linkmap_key_del_view(struct HarbolLinkMap *map, struct HarbolStrView key, void dtor(void**));
+HARBOL_EXPORT NO_NULL index_t harbol_linkmap_get_key_index_view(const struct HarbolLinkMap *linkmap, struct HarbolStrView key);
+
+/// same again but by (pointer, length), for probing from a source buffer.
+HARBOL_EXPORT NO_NULL bool harbol_linkmap_has_key_n(const struct HarbolLinkMap *map, const char key[], size_t len);
+HARBOL_EXPORT NO_NULL void *harbol_linkmap_key_get_n(const struct HarbolLinkMap *map, const char key[], size_t len);
+
+/// a read-only copy that keeps the insertion order for `harbol_frozen_map_key_at`/`val_at`.
+HARBOL_EXPORT NO_NULL struct HarbolFrozenMap *harbol_linkmap_freeze(const struct HarbolLinkMap *map);
+
 #ifdef C11
 #	define harbol_linkmap_get(map, key)     _Generic((key)+0, \
 												int8_t : harbol_linkmap_index_get, \
@@ -58,19 +98,6 @@ HARBOL_EXPORT NO_NULL index_t harbol_linkmap_get_val_index(const struct HarbolLi
 												const char* : harbol_linkmap_key_get) \
 											((map), (key))
 											
-#	define harbol_linkmap_get_kv(map, key)      _Generic((key)+0, \
-													int8_t : harbol_linkmap_index_get_kv, \
-													uint8_t : harbol_linkmap_index_get_kv, \
-													int16_t : harbol_linkmap_index_get_kv, \
-													uint16_t : harbol_linkmap_index_get_kv, \
-													int32_t : harbol_linkmap_index_get_kv, \
-													uint32_t : harbol_linkmap_index_get_kv, \
-													int64_t : harbol_linkmap_index_get_kv, \
-													uint64_t : harbol_linkmap_index_get_kv, \
-													char* : harbol_linkmap_key_get_kv, \
-													const char* : harbol_linkmap_key_get_kv) \
-												((map), (key))
-											
 #	define harbol_linkmap_set(map, key, val)    _Generic((key)+0, \
 													int8_t : harbol_linkmap_index_set, \
 													uint8_t : harbol_linkmap_index_set, \
@@ -106,13 +133,12 @@ HARBOL_EXPORT NO_NULL index_t harbol_linkmap_get_val_index(const struct HarbolLi
 													uint32_t : harbol_linkmap_get_val_index, \
 													int64_t : harbol_linkmap_get_val_index, \
 													uint64_t : harbol_linkmap_get_val_index, \
-													struct HarbolKeyVal* : harbol_linkmap_get_node_index, \
-													const struct HarbolKeyVal* : harbol_linkmap_get_node_index, \
 													char* : harbol_linkmap_get_key_index, \
 													const char* : harbol_linkmap_get_key_index) \
 												((map), (key), (dtor))
 #endif
 
+/// iterators walk the values in insertion order, `harbol_linkmap_index_get_key` gives the matching key. don't insert or delete mid-walk.
 HARBOL_EXPORT NO_NULL void *harbol_linkmap_get_iter(const struct HarbolLinkMap *map);
 HARBOL_EXPORT NO_NULL void *harbol_linkmap_get_iter_end_count(const struct HarbolLinkMap *map);
 HARBOL_EXPORT NO_NULL void *harbol_linkmap_get_iter_end_len(const struct HarbolLinkMap *map);
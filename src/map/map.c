@@ -1,38 +1,57 @@
+#define HARBOL_ALLOC_CATEGORY    HarbolAllocCategory_Map
 #include "map.h"
 
 #ifdef OS_WINDOWS
 #	define HARBOL_LIB
 #endif
 
+/// what pair values & frozen map values get aligned to.
+union HarbolMapAlign {
+	intmax_t align_int;
+	floatmax_t align_float;
+	void *align_ptr;
+};
+
 
 HARBOL_EXPORT struct HarbolKeyVal *harbol_kvpair_new(const char cstr[restrict static 1], void *const restrict data, const size_t datasize)
 {
-	struct HarbolKeyVal *kv = harbol_alloc(1, sizeof *kv);
-	if( kv != NULL ) {
-		kv->data = harbol_alloc(datasize, sizeof *kv->data);
-		if( kv->data==NULL ) {
-			harbol_free(kv), kv=NULL;
-		} else {
-			kv->key = harbol_string_create(cstr);
-			if( kv->key.cstr==NULL )
-				harbol_free(kv), kv=NULL;
-			else memcpy(kv->data, data, datasize);
-		}
-	}
+	return harbol_kvpair_new_view(harbol_strview(cstr), data, datasize);
+}
+
+HARBOL_EXPORT struct HarbolKeyVal *harbol_kvpair_new_view(const struct HarbolStrView key, void *const restrict data, const size_t datasize)
+{
+	if( key.cstr==NULL || key.len > SIZE_MAX / 2 || datasize > SIZE_MAX / 4 )
+		return NULL;
+	
+	/// the value goes after the key's terminator, padded out so it's aligned for anything.
+	const size_t data_off = harbol_align_size(sizeof(struct HarbolKeyVal) + key.len + 1, sizeof(union HarbolMapAlign));
+	uint8_t *const block = harbol_alloc(data_off + datasize, sizeof *block);
+	if( block==NULL )
+		return NULL;
+	
+	struct HarbolKeyVal *const kv = ( struct HarbolKeyVal* )block;
+	kv->data = &block[data_off];
+	kv->hash = harbol_strview_hash(key);
+	kv->key_len = key.len;
+	memcpy(kv->key, key.cstr, key.len);
+	kv->key[key.len] = 0;
+	if( datasize != 0 )
+		memcpy(kv->data, data, datasize);
 	return kv;
 }
 
 HARBOL_EXPORT bool harbol_kvpair_free(struct HarbolKeyVal **const kvpairref, void dtor(void**))
 {
-	harbol_string_clear(&(*kvpairref)->key);
-	if( dtor != NULL )
-		dtor((void**)&(*kvpairref)->data);
-	if( (*kvpairref)->data != NULL )
-		harbol_free((*kvpairref)->data), (*kvpairref)->data = NULL;
+	if( dtor != NULL ) {
+		void *val = (*kvpairref)->data;
+		dtor(&val);
+	}
 	harbol_free(*kvpairref), *kvpairref=NULL;
 	return true;
 }
 
+extern struct HarbolStrView harbol_kvpair_key(const struct HarbolKeyVal *kv);
+
 
 HARBOL_EXPORT struct HarbolMap *harbol_map_new(const size_t datasize)
 {
@@ -48,18 +67,25 @@ HARBOL_EXPORT struct HarbolMap harbol_map_create(const size_t datasize)
 	return map;
 }
 
+/// frees the pairs in a slot table & the table itself.
+static void __harbol_map_free_slots(struct HarbolMapSlot **const slotsref, const size_t len, void dtor(void**))
+{
+	if( *slotsref==NULL )
+		return;
+	for( uindex_t i=0; i<len; i++ )
+		if( (*slotsref)[i].kv != NULL )
+			harbol_kvpair_free(&(*slotsref)[i].kv, dtor);
+	harbol_free(*slotsref), *slotsref=NULL;
+}
+
 HARBOL_EXPORT bool harbol_map_clear(struct HarbolMap *const map, void dtor(void**))
 {
-	if( map->buckets==NULL || map->datasize==0 )
+	if( map->slots==NULL || map->datasize==0 )
 		return false;
 	else {
-		for( uindex_t i=0; i<map->len; i++ ) {
-			struct HarbolVector *const bucket = &map->buckets[i];
-			for( uindex_t a=0; a<bucket->count; a++ )
-				harbol_kvpair_free(harbol_vector_get(bucket, a), dtor);
-			harbol_vector_clear(bucket, NULL);
-		}
-		harbol_free(map->buckets), map->buckets=NULL;
+		__harbol_map_free_slots(&map->slots, map->len, dtor);
+		__harbol_map_free_slots(&map->old_slots, map->old_len, dtor);
+		map->len = map->count = map->old_len = map->old_pos = 0;
 		return true;
 	}
 }
@@ -75,12 +101,147 @@ HARBOL_EXPORT bool harbol_map_free(struct HarbolMap **mapref, void dtor(void**))
 	}
 }
 
+/// how far `hash` sits from its home slot when stored at `index` in a table of `len` slots.
+static inline size_t __harbol_map_dist(const size_t len, const size_t hash, const size_t index)
+{
+	return (index - hash) & (len - 1);
+}
+
+/// the slot of `slots` holding `key`, NULL if that table doesn't have it.
+static struct HarbolMapSlot *__harbol_map_probe(struct HarbolMapSlot slots[const], const size_t len, const struct HarbolStrView key, const size_t hash)
+{
+	if( slots==NULL || key.cstr==NULL )
+		return NULL;
+	
+	const size_t mask = len - 1;
+	/// the table never fills up so every probe ends at an empty slot at worst.
+	for( size_t i = hash & mask, dist = 0;; i = (i + 1) & mask, dist++ ) {
+		struct HarbolMapSlot *const slot = &slots[i];
+		if( slot->kv==NULL || __harbol_map_dist(len, slot->hash, i) < dist )
+			return NULL;
+		else if( slot->hash==hash && harbol_strview_eq(harbol_kvpair_key(slot->kv), key) )
+			return slot;
+	}
+}
+
+/* runs in the old table are contiguous from their home slot & every slot before the move cursor is empty,
+ * so a key whose old home is behind the cursor can't be in the old table anymore.
+ */
+static inline NO_NULL bool __harbol_map_maybe_old(const struct HarbolMap *const map, const size_t hash)
+{
+	return map->old_slots != NULL && (hash & (map->old_len - 1)) >= map->old_pos;
+}
+
+/// the slot holding `key` in either table. `in_old` tells which table it came from.
+static NEVER_NULL(1) struct HarbolMapSlot *__harbol_map_lookup(const struct HarbolMap *const map, const struct HarbolStrView key, const size_t hash, bool *const in_old)
+{
+	/// most keys that could still be in the old table are, so it goes first.
+	struct HarbolMapSlot *slot = __harbol_map_maybe_old(map, hash) ? __harbol_map_probe(map->old_slots, map->old_len, key, hash) : NULL;
+	if( in_old != NULL )
+		*in_old = slot != NULL;
+	return( slot != NULL ) ? slot : __harbol_map_probe(map->slots, map->len, key, hash);
+}
+
+static inline NEVER_NULL(1) struct HarbolMapSlot *__harbol_map_find(const struct HarbolMap *const map, const struct HarbolStrView key, bool *const in_old)
+{
+	return( key.cstr==NULL || map->slots==NULL ) ? NULL : __harbol_map_lookup(map, key, harbol_strview_hash(key), in_old);
+}
+
+/// stores an entry that isn't in the table yet, the table must have a free slot.
+static void __harbol_map_place(struct HarbolMapSlot slots[const static 1], const size_t len, struct HarbolMapSlot entry)
+{
+	const size_t mask = len - 1;
+	for( size_t i = entry.hash & mask, dist = 0;; i = (i + 1) & mask, dist++ ) {
+		struct HarbolMapSlot *const slot = &slots[i];
+		if( slot->kv==NULL ) {
+			*slot = entry;
+			return;
+		}
+		
+		/// take the spot of an entry closer to its home and carry on placing that one instead.
+		const size_t slot_dist = __harbol_map_dist(len, slot->hash, i);
+		if( slot_dist < dist ) {
+			const struct HarbolMapSlot displaced = *slot;
+			*slot = entry;
+			entry = displaced;
+			dist = slot_dist;
+		}
+	}
+}
+
+/// empties a slot by shifting back the entries after it that aren't in their home slot.
+static void __harbol_map_remove_slot(struct HarbolMapSlot slots[const static 1], const size_t len, size_t index)
+{
+	const size_t mask = len - 1;
+	for( size_t next = (index + 1) & mask; slots[next].kv != NULL && __harbol_map_dist(len, slots[next].hash, next) > 0; next = (next + 1) & mask ) {
+		slots[index] = slots[next];
+		index = next;
+	}
+	slots[index].kv = NULL;
+	slots[index].hash = 0;
+}
+
+/// drops the pair in `slot` from whichever table it's in.
+static NEVER_NULL(1, 2) void __harbol_map_drop(struct HarbolMap *const map, struct HarbolMapSlot *const slot, const bool in_old, void dtor(void**))
+{
+	harbol_kvpair_free(&slot->kv, dtor);
+	if( in_old )
+		__harbol_map_remove_slot(map->old_slots, map->old_len, (uintptr_t)(slot - map->old_slots));
+	else __harbol_map_remove_slot(map->slots, map->len, (uintptr_t)(slot - map->slots));
+	map->count--;
+}
+
+/* moves up to `steps` slots' worth of the old table into the new one.
+ * the slot under the cursor is taken out with a backward shift so the rest of the old table stays probeable,
+ * which can pull the next entry of its run into the same slot, so the cursor only moves on once that slot is empty.
+ */
+static NO_NULL void __harbol_map_migrate(struct HarbolMap *const map, size_t steps)
+{
+	while( map->old_slots != NULL && steps-- > 0 ) {
+		struct HarbolMapSlot *const slot = &map->old_slots[map->old_pos];
+		if( slot->kv != NULL ) {
+			__harbol_map_place(map->slots, map->len, *slot);
+			__harbol_map_remove_slot(map->old_slots, map->old_len, map->old_pos);
+		} else if( ++map->old_pos==map->old_len ) {
+			harbol_free(map->old_slots), map->old_slots=NULL;
+			map->old_len = map->old_pos = 0;
+		}
+	}
+}
+
+/// makes room for one more entry, big tables start an incremental move instead of moving everything now.
+static NO_NULL bool __harbol_map_grow(struct HarbolMap *const map)
+{
+	/// a move still going when the new table fills up gets finished first, the tables only ever double.
+	__harbol_map_migrate(map, SIZE_MAX);
+	if( map->len < MAP_INCREMENTAL_MIN_SIZE )
+		return harbol_map_rehash(map, (map->len==0) ? MAP_DEFAULT_SIZE : map->len << 1);
+	else if( map->len > SIZE_MAX / (4 * sizeof *map->slots) )
+		return false;
+	
+	struct HarbolMapSlot *const new_slots = harbol_alloc(map->len << 1, sizeof *new_slots);
+	if( new_slots==NULL )
+		return false;
+	
+	map->old_slots = map->slots;
+	map->old_len = map->len;
+	map->old_pos = 0;
+	map->slots = new_slots;
+	map->len <<= 1;
+	return true;
+}
+
 HARBOL_EXPORT bool harbol_map_insert(struct HarbolMap *const restrict map, const char key[restrict static 1], void *restrict val)
 {
-	if( map->datasize==0 )
+	return harbol_map_insert_view(map, harbol_strview(key), val);
+}
+
+HARBOL_EXPORT bool harbol_map_insert_view(struct HarbolMap *const restrict map, const struct HarbolStrView key, void *restrict val)
+{
+	if( map->datasize==0 || key.cstr==NULL )
 		return false;
 	else {
-		struct HarbolKeyVal *kv = harbol_kvpair_new(key, val, map->datasize);
+		struct HarbolKeyVal *kv = harbol_kvpair_new_view(key, val, map->datasize);
 		if( kv==NULL ) {
 			return false;
 		} else {
@@ -96,17 +257,16 @@ HARBOL_EXPORT bool harbol_map_insert(struct HarbolMap *const restrict map, const
 
 HARBOL_EXPORT bool harbol_map_insert_kv(struct HarbolMap *const map, struct HarbolKeyVal *kv)
 {
-	if( harbol_map_has_key(map, kv->key.cstr) )
+	const struct HarbolStrView key = harbol_kvpair_key(kv);
+	const struct HarbolMapSlot entry = { kv->hash, kv };
+	if( __harbol_map_lookup(map, key, entry.hash, NULL) != NULL )
+		return false;
+	/// keeps the load under 3/4, counting the entries still waiting in the old table.
+	else if( (map->count + 1) * 4 > map->len * 3 && !__harbol_map_grow(map) )
 		return false;
 	else {
-		if( map->len==0 || map->count >= map->len )
-			harbol_map_rehash(map, (map->len==0) ? MAP_DEFAULT_SIZE : map->len << 1);
-		
-		const size_t hash = string_hash(kv->key.cstr) % map->len;
-		struct HarbolVector *bucket = &map->buckets[hash];
-		if( bucket->datasize==0 )
-			bucket->datasize = sizeof(struct HarbolKeyVal *);
-		harbol_vector_insert(bucket, &kv);
+		__harbol_map_migrate(map, MAP_MIGRATE_STEPS);
+		__harbol_map_place(map->slots, map->len, entry);
 		map->count++;
 		return true;
 	}
@@ -114,112 +274,445 @@ HARBOL_EXPORT bool harbol_map_insert_kv(struct HarbolMap *const map, struct Harb
 
 HARBOL_EXPORT void *harbol_map_get(const struct HarbolMap *const restrict map, const char key[restrict static 1])
 {
-	if( map->buckets==NULL || !harbol_map_has_key(map, key) )
-		return NULL;
-	else {
-		const size_t hash = string_hash(key) % map->len;
-		struct HarbolVector *const bucket = &map->buckets[hash];
-		for( uindex_t i=0; i<bucket->count; i++ ) {
-			struct HarbolKeyVal **const kv = harbol_vector_get(bucket, i);
-			if( !harbol_string_cmpcstr(&(*kv)->key, key) )
-				return (*kv)->data;
-		}
-		return NULL;
-	}
+	return harbol_map_get_view(map, harbol_strview(key));
+}
+
+HARBOL_EXPORT void *harbol_map_get_view(const struct HarbolMap *const map, const struct HarbolStrView key)
+{
+	const struct HarbolMapSlot *const slot = __harbol_map_find(map, key, NULL);
+	return( slot==NULL ) ? NULL : slot->kv->data;
 }
 
 HARBOL_EXPORT struct HarbolKeyVal *harbol_map_get_kv(const struct HarbolMap *const restrict map, const char key[restrict static 1])
 {
-	if( map->buckets==NULL )
-		return NULL;
-	else {
-		const size_t hash = string_hash(key) % map->len;
-		struct HarbolVector *const bucket = &map->buckets[hash];
-		for( uindex_t i=0; i<bucket->count; i++ ) {
-			struct HarbolKeyVal **kv = harbol_vector_get(bucket, i);
-			if( !harbol_string_cmpcstr(&(*kv)->key, key) )
-				return *kv;
-		}
-		return NULL;
-	}
+	return harbol_map_get_kv_view(map, harbol_strview(key));
+}
+
+HARBOL_EXPORT struct HarbolKeyVal *harbol_map_get_kv_view(const struct HarbolMap *const map, const struct HarbolStrView key)
+{
+	const struct HarbolMapSlot *const slot = __harbol_map_find(map, key, NULL);
+	return( slot==NULL ) ? NULL : slot->kv;
 }
 
 HARBOL_EXPORT bool harbol_map_set(struct HarbolMap *const restrict map, const char key[restrict static 1], void *const restrict val)
+{
+	return harbol_map_set_view(map, harbol_strview(key), val);
+}
+
+HARBOL_EXPORT bool harbol_map_set_view(struct HarbolMap *const restrict map, const struct HarbolStrView key, void *const restrict val)
 {
 	if( map->datasize==0 )
 		return false;
-	else if( map->buckets==NULL || !harbol_map_has_key(map, key) )
-		return harbol_map_insert(map, key, val);
+	
+	struct HarbolMapSlot *const slot = __harbol_map_find(map, key, NULL);
+	if( slot==NULL )
+		return harbol_map_insert_view(map, key, val);
 	else {
-		const size_t hash = string_hash(key) % map->len;
-		struct HarbolVector *const bucket = &map->buckets[hash];
-		for( uindex_t i=0; i<bucket->count; i++ ) {
-			struct HarbolKeyVal **const kv = harbol_vector_get(bucket, i);
-			if( !harbol_string_cmpcstr(&(*kv)->key, key) ) {
-				memcpy((*kv)->data, val, map->datasize);
-				return true;
-			}
-		}
-		return false;
+		memcpy(slot->kv->data, val, map->datasize);
+		return true;
 	}
 }
 
 HARBOL_EXPORT bool harbol_map_has_key(const struct HarbolMap *const restrict map, const char key[restrict static 1])
 {
-	if( map->buckets==NULL )
-		return false;
-	else {
-		const size_t hash = string_hash(key) % map->len;
-		struct HarbolVector *const bucket = &map->buckets[hash];
-		for( uindex_t i=0; i<bucket->count; i++ ) {
-			struct HarbolKeyVal **const kv = harbol_vector_get(bucket, i);
-			if( !harbol_string_cmpcstr(&(*kv)->key, key) )
-				return true;
-		}
+	return harbol_map_has_key_view(map, harbol_strview(key));
+}
+
+HARBOL_EXPORT bool harbol_map_has_key_view(const struct HarbolMap *const map, const struct HarbolStrView key)
+{
+	return __harbol_map_find(map, key, NULL) != NULL;
+}
+
+HARBOL_EXPORT bool harbol_map_rehash(struct HarbolMap *const map, const size_t new_len)
+{
+	/// rounds up to a power of 2 big enough to keep the load under 3/4.
+	size_t len = MAP_DEFAULT_SIZE;
+	while( len < new_len || len * 3 < map->count * 4 + 3 ) {
+		if( len > SIZE_MAX / (2 * sizeof *map->slots) )
+			return false;
+		len <<= 1;
+	}
+	
+	struct HarbolMapSlot *const new_slots = harbol_alloc(len, sizeof *new_slots);
+	if( new_slots==NULL )
 		return false;
+	
+	/// an explicit rehash moves everything at once, including whatever an incremental move left behind.
+	struct HarbolMapSlot *tables[] = { map->slots, map->old_slots };
+	const size_t lens[] = { map->len, map->old_len };
+	map->slots = new_slots;
+	map->len = len;
+	map->old_slots = NULL;
+	map->old_len = map->old_pos = 0;
+	/// the stored hashes mean no key gets rehashed or even looked at.
+	for( size_t t=0; t<sizeof tables / sizeof tables[0]; t++ ) {
+		for( uindex_t i=0; i<lens[t]; i++ )
+			if( tables[t][i].kv != NULL )
+				__harbol_map_place(map->slots, map->len, tables[t][i]);
+		if( tables[t] != NULL )
+			harbol_free(tables[t]), tables[t]=NULL;
 	}
+	return true;
 }
 
-HARBOL_EXPORT bool harbol_map_rehash(struct HarbolMap *const map, const size_t new_len)
+HARBOL_EXPORT bool harbol_map_del(struct HarbolMap *const restrict map, const char key[restrict static 1], void dtor(void**))
 {
-	const size_t old_len = map->len;
-	struct HarbolVector *curr = map->buckets;
-	map->buckets = harbol_alloc(new_len, sizeof *map->buckets);
-	if( map->buckets==NULL ) {
-		map->buckets = curr;
+	return harbol_map_del_view(map, harbol_strview(key), dtor);
+}
+
+HARBOL_EXPORT bool harbol_map_del_view(struct HarbolMap *const map, const struct HarbolStrView key, void dtor(void**))
+{
+	bool in_old = false;
+	struct HarbolMapSlot *const slot = __harbol_map_find(map, key, &in_old);
+	if( slot==NULL )
 		return false;
-	} else {
-		map->len = new_len;
-		map->count = 0;
-		if( curr != NULL ) {
-			for( uindex_t i=0; i<old_len; i++ ) {
-				struct HarbolVector *entry = &curr[i];
-				for( uindex_t a=0; a<entry->count; a++ )
-					harbol_map_insert_kv(map, *(struct HarbolKeyVal **)harbol_vector_get(entry, a));
-				harbol_free(entry->table), entry->table = NULL;
-			}
-			harbol_free(curr), curr=NULL;
-		}
+	else {
+		__harbol_map_drop(map, slot, in_old, dtor);
+		__harbol_map_migrate(map, MAP_MIGRATE_STEPS);
 		return true;
 	}
 }
 
-HARBOL_EXPORT bool harbol_map_del(struct HarbolMap *const restrict map, const char key[restrict static 1], void dtor(void**))
+HARBOL_EXPORT void *harbol_map_get_n(const struct HarbolMap *const restrict map, const char key[restrict static 1], const size_t len)
+{
+	return harbol_map_get_view(map, harbol_strview_n(key, len));
+}
+
+HARBOL_EXPORT struct HarbolKeyVal *harbol_map_get_kv_n(const struct HarbolMap *const restrict map, const char key[restrict static 1], const size_t len)
+{
+	return harbol_map_get_kv_view(map, harbol_strview_n(key, len));
+}
+
+HARBOL_EXPORT bool harbol_map_has_key_n(const struct HarbolMap *const restrict map, const char key[restrict static 1], const size_t len)
+{
+	return harbol_map_has_key_view(map, harbol_strview_n(key, len));
+}
+
+HARBOL_EXPORT void *harbol_map_get_hashed(const struct HarbolMap *const map, const struct HarbolStrView key, const size_t hash)
+{
+	const struct HarbolMapSlot *const slot = __harbol_map_lookup(map, key, hash, NULL);
+	return( slot==NULL ) ? NULL : slot->kv->data;
+}
+
+HARBOL_EXPORT struct HarbolKeyVal *harbol_map_get_kv_hashed(const struct HarbolMap *const map, const struct HarbolStrView key, const size_t hash)
+{
+	const struct HarbolMapSlot *const slot = __harbol_map_lookup(map, key, hash, NULL);
+	return( slot==NULL ) ? NULL : slot->kv;
+}
+
+/// finds the slot holding the pair `kv` itself in one table.
+static struct HarbolMapSlot *__harbol_map_probe_kv(struct HarbolMapSlot slots[const], const size_t len, const struct HarbolKeyVal *const kv)
 {
-	if( map->buckets==NULL || !harbol_map_has_key(map, key) )
+	if( slots==NULL )
+		return NULL;
+	
+	const size_t mask = len - 1;
+	for( size_t i = kv->hash & mask, dist = 0;; i = (i + 1) & mask, dist++ ) {
+		struct HarbolMapSlot *const slot = &slots[i];
+		if( slot->kv==NULL || __harbol_map_dist(len, slot->hash, i) < dist )
+			return NULL;
+		else if( slot->kv==kv )
+			return slot;
+	}
+}
+
+HARBOL_EXPORT bool harbol_map_del_kv(struct HarbolMap *const map, struct HarbolKeyVal *kv, void dtor(void**))
+{
+	struct HarbolMapSlot *slot = __harbol_map_maybe_old(map, kv->hash) ? __harbol_map_probe_kv(map->old_slots, map->old_len, kv) : NULL;
+	const bool in_old = slot != NULL;
+	if( !in_old )
+		slot = __harbol_map_probe_kv(map->slots, map->len, kv);
+	
+	if( slot==NULL )
 		return false;
 	else {
-		const size_t hash = string_hash(key) % map->len;
-		struct HarbolVector *const bucket = &map->buckets[hash];
-		for( uindex_t i=0; i<bucket->count; i++ ) {
-			struct HarbolKeyVal **const kv = harbol_vector_get(bucket, i);
-			if( !harbol_string_cmpcstr(&(*kv)->key, key) ) {
-				harbol_kvpair_free(kv, dtor);
-				harbol_vector_del(bucket, i, NULL);
-				map->count--;
-				return true;
+		__harbol_map_drop(map, slot, in_old, dtor);
+		__harbol_map_migrate(map, MAP_MIGRATE_STEPS);
+		return true;
+	}
+}
+
+
+/// top bit of a displacement word, the rest of the word is the slot itself.
+#define HARBOL_FROZEN_DIRECT       0x80000000u
+/// displacements tried for a bucket before starting over with another seed.
+#define HARBOL_FROZEN_MAX_DISP     (1u << 20)
+#define HARBOL_FROZEN_MAX_SEEDS    16
+/// average keys per bucket, more makes the displacement table smaller & the build slower.
+#define HARBOL_FROZEN_LOAD         4
+
+struct HarbolFrozenScratch {
+	uint64_t *hashes;
+	uint32_t
+		*bucket_start,   /// `bucket_count + 1` offsets into `members`.
+		*members,        /// key indices grouped by bucket.
+		*by_size,        /// buckets, biggest first.
+		*disps,
+		*slot_of         /// the slot each key ended up in.
+	;
+	bool *taken;
+	size_t bucket_count;
+};
+
+static inline size_t __harbol_frozen_bucket(const uint64_t hash, const size_t bucket_count)
+{
+	return ( size_t )(((hash >> 32) * bucket_count) >> 32);
+}
+
+static inline uint32_t __harbol_frozen_slot(const uint64_t hash, const uint32_t disp, const size_t count)
+{
+	return ( uint32_t )((( uint64_t )( uint32_t )harbol_mix64(hash ^ (disp * 0x9e3779b97f4a7c15ull)) * count) >> 32);
+}
+
+/// groups the keys by bucket & lists the buckets biggest first, with a counting sort for both.
+static NO_NULL bool __harbol_frozen_group(struct HarbolFrozenScratch *const s, const size_t count)
+{
+	const size_t bucket_count = s->bucket_count;
+	memset(s->bucket_start, 0, (bucket_count + 1) * sizeof *s->bucket_start);
+	for( size_t i=0; i<count; i++ )
+		s->bucket_start[__harbol_frozen_bucket(s->hashes[i], bucket_count) + 1]++;
+	
+	uint32_t max_size = 0;
+	for( size_t b=0; b<bucket_count; b++ ) {
+		if( s->bucket_start[b + 1] > max_size )
+			max_size = s->bucket_start[b + 1];
+		s->bucket_start[b + 1] += s->bucket_start[b];
+	}
+	
+	/// `by_size` doubles as the fill cursor of each bucket before it gets sorted.
+	memcpy(s->by_size, s->bucket_start, bucket_count * sizeof *s->by_size);
+	for( size_t i=0; i<count; i++ )
+		s->members[s->by_size[__harbol_frozen_bucket(s->hashes[i], bucket_count)]++] = ( uint32_t )i;
+	
+	uint32_t *sizes = harbol_alloc(max_size + 2, sizeof *sizes);
+	if( sizes==NULL )
+		return false;
+	for( size_t b=0; b<bucket_count; b++ )
+		sizes[max_size - (s->bucket_start[b + 1] - s->bucket_start[b]) + 1]++;
+	for( size_t n=1; n <= max_size + 1; n++ )
+		sizes[n] += sizes[n - 1];
+	for( size_t b=0; b<bucket_count; b++ )
+		s->by_size[sizes[max_size - (s->bucket_start[b + 1] - s->bucket_start[b])]++] = ( uint32_t )b;
+	harbol_free(sizes), sizes=NULL;
+	return true;
+}
+
+/// finds a slot for every key. 1 when it's done, 0 to try another seed, -1 if two keys are the same.
+static int __harbol_frozen_place(struct HarbolFrozenScratch *const s, const struct HarbolStrView keys[const], const size_t count)
+{
+	memset(s->taken, 0, count * sizeof *s->taken);
+	size_t next_free = 0;
+	for( size_t k=0; k<s->bucket_count; k++ ) {
+		const uint32_t b = s->by_size[k];
+		const uint32_t *const members = &s->members[s->bucket_start[b]];
+		const size_t size = s->bucket_start[b + 1] - s->bucket_start[b];
+		if( size==0 ) {
+			s->disps[b] = 0;
+		} else if( size==1 ) {
+			/// lone keys come last & just take whatever slot is left.
+			while( s->taken[next_free] )
+				next_free++;
+			s->taken[next_free] = true;
+			s->slot_of[members[0]] = ( uint32_t )next_free;
+			s->disps[b] = HARBOL_FROZEN_DIRECT | ( uint32_t )next_free;
+		} else {
+			/// keys with the same hash land on the same slot whatever the displacement.
+			for( size_t i=0; i<size; i++ ) {
+				for( size_t j=i + 1; j<size; j++ ) {
+					if( s->hashes[members[i]] != s->hashes[members[j]] )
+						continue;
+					return harbol_strview_eq(keys[members[i]], keys[members[j]]) ? -1 : 0;
+				}
+			}
+			
+			uint32_t disp = 0;
+			for( ;; disp++ ) {
+				if( disp==HARBOL_FROZEN_MAX_DISP )
+					return 0;
+				size_t placed = 0;
+				for( ; placed<size; placed++ ) {
+					const uint32_t slot = __harbol_frozen_slot(s->hashes[members[placed]], disp, count);
+					if( s->taken[slot] )
+						break;
+					s->taken[slot] = true;
+					s->slot_of[members[placed]] = slot;
+				}
+				if( placed==size )
+					break;
+				while( placed-- > 0 )
+					s->taken[s->slot_of[members[placed]]] = false;
 			}
+			s->disps[b] = disp;
+		}
+	}
+	return 1;
+}
+
+/// lays the map out in one block: header, displacements, entries, values, order & the key pool.
+static struct HarbolFrozenMap *__harbol_frozen_lay_out(const struct HarbolFrozenScratch *const s, const struct HarbolStrView keys[const], const void *const vals[const], const size_t count, const size_t datasize, const size_t pool_size, const uint64_t seed)
+{
+	const size_t
+		disps_off   = harbol_align_size(sizeof(struct HarbolFrozenMap), sizeof(uint64_t)),
+		entries_off = harbol_align_size(disps_off + s->bucket_count * sizeof(uint32_t), sizeof(uint64_t)),
+		values_off  = harbol_align_size(entries_off + count * sizeof(struct HarbolFrozenEntry), sizeof(union HarbolMapAlign)),
+		order_off   = harbol_align_size(values_off + count * datasize, sizeof(uint32_t)),
+		pool_off    = order_off + count * sizeof(uint32_t)
+	;
+	uint8_t *const block = harbol_alloc(pool_off + pool_size, sizeof *block);
+	if( block==NULL )
+		return NULL;
+	
+	uint32_t *const disps = ( uint32_t* )&block[disps_off];
+	struct HarbolFrozenEntry *const entries = ( struct HarbolFrozenEntry* )&block[entries_off];
+	uint8_t *const values = &block[values_off];
+	uint32_t *const order = ( uint32_t* )&block[order_off];
+	char *const pool = ( char* )&block[pool_off];
+	
+	memcpy(disps, s->disps, s->bucket_count * sizeof *disps);
+	uint32_t pool_len = 0;
+	for( size_t i=0; i<count; i++ ) {
+		const uint32_t slot = s->slot_of[i];
+		const struct HarbolStrView key = keys[i];
+		entries[slot] = (struct HarbolFrozenEntry){ s->hashes[i], pool_len, ( uint32_t )key.len };
+		memcpy(&pool[pool_len], key.cstr, key.len);
+		pool_len += ( uint32_t )key.len + 1;
+		memcpy(&values[slot * datasize], vals[i], datasize);
+		order[i] = slot;
+	}
+	
+	struct HarbolFrozenMap *const fmap = ( struct HarbolFrozenMap* )block;
+	*fmap = (struct HarbolFrozenMap){ seed, count, datasize, s->bucket_count, disps, entries, values, order, pool };
+	return fmap;
+}
+
+HARBOL_EXPORT struct HarbolFrozenMap *harbol_frozen_map_build(const struct HarbolStrView keys[restrict], const void *const vals[restrict], const size_t count, const size_t datasize)
+{
+	if( count >= HARBOL_FROZEN_DIRECT || (datasize != 0 && count > SIZE_MAX / 4 / datasize) )
+		return NULL;
+	
+	size_t pool_size = 0;
+	for( size_t i=0; i<count; i++ ) {
+		if( keys[i].cstr==NULL )
+			return NULL;
+		pool_size += keys[i].len + 1;
+	}
+	if( pool_size > UINT32_MAX )
+		return NULL;
+	
+	struct HarbolFrozenMap *fmap = NULL;
+	struct HarbolFrozenScratch s = { .bucket_count = count / HARBOL_FROZEN_LOAD + 1 };
+	s.hashes = harbol_alloc(count + 1, sizeof *s.hashes);
+	s.bucket_start = harbol_alloc(s.bucket_count + 1, sizeof *s.bucket_start);
+	s.members = harbol_alloc(count + 1, sizeof *s.members);
+	s.by_size = harbol_alloc(s.bucket_count, sizeof *s.by_size);
+	s.disps = harbol_alloc(s.bucket_count, sizeof *s.disps);
+	s.slot_of = harbol_alloc(count + 1, sizeof *s.slot_of);
+	s.taken = harbol_alloc(count + 1, sizeof *s.taken);
+	if( s.hashes==NULL || s.bucket_start==NULL || s.members==NULL || s.by_size==NULL || s.disps==NULL || s.slot_of==NULL || s.taken==NULL )
+		goto harbol_frozen_map_build_exit;
+	
+	for( uint64_t attempt=0; attempt<HARBOL_FROZEN_MAX_SEEDS; attempt++ ) {
+		const uint64_t seed = harbol_mix64(harbol_hash_seed() + attempt);
+		for( size_t i=0; i<count; i++ )
+			s.hashes[i] = harbol_wyhash(keys[i].cstr, keys[i].len, seed);
+		if( !__harbol_frozen_group(&s, count) )
+			break;
+		
+		const int placed = __harbol_frozen_place(&s, keys, count);
+		if( placed < 0 )
+			break;
+		else if( placed > 0 ) {
+			fmap = __harbol_frozen_lay_out(&s, keys, vals, count, datasize, pool_size, seed);
+			break;
 		}
+	}
+	
+harbol_frozen_map_build_exit:
+	harbol_free(s.hashes), s.hashes=NULL;
+	harbol_free(s.bucket_start), s.bucket_start=NULL;
+	harbol_free(s.members), s.members=NULL;
+	harbol_free(s.by_size), s.by_size=NULL;
+	harbol_free(s.disps), s.disps=NULL;
+	harbol_free(s.slot_of), s.slot_of=NULL;
+	harbol_free(s.taken), s.taken=NULL;
+	return fmap;
+}
+
+HARBOL_EXPORT struct HarbolFrozenMap *harbol_map_freeze(const struct HarbolMap *const map)
+{
+	struct HarbolStrView *keys = harbol_alloc(map->count + 1, sizeof *keys);
+	const void **vals = harbol_alloc(map->count + 1, sizeof *vals);
+	struct HarbolFrozenMap *fmap = NULL;
+	if( keys==NULL || vals==NULL )
+		goto harbol_map_freeze_exit;
+	
+	size_t n = 0;
+	const struct HarbolMapSlot *const tables[] = { map->slots, map->old_slots };
+	const size_t lens[] = { map->len, map->old_len };
+	for( size_t t=0; t<sizeof tables / sizeof tables[0]; t++ )
+		for( uindex_t i=0; i<lens[t]; i++ )
+			if( tables[t][i].kv != NULL ) {
+				keys[n] = harbol_kvpair_key(tables[t][i].kv);
+				vals[n++] = tables[t][i].kv->data;
+			}
+	
+	fmap = harbol_frozen_map_build(keys, vals, n, map->datasize);
+	
+harbol_map_freeze_exit:
+	harbol_free(keys), keys=NULL;
+	harbol_free(vals), vals=NULL;
+	return fmap;
+}
+
+HARBOL_EXPORT bool harbol_frozen_map_free(struct HarbolFrozenMap **const fmapref)
+{
+	if( *fmapref==NULL )
 		return false;
+	else {
+		harbol_free(*fmapref), *fmapref=NULL;
+		return true;
+	}
+}
+
+HARBOL_EXPORT const void *harbol_frozen_map_get(const struct HarbolFrozenMap *const restrict fmap, const char key[restrict static 1])
+{
+	return harbol_frozen_map_get_view(fmap, harbol_strview(key));
+}
+
+HARBOL_EXPORT const void *harbol_frozen_map_get_view(const struct HarbolFrozenMap *const fmap, const struct HarbolStrView key)
+{
+	if( fmap->count==0 || key.cstr==NULL )
+		return NULL;
+	
+	const uint64_t hash = harbol_wyhash(key.cstr, key.len, fmap->seed);
+	const uint32_t disp = fmap->disps[__harbol_frozen_bucket(hash, fmap->bucket_count)];
+	const uint32_t slot = ( disp & HARBOL_FROZEN_DIRECT ) ? disp & ~HARBOL_FROZEN_DIRECT : __harbol_frozen_slot(hash, disp, fmap->count);
+	const struct HarbolFrozenEntry *const entry = &fmap->entries[slot];
+	/// a key that isn't in the map still lands on some slot, so the key always gets checked.
+	return( entry->hash==hash && entry->key_len==key.len && !memcmp(&fmap->pool[entry->key_off], key.cstr, key.len) ) ? &fmap->values[slot * fmap->datasize] : NULL;
+}
+
+HARBOL_EXPORT const void *harbol_frozen_map_get_n(const struct HarbolFrozenMap *const restrict fmap, const char key[restrict static 1], const size_t len)
+{
+	return harbol_frozen_map_get_view(fmap, harbol_strview_n(key, len));
+}
+
+HARBOL_EXPORT bool harbol_frozen_map_has_key(const struct HarbolFrozenMap *const restrict fmap, const char key[restrict static 1])
+{
+	return harbol_frozen_map_get_view(fmap, harbol_strview(key)) != NULL;
+}
+
+HARBOL_EXPORT struct HarbolStrView harbol_frozen_map_key_at(const struct HarbolFrozenMap *const fmap, const size_t index)
+{
+	if( index >= fmap->count )
+		return (struct HarbolStrView)EMPTY_HARBOL_STRVIEW;
+	else {
+		const struct HarbolFrozenEntry *const entry = &fmap->entries[fmap->order[index]];
+		return harbol_strview_n(&fmap->pool[entry->key_off], entry->key_len);
 	}
 }
+
+HARBOL_EXPORT const void *harbol_frozen_map_val_at(const struct HarbolFrozenMap *const fmap, const size_t index)
+{
+	return( index >= fmap->count ) ? NULL : &fmap->values[fmap->order[index] * fmap->datasize];
+}
@@ -14,23 +14,60 @@ extern "C" {
 #	define MAP_DEFAULT_SIZE    8
 #endif
 
+/// tables with at least this many slots grow incrementally instead of moving every entry on one insert.
+#ifndef MAP_INCREMENTAL_MIN_SIZE
+#	define MAP_INCREMENTAL_MIN_SIZE    1024
+#endif
+
+/// old-table slots moved into the new table per insert or delete while an incremental grow is going.
+#ifndef MAP_MIGRATE_STEPS
+#	define MAP_MIGRATE_STEPS    4
+#endif
 
+
+/* a pair is one allocation: this header, the null terminated key right after it & then the value.
+ * `data` points at the value inside the same block so it can't be freed or swapped out on its own.
+ */
 struct HarbolKeyVal {
-	struct HarbolString key;
 	uint8_t *data;
+	size_t hash;      /// `harbol_strview_hash` of the key, computed once when the pair is made.
+	size_t key_len;
+	char key[];
 };
 
 HARBOL_EXPORT NO_NULL struct HarbolKeyVal *harbol_kvpair_new(const char cstr[], void *data, size_t datasize);
+HARBOL_EXPORT NEVER_NULL(2) struct HarbolKeyVal *harbol_kvpair_new_view(struct HarbolStrView key, void *data, size_t datasize);
+/// `dtor` gets a pointer to the value & must only release what the value owns.
 HARBOL_EXPORT NEVER_NULL(1) bool harbol_kvpair_free(struct HarbolKeyVal **kvpairref, void dtor(void**));
 
+inline NO_NULL struct HarbolStrView harbol_kvpair_key(const struct HarbolKeyVal *const kv)
+{
+	return harbol_strview_n(kv->key, kv->key_len);
+}
+
+
+/// an open-addressing slot, the key's hash is kept so probing & growing never rehash or touch the key.
+struct HarbolMapSlot {
+	size_t hash;
+	struct HarbolKeyVal *kv;   /// NULL when the slot is empty.
+};
 
+/* open addressing with robin hood probing: no entry sits farther from its home slot than the ones it passed,
+ * so a miss stops at the first entry closer to home than the probe and deleting shifts the run back instead of leaving tombstones.
+ * growing a big table keeps the old one around & moves a few of its slots per insert/delete, lookups check both until it's empty.
+ */
 struct HarbolMap {
-	// buckets is a vector of vectors of keyval pointers.
-	struct HarbolVector *buckets;
-	size_t len, count, datasize;
+	struct HarbolMapSlot *slots;
+	size_t
+		len,      /// slot count, always a power of 2.
+		count,    /// entries in both tables.
+		datasize
+	;
+	struct HarbolMapSlot *old_slots;   /// the table being moved out of, NULL when no grow is going.
+	size_t old_len, old_pos;           /// `old_pos` is the next old slot to move, every slot before it is empty.
 };
 
-#define EMPTY_HARBOL_MAP    {NULL,0,0,0}
+#define EMPTY_HARBOL_MAP    {NULL,0,0,0,NULL,0,0}
 
 HARBOL_EXPORT struct HarbolMap *harbol_map_new(size_t datasize);
 HARBOL_EXPORT struct HarbolMap harbol_map_create(size_t datasize);
@@ -45,8 +82,64 @@ HARBOL_EXPORT NO_NULL struct HarbolKeyVal *harbol_map_get_kv(const struct Harbol
 HARBOL_EXPORT NO_NULL bool harbol_map_set(struct HarbolMap *map, const char key[], void *val);
 
 HARBOL_EXPORT NO_NULL bool harbol_map_has_key(const struct HarbolMap *map, const char key[]);
+/// moves every entry at once, finishing any incremental grow that's still going.
 HARBOL_EXPORT NO_NULL bool harbol_map_rehash(struct HarbolMap *map, size_t new_len);
 HARBOL_EXPORT NEVER_NULL(1, 2) bool harbol_map_del(struct HarbolMap *map, const char key[], void dtor(void**));
+
+/// same as the above but keyed by a view, the key doesn't need to be null terminated.
+HARBOL_EXPORT NEVER_NULL(1, 3) bool harbol_map_insert_view(struct HarbolMap *map, struct HarbolStrView key, void *val);
+HARBOL_EXPORT NO_NULL void *harbol_map_get_view(const struct HarbolMap *map, struct HarbolStrView key);
+HARBOL_EXPORT NO_NULL struct HarbolKeyVal *harbol_map_get_kv_view(const struct HarbolMap *map, struct HarbolStrView key);
+HARBOL_EXPORT NEVER_NULL(1, 3) bool harbol_map_set_view(struct HarbolMap *map, struct HarbolStrView key, void *val);
+HARBOL_EXPORT NO_NULL bool harbol_map_has_key_view(const struct HarbolMap *map, struct HarbolStrView key);
+HARBOL_EXPORT NEVER_NULL(1) bool harbol_map_del_view(struct HarbolMap *map, struct HarbolStrView key, void dtor(void**));
+
+/// lookups by (pointer, length) so callers can probe straight from a source buffer without copying the key out.
+HARBOL_EXPORT NO_NULL void *harbol_map_get_n(const struct HarbolMap *map, const char key[], size_t len);
+HARBOL_EXPORT NO_NULL struct HarbolKeyVal *harbol_map_get_kv_n(const struct HarbolMap *map, const char key[], size_t len);
+HARBOL_EXPORT NO_NULL bool harbol_map_has_key_n(const struct HarbolMap *map, const char key[], size_t len);
+
+/// lookups with a hash the caller already has from `harbol_strview_hash`, for keys that get looked up over & over.
+HARBOL_EXPORT NO_NULL void *harbol_map_get_hashed(const struct HarbolMap *map, struct HarbolStrView key, size_t hash);
+HARBOL_EXPORT NO_NULL struct HarbolKeyVal *harbol_map_get_kv_hashed(const struct HarbolMap *map, struct HarbolStrView key, size_t hash);
+
+/// removes the pair `kv` itself, found by its cached hash so the key is never hashed or compared.
+HARBOL_EXPORT NEVER_NULL(1, 2) bool harbol_map_del_kv(struct HarbolMap *map, struct HarbolKeyVal *kv, void dtor(void**));
+
+
+struct HarbolFrozenEntry {
+	uint64_t hash;
+	uint32_t key_off, key_len;   /// the key sits null terminated in the map's string pool.
+};
+
+/* a read-only copy of a map in one allocation, keys in a string pool & values inline.
+ * a minimal perfect hash ("compress, hash & displace") gives every key its own slot, so a lookup is
+ * one hash, one displacement read & one key compare. nothing in it is written once it's built,
+ * so threads can share it without locks. values are copied bitwise, whatever they point to still belongs to the source map.
+ */
+struct HarbolFrozenMap {
+	uint64_t seed;
+	size_t count, datasize, bucket_count;
+	const uint32_t *disps;     /// per bucket: a displacement, or a slot when the top bit is set.
+	const struct HarbolFrozenEntry *entries;
+	const uint8_t *values;     /// `count` values, `datasize` bytes apart, in slot order.
+	const uint32_t *order;     /// the slot of each entry in the order they were given.
+	const char *pool;
+};
+
+/// builds a frozen map out of `count` keys & the values they map to, in that order. NULL if a key shows up twice or it runs out of memory.
+HARBOL_EXPORT struct HarbolFrozenMap *harbol_frozen_map_build(const struct HarbolStrView keys[], const void *const vals[], size_t count, size_t datasize);
+HARBOL_EXPORT NO_NULL struct HarbolFrozenMap *harbol_map_freeze(const struct HarbolMap *map);
+HARBOL_EXPORT NEVER_NULL(1) bool harbol_frozen_map_free(struct HarbolFrozenMap **fmapref);
+
+HARBOL_EXPORT NO_NULL const void *harbol_frozen_map_get(const struct HarbolFrozenMap *fmap, const char key[]);
+HARBOL_EXPORT NO_NULL const void *harbol_frozen_map_get_view(const struct HarbolFrozenMap *fmap, struct HarbolStrView key);
+HARBOL_EXPORT NO_NULL const void *harbol_frozen_map_get_n(const struct HarbolFrozenMap *fmap, const char key[], size_t len);
+HARBOL_EXPORT NO_NULL bool harbol_frozen_map_has_key(const struct HarbolFrozenMap *fmap, const char key[]);
+
+/// the `index`-th key & value in the order the map was built from.
+HARBOL_EXPORT NO_NULL struct HarbolStrView harbol_frozen_map_key_at(const struct HarbolFrozenMap *fmap, size_t index);
+HARBOL_EXPORT NO_NULL const void *harbol_frozen_map_val_at(const struct HarbolFrozenMap *fmap, size_t index);
 /********************************************************************/
 
 
@@ -0,0 +1,378 @@
+#include <stddef.h>
+#include "mempool.h"
+#ifdef OS_WINDOWS
+#	define HARBOL_LIB
+#endif
+
+/* the pool allocates from the system with plain malloc/free, never through harbol_alloc,
+ * since a HARBOL_USE_MEMPOOL build routes harbol_alloc back here.
+ */
+
+#if defined(COMPILER_GCC) || defined(COMPILER_CLANG)
+#	define HARBOL_MEMPOOL_THREAD_LOCAL    __thread
+#	define HARBOL_MEMPOOL_LOCK(p)         while( __atomic_test_and_set(( void* )&(p)->lock, __ATOMIC_ACQUIRE) )
+#	define HARBOL_MEMPOOL_UNLOCK(p)       __atomic_clear(( void* )&(p)->lock, __ATOMIC_RELEASE)
+#	define HARBOL_MEMPOOL_NEXT_EPOCH()    __atomic_add_fetch(&g_epochs, 1, __ATOMIC_RELAXED)
+#else
+/// no atomics or thread-locals to rely on, the pool is single-threaded only.
+#	define HARBOL_MEMPOOL_THREAD_LOCAL
+#	define HARBOL_MEMPOOL_LOCK(p)
+#	define HARBOL_MEMPOOL_UNLOCK(p)
+#	define HARBOL_MEMPOOL_NEXT_EPOCH()    (++g_epochs)
+#endif
+
+/// free blocks a thread caches per size class before giving half back to the pool.
+#define HARBOL_MEMPOOL_CACHE_MAX       64u
+/// blocks moved into a thread's cache per trip to the locked pool.
+#define HARBOL_MEMPOOL_CACHE_REFILL    16u
+#define HARBOL_MEMPOOL_LARGE_CLASS     UINT32_MAX
+
+
+union HarbolMemHeader {
+	struct {
+		size_t bytes;         /// requested size.
+		uint32_t size_class;
+	} info;
+	long double align_ld;
+	intmax_t align_int;
+	void *align_ptr;
+};
+
+struct HarbolMemNode {
+	struct HarbolMemNode *next;
+};
+
+struct HarbolMemSlab {
+	struct HarbolMemSlab *next;
+	size_t size, used;
+	union HarbolMemHeader align;   /// blocks start after this.
+};
+
+struct HarbolMemLarge {
+	struct HarbolMemLarge *prev, *next;
+	size_t size;
+	union HarbolMemHeader align;
+};
+
+struct HarbolMemCache {
+	const struct HarbolMemPool *pool;
+	uint64_t epoch;
+	struct HarbolMemNode *lists[HARBOL_MEMPOOL_CLASSES];
+	uint32_t counts[HARBOL_MEMPOOL_CLASSES];
+};
+
+
+static const uint32_t g_class_sizes[HARBOL_MEMPOOL_CLASSES] = {
+	16, 32, 48, 64, 80, 96, 112, 128, 144, 160, 176, 192, 208, 224, 240, 256,
+	384, 512, 768, 1024, 1536, 2048, 3072, 4096, 6144, HARBOL_MEMPOOL_MAX_CLASS_SIZE
+};
+
+static uint64_t g_epochs;
+static HARBOL_MEMPOOL_THREAD_LOCAL struct HarbolMemCache g_cache;
+static struct HarbolMemPool g_default_pool = { .slab_size = HARBOL_MEMPOOL_SLAB_SIZE };
+struct HarbolMemPool *g_pool = &g_default_pool;
+
+
+static inline uint32_t _size_class(const size_t bytes)
+{
+	if( bytes <= 256 )
+		return ( bytes==0 ) ? 0 : ( uint32_t )((bytes + 15) / 16 - 1);
+
+	uint32_t c = 16;
+	while( g_class_sizes[c] < bytes )
+		c++;
+	return c;
+}
+
+static inline size_t _block_size(const uint32_t size_class)
+{
+	return sizeof(union HarbolMemHeader) + g_class_sizes[size_class];
+}
+
+
+HARBOL_EXPORT struct HarbolMemPool harbol_mempool_create(const size_t slab_size)
+{
+	struct HarbolMemPool mempool = {
+		.slab_size = ( slab_size==0 ) ? HARBOL_MEMPOOL_SLAB_SIZE : slab_size,
+		.epoch = HARBOL_MEMPOOL_NEXT_EPOCH()
+	};
+	return mempool;
+}
+
+HARBOL_EXPORT struct HarbolMemPool *harbol_mempool_new(const size_t slab_size)
+{
+	struct HarbolMemPool *mempool = malloc(sizeof *mempool);
+	if( mempool != NULL )
+		*mempool = harbol_mempool_create(slab_size);
+	return mempool;
+}
+
+static NO_NULL void _free_large(struct HarbolMemPool *const mempool)
+{
+	for( struct HarbolMemLarge *large = mempool->large; large != NULL; ) {
+		struct HarbolMemLarge *const next = large->next;
+		mempool->held -= large->size;
+		free(large);
+		large = next;
+	}
+	mempool->large = NULL;
+}
+
+HARBOL_EXPORT void harbol_mempool_reset(struct HarbolMemPool *const mempool)
+{
+	HARBOL_MEMPOOL_LOCK(mempool);
+	_free_large(mempool);
+	for( struct HarbolMemSlab *slab = mempool->slabs; slab != NULL; slab = slab->next )
+		slab->used = offsetof(struct HarbolMemSlab, align);
+	mempool->curr_slab = mempool->slabs;
+	memset(mempool->free_lists, 0, sizeof mempool->free_lists);
+	mempool->epoch = HARBOL_MEMPOOL_NEXT_EPOCH();
+	HARBOL_MEMPOOL_UNLOCK(mempool);
+}
+
+HARBOL_EXPORT void harbol_mempool_clear(struct HarbolMemPool *const mempool)
+{
+	harbol_mempool_reset(mempool);
+	HARBOL_MEMPOOL_LOCK(mempool);
+	for( struct HarbolMemSlab *slab = mempool->slabs; slab != NULL; ) {
+		struct HarbolMemSlab *const next = slab->next;
+		mempool->held -= slab->size;
+		free(slab);
+		slab = next;
+	}
+	mempool->slabs = mempool->curr_slab = NULL;
+	HARBOL_MEMPOOL_UNLOCK(mempool);
+}
+
+HARBOL_EXPORT void harbol_mempool_free_pool(struct HarbolMemPool **const mempoolref)
+{
+	if( *mempoolref==NULL )
+		return;
+	harbol_mempool_clear(*mempoolref);
+	free(*mempoolref), *mempoolref=NULL;
+}
+
+/// bump allocates a block from the slabs, moving on to (or making) the next slab when the current one is full. Lock must be held.
+static NO_NULL union HarbolMemHeader *_carve(struct HarbolMemPool *const mempool, const size_t block_size)
+{
+	struct HarbolMemSlab *slab = mempool->curr_slab;
+	while( slab != NULL && slab->size - slab->used < block_size )
+		slab = slab->next;
+
+	if( slab==NULL ) {
+		const size_t want = sizeof *slab + block_size;
+		const size_t size = ( want > mempool->slab_size ) ? want : mempool->slab_size;
+		slab = malloc(size);
+		if( slab==NULL )
+			return NULL;
+		slab->size = size;
+		slab->used = offsetof(struct HarbolMemSlab, align);
+		mempool->held += size;
+		/// keep the list in carving order so a reset walks the slabs front to back again.
+		if( mempool->curr_slab==NULL ) {
+			slab->next = mempool->slabs;
+			mempool->slabs = slab;
+		} else {
+			slab->next = mempool->curr_slab->next;
+			mempool->curr_slab->next = slab;
+		}
+	}
+	mempool->curr_slab = slab;
+	union HarbolMemHeader *const header = ( union HarbolMemHeader* )(( uint8_t* )slab + slab->used);
+	slab->used += block_size;
+	return header;
+}
+
+/// the calling thread's cache if it belongs to `mempool`, binding it when it's empty or stale.
+static NO_NULL struct HarbolMemCache *_get_cache(const struct HarbolMemPool *const mempool)
+{
+	struct HarbolMemCache *const cache = &g_cache;
+	if( cache->pool==mempool && cache->epoch==mempool->epoch )
+		return cache;
+	else if( cache->pool != mempool ) {
+		/// blocks cached for another pool can't be handed back without touching that pool.
+		for( uint32_t i=0; i<HARBOL_MEMPOOL_CLASSES; i++ )
+			if( cache->counts[i] != 0 )
+				return NULL;
+	}
+	memset(cache, 0, sizeof *cache);
+	cache->pool = mempool;
+	cache->epoch = mempool->epoch;
+	return cache;
+}
+
+static NO_NULL void *_alloc_large(struct HarbolMemPool *const mempool, const size_t bytes)
+{
+	if( bytes > SIZE_MAX - sizeof(struct HarbolMemLarge) - sizeof(union HarbolMemHeader) )
+		return NULL;
+
+	const size_t size = sizeof(struct HarbolMemLarge) + sizeof(union HarbolMemHeader) + bytes;
+	struct HarbolMemLarge *const large = calloc(1, size);
+	if( large==NULL )
+		return NULL;
+	large->size = size;
+	union HarbolMemHeader *const header = ( union HarbolMemHeader* )(large + 1);
+	header->info.bytes = bytes;
+	header->info.size_class = HARBOL_MEMPOOL_LARGE_CLASS;
+
+	HARBOL_MEMPOOL_LOCK(mempool);
+	large->next = mempool->large;
+	if( mempool->large != NULL )
+		mempool->large->prev = large;
+	mempool->large = large;
+	mempool->held += size;
+	HARBOL_MEMPOOL_UNLOCK(mempool);
+	return header + 1;
+}
+
+HARBOL_EXPORT void *harbol_mempool_alloc(struct HarbolMemPool *const mempool, const size_t bytes)
+{
+	if( bytes > HARBOL_MEMPOOL_MAX_CLASS_SIZE )
+		return _alloc_large(mempool, bytes);
+
+	const uint32_t size_class = _size_class(bytes);
+	struct HarbolMemCache *const cache = _get_cache(mempool);
+	union HarbolMemHeader *header = NULL;
+	if( cache != NULL && cache->lists[size_class] != NULL ) {
+		struct HarbolMemNode *const node = cache->lists[size_class];
+		cache->lists[size_class] = node->next;
+		cache->counts[size_class]--;
+		header = ( union HarbolMemHeader* )node;
+	} else {
+		HARBOL_MEMPOOL_LOCK(mempool);
+		struct HarbolMemNode *node = mempool->free_lists[size_class];
+		if( node != NULL ) {
+			mempool->free_lists[size_class] = node->next;
+			/// take a few more along so the next allocations stay off the lock.
+			for( uint32_t i=0; cache != NULL && i<HARBOL_MEMPOOL_CACHE_REFILL && mempool->free_lists[size_class] != NULL; i++ ) {
+				struct HarbolMemNode *const extra = mempool->free_lists[size_class];
+				mempool->free_lists[size_class] = extra->next;
+				extra->next = cache->lists[size_class];
+				cache->lists[size_class] = extra;
+				cache->counts[size_class]++;
+			}
+			header = ( union HarbolMemHeader* )node;
+		} else {
+			header = _carve(mempool, _block_size(size_class));
+		}
+		HARBOL_MEMPOOL_UNLOCK(mempool);
+		if( header==NULL )
+			return NULL;
+	}
+	header->info.bytes = bytes;
+	header->info.size_class = size_class;
+	memset(header + 1, 0, bytes);
+	return header + 1;
+}
+
+HARBOL_EXPORT bool harbol_mempool_free(struct HarbolMemPool *const mempool, void *const ptr)
+{
+	if( ptr==NULL )
+		return false;
+
+	union HarbolMemHeader *const header = ( union HarbolMemHeader* )ptr - 1;
+	const uint32_t size_class = header->info.size_class;
+	if( size_class==HARBOL_MEMPOOL_LARGE_CLASS ) {
+		struct HarbolMemLarge *const large = ( struct HarbolMemLarge* )header - 1;
+		HARBOL_MEMPOOL_LOCK(mempool);
+		if( large->prev != NULL )
+			large->prev->next = large->next;
+		else mempool->large = large->next;
+		if( large->next != NULL )
+			large->next->prev = large->prev;
+		mempool->held -= large->size;
+		HARBOL_MEMPOOL_UNLOCK(mempool);
+		free(large);
+		return true;
+	} else if( size_class >= HARBOL_MEMPOOL_CLASSES ) {
+		return false;
+	}
+
+	struct HarbolMemNode *const node = ( struct HarbolMemNode* )header;
+	struct HarbolMemCache *const cache = _get_cache(mempool);
+	if( cache != NULL ) {
+		node->next = cache->lists[size_class];
+		cache->lists[size_class] = node;
+		if( ++cache->counts[size_class] <= HARBOL_MEMPOOL_CACHE_MAX )
+			return true;
+
+		/// cache is full, give half of it back to the pool.
+		HARBOL_MEMPOOL_LOCK(mempool);
+		while( cache->counts[size_class] > HARBOL_MEMPOOL_CACHE_MAX / 2 ) {
+			struct HarbolMemNode *const extra = cache->lists[size_class];
+			cache->lists[size_class] = extra->next;
+			cache->counts[size_class]--;
+			extra->next = mempool->free_lists[size_class];
+			mempool->free_lists[size_class] = extra;
+		}
+		HARBOL_MEMPOOL_UNLOCK(mempool);
+	} else {
+		HARBOL_MEMPOOL_LOCK(mempool);
+		node->next = mempool->free_lists[size_class];
+		mempool->free_lists[size_class] = node;
+		HARBOL_MEMPOOL_UNLOCK(mempool);
+	}
+	return true;
+}
+
+HARBOL_EXPORT void *harbol_mempool_realloc(struct HarbolMemPool *const mempool, void *const ptr, const size_t bytes)
+{
+	if( ptr==NULL )
+		return harbol_mempool_alloc(mempool, bytes);
+	else if( bytes==0 ) {
+		harbol_mempool_free(mempool, ptr);
+		return NULL;
+	}
+
+	union HarbolMemHeader *const header = ( union HarbolMemHeader* )ptr - 1;
+	const uint32_t size_class = header->info.size_class;
+	if( size_class==HARBOL_MEMPOOL_LARGE_CLASS && bytes > HARBOL_MEMPOOL_MAX_CLASS_SIZE ) {
+		/// large stays large, let the system allocator grow it in place when it can.
+		if( bytes > SIZE_MAX - sizeof(struct HarbolMemLarge) - sizeof(union HarbolMemHeader) )
+			return NULL;
+
+		const size_t size = sizeof(struct HarbolMemLarge) + sizeof(union HarbolMemHeader) + bytes;
+		HARBOL_MEMPOOL_LOCK(mempool);
+		struct HarbolMemLarge *const old = ( struct HarbolMemLarge* )header - 1;
+		const size_t old_size = old->size;
+		struct HarbolMemLarge *const large = realloc(old, size);
+		if( large==NULL ) {
+			HARBOL_MEMPOOL_UNLOCK(mempool);
+			return NULL;
+		}
+		large->size = size;
+		if( large->prev != NULL )
+			large->prev->next = large;
+		else mempool->large = large;
+		if( large->next != NULL )
+			large->next->prev = large;
+		mempool->held += size - old_size;
+		HARBOL_MEMPOOL_UNLOCK(mempool);
+
+		union HarbolMemHeader *const new_header = ( union HarbolMemHeader* )(large + 1);
+		new_header->info.bytes = bytes;
+		return new_header + 1;
+	} else if( size_class < HARBOL_MEMPOOL_CLASSES && bytes <= g_class_sizes[size_class] ) {
+		header->info.bytes = bytes;
+		return ptr;
+	}
+
+	void *const block = harbol_mempool_alloc(mempool, bytes);
+	if( block==NULL )
+		return NULL;
+	memcpy(block, ptr, ( header->info.bytes < bytes ) ? header->info.bytes : bytes);
+	harbol_mempool_free(mempool, ptr);
+	return block;
+}
+
+HARBOL_EXPORT bool harbol_mempool_cleanup(struct HarbolMemPool *const mempool, void **const ptrref)
+{
+	const bool result = harbol_mempool_free(mempool, *ptrref);
+	*ptrref = NULL;
+	return result;
+}
+
+HARBOL_EXPORT size_t harbol_mempool_mem_held(const struct HarbolMemPool *const mempool)
+{
+	return mempool->held;
+}
@@ -0,0 +1,65 @@
+#ifndef HARBOL_MEMPOOL_INCLUDED
+#	define HARBOL_MEMPOOL_INCLUDED
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "../harbol_common_defines.h"
+#include "../harbol_common_includes.h"
+
+
+#ifndef HARBOL_MEMPOOL_SLAB_SIZE
+#	define HARBOL_MEMPOOL_SLAB_SIZE     (64u * 1024u)
+#endif
+
+/// requests bigger than the largest size class go straight to malloc.
+#define HARBOL_MEMPOOL_MAX_CLASS_SIZE   8192u
+#define HARBOL_MEMPOOL_CLASSES          26u
+
+
+struct HarbolMemSlab;
+struct HarbolMemLarge;
+struct HarbolMemNode;
+
+/* size-class pool: blocks are carved from slabs, freed blocks go on a free list per size class.
+ * each thread keeps a small cache of free blocks for one pool so most alloc/free calls never take the lock.
+ */
+struct HarbolMemPool {
+	struct HarbolMemNode *free_lists[HARBOL_MEMPOOL_CLASSES];
+	struct HarbolMemSlab *slabs, *curr_slab;
+	struct HarbolMemLarge *large;
+	size_t slab_size, held;
+	uint64_t epoch;          /// bumped on every reset/clear, stale thread caches are dropped.
+	volatile bool lock;
+};
+
+/// the pool `harbol_alloc` & co. use in a HARBOL_USE_MEMPOOL build, points to a built-in pool by default.
+extern struct HarbolMemPool *g_pool;
+
+
+HARBOL_EXPORT struct HarbolMemPool harbol_mempool_create(size_t slab_size);
+HARBOL_EXPORT struct HarbolMemPool *harbol_mempool_new(size_t slab_size);
+
+/// returns all memory to the system.
+HARBOL_EXPORT NO_NULL void harbol_mempool_clear(struct HarbolMemPool *mempool);
+HARBOL_EXPORT NO_NULL void harbol_mempool_free_pool(struct HarbolMemPool **mempoolref);
+
+/// frees every block at once in O(slabs), keeping the slabs for reuse.
+HARBOL_EXPORT NO_NULL void harbol_mempool_reset(struct HarbolMemPool *mempool);
+
+/// memory is zeroed like calloc's.
+HARBOL_EXPORT NO_NULL void *harbol_mempool_alloc(struct HarbolMemPool *mempool, size_t bytes);
+HARBOL_EXPORT NEVER_NULL(1) void *harbol_mempool_realloc(struct HarbolMemPool *mempool, void *ptr, size_t bytes);
+HARBOL_EXPORT NEVER_NULL(1) bool harbol_mempool_free(struct HarbolMemPool *mempool, void *ptr);
+HARBOL_EXPORT NO_NULL bool harbol_mempool_cleanup(struct HarbolMemPool *mempool, void **ptrref);
+
+/// bytes held from the system, slabs & large blocks.
+HARBOL_EXPORT NO_NULL size_t harbol_mempool_mem_held(const struct HarbolMemPool *mempool);
+/********************************************************************/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HARBOL_MEMPOOL_INCLUDED */
@@ -1,3 +1,4 @@
+#define HARBOL_ALLOC_CATEGORY    HarbolAllocCategory_String
 #include "stringobj.h"
 
 #ifdef OS_WINDOWS
@@ -5,35 +6,75 @@
 #endif
 
 #include <ctype.h>
+#include <time.h>
+#ifdef OS_LINUX_UNIX
+#	include <unistd.h>
+#endif
+
+static inline NO_NULL bool __harbol_string_on_heap(const struct HarbolString *const string)
+{
+	return string->cap > HARBOL_STRING_SSO_CAP && string->cap != HARBOL_STRING_BORROWED;
+}
 
-static NO_NULL bool __harbol_resize_string(struct HarbolString *const string, const size_t new_size)
+/// makes room for `new_len` chars plus the null terminator.
+/// stays inline while it fits, otherwise grows a heap buffer geometrically. a borrowed string always gets copied.
+static NO_NULL bool __harbol_grow_string(struct HarbolString *const string, const size_t new_len)
 {
-	const size_t old_size = string->len;
-	// check if we're reducing or increasing memory.
-	// as realloc is exponentially faster when we're reducing memory.
-	const bool increasing_mem = (old_size <= new_size);
-	if( increasing_mem ) {
-		char *newstr = harbol_alloc(new_size + 1, sizeof *newstr);
+	if( __harbol_string_on_heap(string) && new_len <= string->cap )
+		return true;
+	else if( string->cap <= HARBOL_STRING_SSO_CAP && new_len <= HARBOL_STRING_SSO_CAP ) {
+		if( string->cap==0 ) {
+			string->data.buf[0] = 0;
+			string->len = 0;
+			string->cap = HARBOL_STRING_SSO_CAP;
+		}
+		return true;
+	} else if( new_len >= SIZE_MAX - 1 )
+		return false;
+	
+	const size_t cap = ( string->cap==HARBOL_STRING_BORROWED ) ? string->len : string->cap;
+	size_t new_cap = ( cap > SIZE_MAX / 2 ) ? new_len : cap * 2;
+	if( new_cap < new_len )
+		new_cap = new_len;
+	if( new_cap < HARBOL_STRING_MIN_CAP )
+		new_cap = HARBOL_STRING_MIN_CAP;
+	
+	if( __harbol_string_on_heap(string) ) {
+		char *const newstr = harbol_realloc(string->data.ptr, new_cap + 1);
 		if( newstr==NULL )
 			return false;
-		else {
-			string->len = new_size;
-			if( string->cstr != NULL ) {
-				memcpy(newstr, string->cstr, old_size);
-				harbol_free(string->cstr), string->cstr=NULL;
-			}
-			string->cstr = newstr;
-			return true;
-		}
+		string->data.ptr = newstr;
 	} else {
-		string->cstr = harbol_realloc(string->cstr, new_size * sizeof *string->cstr + 1);
-		if( string->cstr==NULL )
+		/// spilling out of the inline buffer or off borrowed memory.
+		char *const newstr = harbol_alloc(new_cap + 1, sizeof *newstr);
+		if( newstr==NULL )
 			return false;
-		else {
-			string->len = new_size;
-			string->cstr[string->len] = '\0';
-			return true;
-		}
+		else if( string->cap != 0 )
+			memcpy(newstr, harbol_string_cstr(string), string->len);
+		else string->len = 0;
+		newstr[string->len] = 0;
+		string->data.ptr = newstr;
+	}
+	string->cap = new_cap;
+	return true;
+}
+
+/// sets the length & null terminates, the buffer must have room already.
+static inline NO_NULL void __harbol_set_len(struct HarbolString *const string, const size_t len)
+{
+	string->len = len;
+	harbol_string_cstr(string)[len] = 0;
+}
+
+/// copying from inside the string itself only ever moves chars down & never needs the buffer to grow.
+static NO_NULL bool __harbol_copy_buf(struct HarbolString *const string, const char buf[static 1], const size_t len)
+{
+	if( !__harbol_grow_string(string, len) )
+		return false;
+	else {
+		memmove(harbol_string_cstr(string), buf, len);
+		__harbol_set_len(string, len);
+		return true;
 	}
 }
 
@@ -53,10 +94,21 @@ HARBOL_EXPORT struct HarbolString harbol_string_create(const char cstr[restrict]
 	return string;
 }
 
+HARBOL_EXPORT struct HarbolString harbol_string_borrow(char cstr[const], const size_t len)
+{
+	struct HarbolString string = EMPTY_HARBOL_STRING;
+	if( cstr != NULL ) {
+		string.data.ptr = cstr;
+		string.len = len;
+		string.cap = HARBOL_STRING_BORROWED;
+	}
+	return string;
+}
+
 HARBOL_EXPORT bool harbol_string_clear(struct HarbolString *const string)
 {
-	if( string->cstr != NULL )
-		harbol_free(string->cstr), string->cstr=NULL;
+	if( __harbol_string_on_heap(string) )
+		harbol_free(string->data.ptr), string->data.ptr=NULL;
 	*string = (struct HarbolString)EMPTY_HARBOL_STRING;
 	return true;
 }
@@ -74,87 +126,106 @@ HARBOL_EXPORT bool harbol_string_free(struct HarbolString **const stringref)
 
 HARBOL_EXPORT bool harbol_string_add_char(struct HarbolString *const string, const char c)
 {
-	const bool resize_res = __harbol_resize_string(string, string->len + 1);
-	if( !resize_res )
+	if( !__harbol_grow_string(string, string->len + 1) )
 		return false;
 	else {
-		string->cstr[string->len-1] = c;
+		harbol_string_cstr(string)[string->len] = c;
+		__harbol_set_len(string, string->len + 1);
 		return true;
 	}
 }
 
-HARBOL_EXPORT bool harbol_string_add_str(struct HarbolString *const stringA, const struct HarbolString *const stringB)
+HARBOL_EXPORT bool harbol_string_add_buf(struct HarbolString *const string, const char buf[], const size_t len)
 {
-	if( stringB->cstr==NULL )
+	if( buf==NULL )
+		return false;
+	else if( len > SIZE_MAX - 2 - string->len )
+		return false;
+	
+	/// `buf` may point into the string itself, which growing can move.
+	const char *const cstr = harbol_string_cstr(string);
+	const bool aliased = cstr != NULL && buf >= cstr && buf <= cstr + string->len;
+	const size_t offset = aliased ? (uintptr_t)(buf - cstr) : 0;
+	if( !__harbol_grow_string(string, string->len + len) )
 		return false;
 	else {
-		const bool resize_res = __harbol_resize_string(stringA, stringA->len + stringB->len);
-		if( !resize_res )
-			return false;
-		else {
-			strncat(stringA->cstr, stringB->cstr, stringB->len);
-			return true;
-		}
+		char *const dest = harbol_string_cstr(string);
+		memmove(&dest[string->len], aliased ? dest + offset : buf, len);
+		__harbol_set_len(string, string->len + len);
+		return true;
 	}
 }
 
+HARBOL_EXPORT bool harbol_string_add_str(struct HarbolString *const stringA, const struct HarbolString *const stringB)
+{
+	return harbol_string_add_buf(stringA, harbol_string_cstr(stringB), stringB->len);
+}
+
 HARBOL_EXPORT bool harbol_string_add_cstr(struct HarbolString *const restrict string, const char cstr[restrict])
 {
-	if( cstr==NULL )
+	return( cstr==NULL ) ? false : harbol_string_add_buf(string, cstr, strlen(cstr));
+}
+
+HARBOL_EXPORT bool harbol_string_reserve(struct HarbolString *const string, const size_t cap)
+{
+	if( cap <= harbol_string_cap(string) && string->cap != 0 )
+		return true;
+	else if( cap <= HARBOL_STRING_SSO_CAP || cap < string->len )
+		return __harbol_grow_string(string, cap < string->len ? string->len : cap);
+	else if( cap >= SIZE_MAX - 1 )
+		return false;
+	
+	const size_t len = string->len;
+	char *const newstr = __harbol_string_on_heap(string) ? harbol_realloc(string->data.ptr, cap + 1) : harbol_alloc(cap + 1, sizeof *newstr);
+	if( newstr==NULL )
 		return false;
 	else {
-		const size_t cstr_len = strlen(cstr);
-		const bool resize_res = __harbol_resize_string(string, string->len + cstr_len);
-		if( !resize_res )
-			return false;
-		else {
-			strncat(string->cstr, cstr, cstr_len);
-			return true;
-		}
+		if( !__harbol_string_on_heap(string) && string->cap != 0 )
+			memcpy(newstr, harbol_string_cstr(string), len);
+		string->data.ptr = newstr;
+		string->cap = cap;
+		__harbol_set_len(string, len);
+		return true;
 	}
 }
 
-HARBOL_EXPORT inline char *harbol_string_cstr(const struct HarbolString *const string)
+HARBOL_EXPORT void harbol_string_reset(struct HarbolString *const string)
 {
-	return string->cstr;
+	if( string->cap==HARBOL_STRING_BORROWED )
+		*string = (struct HarbolString)EMPTY_HARBOL_STRING;
+	else if( string->cap != 0 )
+		__harbol_set_len(string, 0);
 }
 
+extern char *harbol_string_cstr(const struct HarbolString *string);
+extern struct HarbolStrView harbol_strview(const char cstr[]);
+extern struct HarbolStrView harbol_strview_n(const char cstr[], size_t len);
+extern struct HarbolStrView harbol_string_view(const struct HarbolString *string);
+extern bool harbol_strview_eq(struct HarbolStrView a, struct HarbolStrView b);
+
 HARBOL_EXPORT inline size_t harbol_string_len(const struct HarbolString *const string)
 {
 	return string->len;
 }
 
+/// a borrowed string has no room of its own.
+HARBOL_EXPORT inline size_t harbol_string_cap(const struct HarbolString *const string)
+{
+	return( string->cap==HARBOL_STRING_BORROWED ) ? 0 : string->cap;
+}
+
 HARBOL_EXPORT bool harbol_string_copy_str(struct HarbolString *const stringA, const struct HarbolString *const stringB)
 {
-	if( stringB->cstr==NULL )
+	if( harbol_string_cstr(stringB)==NULL )
 		return false;
 	else if( stringA==stringB )
 		return true;
-	else {
-		const bool resize_res = __harbol_resize_string(stringA, stringB->len);
-		if( !resize_res )
-			return false;
-		else {
-			strncpy(stringA->cstr, stringB->cstr, stringB->len);
-			return true;
-		}
-	}
+	else return __harbol_copy_buf(stringA, harbol_string_cstr(stringB), stringB->len);
 }
 
 HARBOL_EXPORT bool harbol_string_copy_cstr(struct HarbolString *const restrict string, const char cstr[restrict])
 {
-	if( cstr==NULL )
-		return false;
-	else {
-		const size_t cstr_len = strlen(cstr);
-		const bool resize_res = __harbol_resize_string(string, cstr_len);
-		if( !resize_res )
-			return false;
-		else {
-			strncpy(string->cstr, cstr, string->len);
-			return true;
-		}
-	}
+	return( cstr==NULL ) ? false : __harbol_copy_buf(string, cstr, strlen(cstr));
 }
 
 HARBOL_EXPORT int32_t harbol_string_format(struct HarbolString *const restrict string, const char fmt[restrict static 1], ...)
@@ -170,14 +241,14 @@ HARBOL_EXPORT int32_t harbol_string_format(struct HarbolString *const restrict s
 	const int32_t size = vsnprintf(&c, 1, fmt, ap);
 	va_end(ap);
 	
-	const bool resize_res = __harbol_resize_string(string, size);
-	if( !resize_res ) {
+	if( size < 0 || !__harbol_grow_string(string, size) ) {
 		va_end(st);
 		return -1;
 	} else {
 		/* vsnprintf always checks n-1 so gotta increase len a bit to accomodate. */
-		const int32_t result = vsnprintf(string->cstr, string->len+1, fmt, st);
+		const int32_t result = vsnprintf(harbol_string_cstr(string), size+1, fmt, st);
 		va_end(st);
+		string->len = size;
 		return result;
 	}
 }
@@ -193,13 +264,13 @@ HARBOL_EXPORT int32_t harbol_string_add_format(struct HarbolString *const restri
 	va_end(ap);
 	
 	const size_t old_size = str->len;
-	const bool resize_res = __harbol_resize_string(str, size + old_size);
-	if( !resize_res ) {
+	if( size < 0 || !__harbol_grow_string(str, size + old_size) ) {
 		va_end(st);
 		return -1;
 	} else {
-		const int32_t result = vsnprintf(&str->cstr[old_size], str->len-old_size+1, fmt, st);
+		const int32_t result = vsnprintf(&harbol_string_cstr(str)[old_size], size+1, fmt, st);
 		va_end(st);
+		str->len = old_size + size;
 		return result;
 	}
 }
@@ -208,29 +279,97 @@ HARBOL_EXPORT int32_t harbol_string_scan(struct HarbolString *const restrict str
 {
 	va_list args;
 	va_start(args, fmt);
-	const int32_t result = vsscanf(string->cstr, fmt, args);
+	const int32_t result = vsscanf(harbol_string_cstr(string), fmt, args);
 	va_end(args);
 	return result;
 }
 
 HARBOL_EXPORT int32_t harbol_string_cmpcstr(const struct HarbolString *const restrict string, const char cstr[restrict])
 {
-	if( cstr==NULL || string->cstr==NULL )
+	if( cstr==NULL || harbol_string_cstr(string)==NULL )
 		return -1;
 	else {
 		const size_t cstr_len = strlen(cstr);
-		return strncmp(cstr, string->cstr, (string->len > cstr_len) ? string->len : cstr_len);
+		return strncmp(cstr, harbol_string_cstr(string), (string->len > cstr_len) ? string->len : cstr_len);
 	}
 }
 
 HARBOL_EXPORT int32_t harbol_string_cmpstr(const struct HarbolString *const restrict stringA, const struct HarbolString *const restrict stringB)
 {
-	return( stringA->cstr==NULL || stringB->cstr==NULL ) ? -1 : strncmp(stringA->cstr, stringB->cstr, stringA->len > stringB->len ? stringA->len : stringB->len);
+	return( harbol_string_cstr(stringA)==NULL || harbol_string_cstr(stringB)==NULL ) ? -1 : strncmp(harbol_string_cstr(stringA), harbol_string_cstr(stringB), stringA->len > stringB->len ? stringA->len : stringB->len);
+}
+
+HARBOL_EXPORT int32_t harbol_string_cmpview(const struct HarbolString *const string, const struct HarbolStrView view)
+{
+	const char *const cstr = harbol_string_cstr(string);
+	if( cstr==NULL || view.cstr==NULL )
+		return -1;
+	else {
+		const int32_t res = memcmp(cstr, view.cstr, ( string->len < view.len ) ? string->len : view.len);
+		if( res != 0 )
+			return res;
+		else return( string->len==view.len ) ? 0 : ( string->len < view.len ) ? -1 : 1;
+	}
+}
+
+#ifndef HARBOL_HASH_SEED
+/// 0 until the first hash picks a seed.
+static uint64_t g_hash_seed;
+
+static uint64_t __harbol_random_seed(void)
+{
+	uint64_t seed = 0;
+	FILE *restrict urandom = fopen("/dev/urandom", "rb");
+	if( urandom != NULL ) {
+		if( fread(&seed, sizeof seed, 1, urandom) != 1 )
+			seed = 0;
+		fclose(urandom);
+	}
+	if( seed==0 ) {
+		/// no urandom (Windows or a sandbox), the time & pid still differ between runs.
+		seed = ( uint64_t )time(NULL) ^ (( uint64_t )clock() << 32);
+#	ifdef OS_LINUX_UNIX
+		seed ^= ( uint64_t )getpid() << 16;
+#	endif
+		seed = harbol_mix64(seed);
+	}
+	return( seed==0 ) ? 1 : seed;
+}
+#endif
+
+HARBOL_EXPORT uint64_t harbol_hash_seed(void)
+{
+#ifdef HARBOL_HASH_SEED
+	return ( uint64_t )(HARBOL_HASH_SEED);
+#elif defined(COMPILER_GCC) || defined(COMPILER_CLANG)
+	uint64_t seed = __atomic_load_n(&g_hash_seed, __ATOMIC_ACQUIRE);
+	if( seed==0 ) {
+		/// threads racing the first hash all end up with whichever seed got published first.
+		const uint64_t fresh = __harbol_random_seed();
+		seed = __atomic_compare_exchange_n(&g_hash_seed, &seed, fresh, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE) ? fresh : seed;
+	}
+	return seed;
+#else
+	/// no atomics to rely on, the first hash has to happen before any other thread hashes.
+	if( g_hash_seed==0 )
+		g_hash_seed = __harbol_random_seed();
+	return g_hash_seed;
+#endif
+}
+
+HARBOL_EXPORT size_t harbol_strview_hash(const struct HarbolStrView view)
+{
+	return( view.cstr==NULL ) ? 0 : ( size_t )harbol_wyhash(view.cstr, view.len, harbol_hash_seed());
+}
+
+HARBOL_EXPORT size_t harbol_string_hash(const struct HarbolString *const string)
+{
+	return harbol_strview_hash(harbol_string_view(string));
 }
 
 HARBOL_EXPORT bool harbol_string_is_empty(const struct HarbolString *const string)
 {
-	return( string->cstr==NULL || string->len==0 || string->cstr[0]==0 );
+	return( harbol_string_cstr(string)==NULL || string->len==0 || harbol_string_cstr(string)[0]==0 );
 }
 
 HARBOL_EXPORT bool harbol_string_read_file(struct HarbolString *const string, FILE *const file)
@@ -239,11 +378,10 @@ HARBOL_EXPORT bool harbol_string_read_file(struct HarbolString *const string, FI
 	if( filesize<=0 )
 		return false;
 	else {
-		const bool resize_res = __harbol_resize_string(string, filesize);
-		if( !resize_res )
+		if( !__harbol_grow_string(string, filesize) )
 			return false;
 		else {
-			string->len = fread(string->cstr, sizeof *string->cstr, filesize, file);
+			__harbol_set_len(string, fread(harbol_string_cstr(string), sizeof(char), filesize, file));
 			return true;
 		}
 	}
@@ -251,10 +389,10 @@ HARBOL_EXPORT bool harbol_string_read_file(struct HarbolString *const string, FI
 
 HARBOL_EXPORT bool harbol_string_replace(struct HarbolString *const string, const char to_replace, const char with)
 {
-	if( string->cstr==NULL || to_replace==0 || with==0 )
+	if( harbol_string_cstr(string)==NULL || !__harbol_grow_string(string, string->len) || to_replace==0 || with==0 )
 		return false;
 	else {
-		for( char *i=string->cstr; *i; i++ )
+		for( char *i=harbol_string_cstr(string); *i; i++ )
 			if( *i==to_replace )
 				*i = with;
 		return true;
@@ -263,11 +401,11 @@ HARBOL_EXPORT bool harbol_string_replace(struct HarbolString *const string, cons
 
 HARBOL_EXPORT size_t harbol_string_count(const struct HarbolString *const string, const char occurrence)
 {
-	if( string->cstr==NULL )
+	if( harbol_string_cstr(string)==NULL )
 		return 0;
 	else {
 		size_t counts = 0;
-		for( char *i=string->cstr; *i; i++ )
+		for( char *i=harbol_string_cstr(string); *i; i++ )
 			if( *i==occurrence )
 				++counts;
 		return counts;
@@ -276,10 +414,10 @@ HARBOL_EXPORT size_t harbol_string_count(const struct HarbolString *const string
 
 HARBOL_EXPORT bool harbol_string_upper(struct HarbolString *const string)
 {
-	if( string->cstr==NULL )
+	if( harbol_string_cstr(string)==NULL || !__harbol_grow_string(string, string->len) )
 		return false;
 	else {
-		for( char *i=string->cstr; *i; i++ )
+		for( char *i=harbol_string_cstr(string); *i; i++ )
 			if( islower(*i) )
 				*i=toupper(*i);
 		return true;
@@ -288,10 +426,10 @@ HARBOL_EXPORT bool harbol_string_upper(struct HarbolString *const string)
 
 HARBOL_EXPORT bool harbol_string_lower(struct HarbolString *const string)
 {
-	if( string->cstr==NULL )
+	if( harbol_string_cstr(string)==NULL || !__harbol_grow_string(string, string->len) )
 		return false;
 	else {
-		for( char *i=string->cstr; *i; i++ )
+		for( char *i=harbol_string_cstr(string); *i; i++ )
 			if( isupper(*i) )
 				*i=tolower(*i);
 		return true;
@@ -300,10 +438,10 @@ HARBOL_EXPORT bool harbol_string_lower(struct HarbolString *const string)
 
 HARBOL_EXPORT bool harbol_string_reverse(struct HarbolString *const string)
 {
-	if( string->cstr==NULL )
+	if( harbol_string_cstr(string)==NULL || !__harbol_grow_string(string, string->len) )
 		return false;
 	else {
-		char *buf = string->cstr;
+		char *buf = harbol_string_cstr(string);
 		const size_t len = string->len / 2;
 		for( uindex_t i=0, n=string->len-1; i<len; i++, n-- ) {
 			if( buf[n]==buf[i] )
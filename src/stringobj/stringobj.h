@@ -8,26 +8,103 @@ extern "C" {
 #include "../harbol_common_defines.h"
 #include "../harbol_common_includes.h"
 
+#ifndef HARBOL_STRING_SSO_SIZE
+#	define HARBOL_STRING_SSO_SIZE    16
+#endif
+
+/// strings up to this many chars are kept inside the struct itself.
+#define HARBOL_STRING_SSO_CAP      (HARBOL_STRING_SSO_SIZE - 1)
+
+/// `cap` of a string that reads memory it doesn't own, see `harbol_string_borrow`.
+#define HARBOL_STRING_BORROWED     SIZE_MAX
+
+/* short strings live in `data.buf`, longer ones spill to a heap buffer at `data.ptr`.
+ * an inline string moves with the struct so always go through `harbol_string_cstr` for the chars.
+ */
 struct HarbolString {
-	char *cstr;
-	size_t len;
+	union {
+		char *ptr;
+		char  buf[HARBOL_STRING_SSO_SIZE];
+	} data;
+	size_t
+		len,
+		cap     /// 0 when nothing is stored, HARBOL_STRING_SSO_CAP when inline, else the heap buffer's size minus the null terminator.
+	;
 };
 
-#define EMPTY_HARBOL_STRING    { NULL,0 }
+#define EMPTY_HARBOL_STRING    { {NULL},0,0 }
+
+#ifndef HARBOL_STRING_MIN_CAP
+#	define HARBOL_STRING_MIN_CAP    (HARBOL_STRING_SSO_CAP * 2 + 1)
+#endif
+
+
+/// a borrowed run of chars that doesn't have to be null terminated, for lookups & compares without a temporary string.
+struct HarbolStrView {
+	const char *cstr;
+	size_t      len;
+};
+
+#define EMPTY_HARBOL_STRVIEW    { NULL,0 }
+
+
+/// the chars of the string, NULL if nothing was ever stored.
+inline NO_NULL char *harbol_string_cstr(const struct HarbolString *const str)
+{
+	if( str->cap > HARBOL_STRING_SSO_CAP )
+		return str->data.ptr;
+	else return( str->cap==0 ) ? NULL : ( char* )str->data.buf;
+}
+
+inline struct HarbolStrView harbol_strview(const char cstr[const])
+{
+	const struct HarbolStrView view = { cstr, ( cstr==NULL ) ? 0 : strlen(cstr) };
+	return view;
+}
+
+inline struct HarbolStrView harbol_strview_n(const char cstr[const], const size_t len)
+{
+	const struct HarbolStrView view = { cstr, len };
+	return view;
+}
+
+inline NO_NULL struct HarbolStrView harbol_string_view(const struct HarbolString *const str)
+{
+	const struct HarbolStrView view = { harbol_string_cstr(str), str->len };
+	return view;
+}
+
+/// length-first compare, true when both views hold the same chars.
+inline bool harbol_strview_eq(const struct HarbolStrView a, const struct HarbolStrView b)
+{
+	return a.len==b.len && a.cstr != NULL && b.cstr != NULL && !memcmp(a.cstr, b.cstr, a.len);
+}
 
 
 HARBOL_EXPORT struct HarbolString *harbol_string_new(const char cstr[]);
 HARBOL_EXPORT struct HarbolString harbol_string_create(const char cstr[]);
 
+/// wraps `len` chars at `cstr` without copying, the chars must outlive the string.
+/// the first write copies them into storage of the string's own.
+HARBOL_EXPORT struct HarbolString harbol_string_borrow(char cstr[], size_t len);
+
 HARBOL_EXPORT NO_NULL bool harbol_string_clear(struct HarbolString *str);
 HARBOL_EXPORT NO_NULL bool harbol_string_free(struct HarbolString **strref);
 
-HARBOL_EXPORT NO_NULL char *harbol_string_cstr(const struct HarbolString *str);
 HARBOL_EXPORT NO_NULL size_t harbol_string_len(const struct HarbolString *str);
+HARBOL_EXPORT NO_NULL size_t harbol_string_cap(const struct HarbolString *str);
+
+/// makes room for at least `cap` chars so appends up to that length don't reallocate.
+HARBOL_EXPORT NO_NULL bool harbol_string_reserve(struct HarbolString *str, size_t cap);
+
+/// empties the string but keeps its buffer for reuse.
+HARBOL_EXPORT NO_NULL void harbol_string_reset(struct HarbolString *str);
 
 HARBOL_EXPORT NO_NULL bool harbol_string_add_char(struct HarbolString *str, char chr);
 HARBOL_EXPORT NO_NULL bool harbol_string_add_str(struct HarbolString *strA, const struct HarbolString *strB) ;
 HARBOL_EXPORT NEVER_NULL(1) bool harbol_string_add_cstr(struct HarbolString *str, const char cstr[]);
+/// appends `len` bytes, embedded NULs included.
+HARBOL_EXPORT NEVER_NULL(1) bool harbol_string_add_buf(struct HarbolString *str, const char buf[], size_t len);
 
 #ifdef C11
 #	define harbol_string_add(str, val)  _Generic((val)+0, \
@@ -57,6 +134,13 @@ HARBOL_EXPORT NEVER_NULL(1, 2) int32_t harbol_string_scan(struct HarbolString *s
 
 HARBOL_EXPORT NEVER_NULL(1) int32_t harbol_string_cmpcstr(const struct HarbolString *str, const char cstr[]);
 HARBOL_EXPORT NO_NULL int32_t harbol_string_cmpstr(const struct HarbolString *strA, const struct HarbolString *strB);
+HARBOL_EXPORT NO_NULL int32_t harbol_string_cmpview(const struct HarbolString *str, struct HarbolStrView view);
+
+/// seed mixed into every string hash, read from /dev/urandom on first use (time & pid where there's none) and fixed for the rest of the process. build with `HARBOL_HASH_SEED` defined to pin it.
+HARBOL_EXPORT uint64_t harbol_hash_seed(void);
+/// seeded wyhash of the view's bytes, hash values aren't stable across runs so don't write them out.
+HARBOL_EXPORT size_t harbol_strview_hash(struct HarbolStrView view);
+HARBOL_EXPORT NO_NULL size_t harbol_string_hash(const struct HarbolString *str);
 
 #ifdef C11
 #	define harbol_string_cmp(str, val)  _Generic((val)+0, \
@@ -0,0 +1,363 @@
+#ifndef _POSIX_C_SOURCE
+#	define _POSIX_C_SOURCE 200809L
+#endif
+#define HARBOL_ALLOC_CATEGORY    HarbolAllocCategory_Token
+
+#include "targum_cache.h"
+
+#ifdef OS_WINDOWS
+#	define TARGUM_LIB
+#endif
+
+#if defined(OS_LINUX_UNIX) || defined(OS_MAC)
+#	define TARGUM_CACHE_POSIX
+#	include <sys/types.h>
+#	include <sys/stat.h>
+#	include <sys/mman.h>
+#	include <fcntl.h>
+#	include <unistd.h>
+#	include <dirent.h>
+#	include <time.h>
+#endif
+
+/* Token cache file layout:
+ * header, then `token_count` records, then a pool of NUL-terminated lexemes (in token order).
+ */
+struct TargumCacheHeader {
+	char magic[8];
+	uint32_t version, record_size;
+	uint64_t src_hash, cfg_hash;
+	uint64_t src_len, token_count, pool_size;
+	uint64_t final_line, final_line_start;
+};
+
+struct TargumCacheRecord {
+	uint64_t start, end, line, col;
+	uint32_t tag, lexeme_len;
+};
+
+static const char _g_cache_magic[8] = "TRGMTOK";
+
+/// stale temp files from crashed writers get removed after an hour.
+#define TARGUM_CACHE_STALE_TMP_SECS    3600
+
+
+static NO_NULL void _make_cache_path(struct HarbolString *const path, const char dir[static 1], const struct TargumCacheKey *const key, const char ext[static 1])
+{
+	harbol_string_format(path, "%s/%016" PRIx64 "%016" PRIx64 "%s", dir, key->src_hash, key->cfg_hash, ext);
+}
+
+TARGUM_API bool targum_cache_make_key(const struct TargumLexer *const lexer, struct TargumCacheKey *const key)
+{
+	if( harbol_string_cstr(&lexer->src)==NULL || !targum_tables_is_loaded(&lexer->tables) )
+		return false;
+	else {
+		/// the compiled tables capture everything in the config that affects lexing.
+		key->src_hash = bytes_hash64(harbol_string_cstr(&lexer->src), lexer->src.len, TARGUM_CACHE_VERSION);
+		key->cfg_hash = bytes_hash64(lexer->tables.blob, lexer->tables.size, TARGUM_CACHE_VERSION);
+		return true;
+	}
+}
+
+#ifdef TARGUM_CACHE_POSIX
+/// records don't keep the kind a token was counted as, so it's worked back out from the tag.
+static NO_NULL enum TargumStatKind _stat_kind(const struct TargumTables *const tables, const struct TargumTokenInfo *const tok)
+{
+	static const enum TargumStatKind tag_kinds[TargumTag_Count] = {
+		[TargumTag_Identifier] = TargumStat_Identifier,
+		[TargumTag_Integer]    = TargumStat_Integer,
+		[TargumTag_Float]      = TargumStat_Float,
+		[TargumTag_String]     = TargumStat_String,
+		[TargumTag_Rune]       = TargumStat_Rune,
+		[TargumTag_Comment]    = TargumStat_Comment,
+		[TargumTag_Error]      = TargumStat_Error,
+		[TargumTag_Space]      = TargumStat_Whitespace,
+		[TargumTag_Tab]        = TargumStat_Whitespace,
+		[TargumTag_Newline]    = TargumStat_Whitespace,
+	};
+	for( size_t i=0; i<TargumTag_Count; i++ )
+		if( tok->tag==targum_tables_tag(tables, i) )
+			return tag_kinds[i];
+	
+	uint32_t keyword_tag = 0;
+	const bool is_keyword = tok->lexeme.len > 0
+			&& targum_tables_keyword(tables, harbol_string_cstr(&tok->lexeme), tok->lexeme.len, &keyword_tag)
+			&& keyword_tag==tok->tag;
+	return is_keyword ? TargumStat_Keyword : TargumStat_Operator;
+}
+
+TARGUM_API bool targum_cache_load(struct TargumLexer *const lexer, const struct TargumCacheKey *const key)
+{
+	if( harbol_string_is_empty(&lexer->cache_dir) || lexer->tokens.count > 0 )
+		return false;
+
+	struct HarbolString path = EMPTY_HARBOL_STRING;
+	_make_cache_path(&path, harbol_string_cstr(&lexer->cache_dir), key, ".tok");
+	const int fd = open(harbol_string_cstr(&path), O_RDONLY);
+	if( fd < 0 ) {
+		harbol_string_clear(&path);
+		return false;
+	}
+
+	bool result = false;
+	struct stat st;
+	if( fstat(fd, &st) != 0 || ( size_t )st.st_size < sizeof(struct TargumCacheHeader) ) {
+		close(fd);
+		goto targum_cache_load_exit;
+	}
+	const size_t filesize = st.st_size;
+	const uint8_t *const stream = mmap(NULL, filesize, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if( stream==MAP_FAILED )
+		goto targum_cache_load_exit;
+
+	const struct TargumCacheHeader *const hdr = ( const struct TargumCacheHeader* )stream;
+	if( memcmp(hdr->magic, _g_cache_magic, sizeof hdr->magic) != 0
+			|| hdr->version != TARGUM_CACHE_VERSION
+			|| hdr->record_size != sizeof(struct TargumCacheRecord)
+			|| hdr->src_hash != key->src_hash || hdr->cfg_hash != key->cfg_hash
+			|| hdr->src_len != lexer->src.len
+			|| hdr->token_count > (filesize - sizeof *hdr) / sizeof(struct TargumCacheRecord)
+			|| sizeof *hdr + hdr->token_count * sizeof(struct TargumCacheRecord) + hdr->pool_size != filesize
+			|| hdr->final_line_start > hdr->src_len )
+	{
+		goto targum_cache_load_unmap;
+	}
+
+	const struct TargumCacheRecord *const records = ( const struct TargumCacheRecord* )(stream + sizeof *hdr);
+	const char *pool = ( const char* )(records + hdr->token_count);
+	const char *const pool_end = pool + hdr->pool_size;
+	/// counted on the side so a load that fails halfway doesn't leave half its tokens in the stats.
+	struct TargumLexerStats stats = {0};
+	/// the record count is known up front, so every token block is allocated before reading.
+	if( !harbol_seg_vector_reserve_TargumTokenInfo(&lexer->tokens, lexer->tokens.count + hdr->token_count) )
+		goto targum_cache_load_unmap;
+	for( uindex_t i=0; i<hdr->token_count; i++ ) {
+		const struct TargumCacheRecord *const rec = &records[i];
+		if( rec->end > hdr->src_len || pool + rec->lexeme_len >= pool_end ) {
+			targum_lexer_clear_tokens(lexer);
+			goto targum_cache_load_unmap;
+		}
+		struct TargumTokenInfo tok = {
+			.start = rec->start,
+			.end = rec->end,
+			.line = rec->line,
+			.col = rec->col,
+			.filename = &lexer->filename,
+			.tag = rec->tag
+		};
+		/// lexemes can have embedded NULs from escapes, so copy by length.
+		tok.lexeme = targum_lexer_store_lexeme(lexer, pool, rec->lexeme_len);
+		if( harbol_string_cstr(&tok.lexeme)==NULL ) {
+			targum_lexer_clear_tokens(lexer);
+			goto targum_cache_load_unmap;
+		}
+		harbol_seg_vector_push_TargumTokenInfo(&lexer->tokens, &tok);
+		/// the last record is the EOF token, which lexing doesn't count either.
+		if( i + 1 < hdr->token_count ) {
+			const enum TargumStatKind kind = _stat_kind(&lexer->tables, &tok);
+			stats.tokens[kind]++;
+			stats.bytes[kind] += tok.end - tok.start;
+		}
+		pool += rec->lexeme_len + 1;
+	}
+	for( size_t i=0; i<TargumStat_Count; i++ ) {
+		lexer->stats.tokens[i] += stats.tokens[i];
+		lexer->stats.bytes[i] += stats.bytes[i];
+	}
+	lexer->iter = harbol_string_cstr(&lexer->src) + lexer->src.len;
+	lexer->line = hdr->final_line;
+	lexer->line_start = harbol_string_cstr(&lexer->src) + hdr->final_line_start;
+	result = true;
+
+	/// bump the modification time so eviction treats this entry as recently used.
+	utimensat(AT_FDCWD, harbol_string_cstr(&path), NULL, 0);
+
+targum_cache_load_unmap:;
+	munmap(( void* )stream, filesize);
+targum_cache_load_exit:;
+	harbol_string_clear(&path);
+	return result;
+}
+
+static NO_NULL size_t _evict_cache(const char dir[restrict static 1], size_t max_bytes, size_t *restrict total_ref);
+
+/// bumped per store so threads of one process never share a temp file.
+static size_t g_cache_tmp_seq;
+
+TARGUM_API bool targum_cache_store(struct TargumLexer *const lexer, const struct TargumCacheKey *const key)
+{
+	if( harbol_string_is_empty(&lexer->cache_dir) || lexer->tokens.count==0 )
+		return false;
+
+	struct HarbolString path = EMPTY_HARBOL_STRING, tmp_path = EMPTY_HARBOL_STRING;
+	_make_cache_path(&path, harbol_string_cstr(&lexer->cache_dir), key, ".tok");
+	_make_cache_path(&tmp_path, harbol_string_cstr(&lexer->cache_dir), key, "");
+#if defined(COMPILER_GCC) || defined(COMPILER_CLANG)
+	const size_t seq = __atomic_fetch_add(&g_cache_tmp_seq, 1, __ATOMIC_RELAXED);
+#else
+	const size_t seq = g_cache_tmp_seq++;
+#endif
+	harbol_string_add_format(&tmp_path, ".%ld.%zu.tmp", ( long )getpid(), seq);
+
+	bool result = false;
+	/// O_EXCL so a leftover from a dead process with the same pid is never written through.
+	const int fd = open(harbol_string_cstr(&tmp_path), O_WRONLY | O_CREAT | O_EXCL, 0644);
+	if( fd < 0 )
+		goto targum_cache_store_exit;
+	FILE *restrict file = fdopen(fd, "wb");
+	if( file==NULL ) {
+		close(fd);
+		remove(harbol_string_cstr(&tmp_path));
+		goto targum_cache_store_exit;
+	}
+
+	struct TargumCacheHeader hdr = {
+		.version = TARGUM_CACHE_VERSION,
+		.record_size = sizeof(struct TargumCacheRecord),
+		.src_hash = key->src_hash,
+		.cfg_hash = key->cfg_hash,
+		.src_len = lexer->src.len,
+		.token_count = lexer->tokens.count,
+		.final_line = lexer->line,
+		.final_line_start = (uintptr_t)(lexer->line_start - harbol_string_cstr(&lexer->src))
+	};
+	memcpy(hdr.magic, _g_cache_magic, sizeof hdr.magic);
+	for( uindex_t i=0; i<lexer->tokens.count; i++ )
+		hdr.pool_size += harbol_seg_vector_get_TargumTokenInfo(&lexer->tokens, i)->lexeme.len + 1;
+
+	bool written = fwrite(&hdr, sizeof hdr, 1, file)==1;
+	for( uindex_t i=0; written && i<lexer->tokens.count; i++ ) {
+		const struct TargumTokenInfo *const iter = harbol_seg_vector_get_TargumTokenInfo(&lexer->tokens, i);
+		const struct TargumCacheRecord rec = {
+			.start = iter->start,
+			.end = iter->end,
+			.line = iter->line,
+			.col = iter->col,
+			.tag = iter->tag,
+			.lexeme_len = iter->lexeme.len
+		};
+		written = fwrite(&rec, sizeof rec, 1, file)==1;
+	}
+	for( uindex_t i=0; written && i<lexer->tokens.count; i++ ) {
+		const struct TargumTokenInfo *const iter = harbol_seg_vector_get_TargumTokenInfo(&lexer->tokens, i);
+		if( iter->lexeme.len > 0 )
+			written = fwrite(harbol_string_cstr(&iter->lexeme), iter->lexeme.len, 1, file)==1;
+		written = written && fputc(0, file) != EOF;
+	}
+	written = (fclose(file)==0) && written, file = NULL;
+
+	/// rename is atomic, so concurrent readers either see the whole entry or none of it.
+	if( !written || rename(harbol_string_cstr(&tmp_path), harbol_string_cstr(&path)) != 0 ) {
+		remove(harbol_string_cstr(&tmp_path));
+		goto targum_cache_store_exit;
+	}
+	result = true;
+	/// the directory is only scanned once our running total of it goes over the limit.
+	/// overwritten entries & other writers make the total drift, a scan sets it straight again.
+	const size_t entry_size = sizeof hdr + hdr.token_count * sizeof(struct TargumCacheRecord) + hdr.pool_size;
+	if( lexer->cache_size==SIZE_MAX || (lexer->cache_size += entry_size) > lexer->cache_limit )
+		_evict_cache(harbol_string_cstr(&lexer->cache_dir), lexer->cache_limit, &lexer->cache_size);
+
+targum_cache_store_exit:;
+	harbol_string_clear(&path);
+	harbol_string_clear(&tmp_path);
+	return result;
+}
+
+struct TargumCacheEntry {
+	struct HarbolString path;
+	size_t size;
+	time_t mtime;
+};
+
+static int _cmp_cache_entry_age(const void *const a, const void *const b)
+{
+	const struct TargumCacheEntry *const x = a, *const y = b;
+	return( x->mtime > y->mtime ) - ( x->mtime < y->mtime );
+}
+
+static void _clear_cache_entry(void **const p)
+{
+	struct TargumCacheEntry *const entry = *p;
+	harbol_string_clear(&entry->path);
+}
+
+/// `total_ref` gets the bytes left in the directory afterwards.
+static NO_NULL size_t _evict_cache(const char dir[restrict static 1], const size_t max_bytes, size_t *const restrict total_ref)
+{
+	DIR *const d = opendir(dir);
+	if( d==NULL ) {
+		*total_ref = 0;
+		return 0;
+	}
+
+	struct HarbolVector entries = harbol_vector_create(sizeof(struct TargumCacheEntry), 0);
+	size_t total = 0, evicted = 0;
+	const time_t now = time(NULL);
+	for( const struct dirent *ent = readdir(d); ent != NULL; ent = readdir(d) ) {
+		const size_t namelen = strlen(ent->d_name);
+		const bool is_entry = namelen > 4 && !strcmp(&ent->d_name[namelen - 4], ".tok");
+		const bool is_tmp = namelen > 4 && !strcmp(&ent->d_name[namelen - 4], ".tmp");
+		if( !is_entry && !is_tmp )
+			continue;
+
+		struct TargumCacheEntry entry = { EMPTY_HARBOL_STRING, 0, 0 };
+		harbol_string_format(&entry.path, "%s/%s", dir, ent->d_name);
+		struct stat st;
+		if( stat(harbol_string_cstr(&entry.path), &st) != 0 ) {
+			harbol_string_clear(&entry.path);
+			continue;
+		} else if( is_tmp ) {
+			if( now - st.st_mtime > TARGUM_CACHE_STALE_TMP_SECS )
+				remove(harbol_string_cstr(&entry.path));
+			harbol_string_clear(&entry.path);
+			continue;
+		}
+		entry.size = st.st_size;
+		entry.mtime = st.st_mtime;
+		total += entry.size;
+		harbol_vector_insert(&entries, &entry);
+	}
+	closedir(d);
+
+	if( total > max_bytes ) {
+		/// least recently used first.
+		qsort(entries.table, entries.count, entries.datasize, _cmp_cache_entry_age);
+		const struct TargumCacheEntry *const end = harbol_vector_get_iter_end_count(&entries);
+		for( const struct TargumCacheEntry *iter = harbol_vector_get_iter(&entries); iter != NULL && iter<end && total > max_bytes; iter++ ) {
+			if( remove(harbol_string_cstr(&iter->path))==0 ) {
+				total -= iter->size;
+				evicted++;
+			}
+		}
+	}
+	harbol_vector_clear(&entries, _clear_cache_entry);
+	*total_ref = total;
+	return evicted;
+}
+
+TARGUM_API size_t targum_cache_evict(const char dir[restrict static 1], const size_t max_bytes)
+{
+	size_t total = 0;
+	return _evict_cache(dir, max_bytes, &total);
+}
+#else
+TARGUM_API bool targum_cache_load(struct TargumLexer *const lexer, const struct TargumCacheKey *const key)
+{
+	(void)lexer; (void)key;
+	return false;
+}
+
+TARGUM_API bool targum_cache_store(struct TargumLexer *const lexer, const struct TargumCacheKey *const key)
+{
+	(void)lexer; (void)key;
+	return false;
+}
+
+TARGUM_API size_t targum_cache_evict(const char dir[restrict static 1], const size_t max_bytes)
+{
+	(void)dir; (void)max_bytes;
+	return 0;
+}
+#endif
@@ -0,0 +1,32 @@
+#ifndef TARGUM_CACHE_INCLUDED
+#	define TARGUM_CACHE_INCLUDED
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "targum_lexer.h"
+
+#define TARGUM_CACHE_VERSION    2
+
+/// default size limit of a cache directory: 256 MiB.
+#ifndef TARGUM_CACHE_DEFAULT_LIMIT
+#	define TARGUM_CACHE_DEFAULT_LIMIT    (256u * 1024u * 1024u)
+#endif
+
+struct TargumCacheKey {
+	uint64_t src_hash, cfg_hash;
+};
+
+
+TARGUM_API NO_NULL bool targum_cache_make_key(const struct TargumLexer *lexer, struct TargumCacheKey *key);
+TARGUM_API NO_NULL bool targum_cache_load(struct TargumLexer *lexer, const struct TargumCacheKey *key);
+TARGUM_API NO_NULL bool targum_cache_store(struct TargumLexer *lexer, const struct TargumCacheKey *key);
+TARGUM_API NO_NULL size_t targum_cache_evict(const char dir[], size_t max_bytes);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /** TARGUM_CACHE_INCLUDED */
@@ -0,0 +1,439 @@
+#include "targum_lexer.h"
+
+/* targum_corpus - writes a seeded, token-valid synthetic source for a config.
+ * Output is streamed in fixed-size chunks, so the size is only limited by the disk.
+ * The same config, seed, size and mix always produce the same bytes.
+ */
+
+#define CORPUS_CHUNK_SIZE    (64u * 1024u)
+
+enum CorpusKind {
+	CorpusKind_Identifier,
+	CorpusKind_Keyword,
+	CorpusKind_Operator,
+	CorpusKind_Number,
+	CorpusKind_String,
+	CorpusKind_Rune,
+	CorpusKind_Comment,
+	CorpusKind_Newline,
+	CorpusKind_Tab,
+	CorpusKind_Count
+};
+
+static const char *const g_kind_names[CorpusKind_Count] = {
+	"ident", "keyword", "operator", "number", "string", "rune", "comment", "newline", "tab"
+};
+
+/// default weights, `newline` & `tab` are how often a separator is a newline or tab instead of a space.
+static const uint32_t g_default_mix[CorpusKind_Count] = { 30, 12, 30, 10, 6, 2, 4, 10, 3 };
+
+struct CorpusWriter {
+	FILE *out;
+	size_t len;
+	uint64_t written;
+	char buf[CORPUS_CHUNK_SIZE];
+};
+
+struct CorpusGen {
+	struct HarbolVector keywords, operators;  /// of `struct HarbolString`
+	const struct TargumTables *tables;
+	uint64_t state;
+	uint32_t mix[CorpusKind_Count], token_total;
+	bool golang;
+};
+
+
+static uint64_t _next(uint64_t *const state)
+{
+	/// splitmix64.
+	uint64_t z = (*state += 0x9e3779b97f4a7c15ull);
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+	return z ^ (z >> 31);
+}
+
+static uint32_t _below(struct CorpusGen *const gen, const uint32_t n)
+{
+	return ( n==0 ) ? 0 : ( uint32_t )(_next(&gen->state) % n);
+}
+
+static NO_NULL bool _flush(struct CorpusWriter *const w)
+{
+	if( w->len > 0 && fwrite(w->buf, 1, w->len, w->out) != w->len )
+		return false;
+	w->written += w->len;
+	w->len = 0;
+	return true;
+}
+
+static NO_NULL bool _put(struct CorpusWriter *const w, const char str[static 1], const size_t len)
+{
+	for( size_t i=0; i<len; ) {
+		if( w->len==CORPUS_CHUNK_SIZE && !_flush(w) )
+			return false;
+		const size_t room = CORPUS_CHUNK_SIZE - w->len;
+		const size_t n = ( len - i < room ) ? len - i : room;
+		memcpy(&w->buf[w->len], &str[i], n);
+		w->len += n, i += n;
+	}
+	return true;
+}
+
+static NO_NULL bool _putc(struct CorpusWriter *const w, const char c)
+{
+	if( w->len==CORPUS_CHUNK_SIZE && !_flush(w) )
+		return false;
+	w->buf[w->len++] = c;
+	return true;
+}
+
+static NO_NULL bool _puts(struct CorpusWriter *const w, const char str[static 1])
+{
+	return _put(w, str, strlen(str));
+}
+
+static inline uint64_t _total(const struct CorpusWriter *const w)
+{
+	return w->written + w->len;
+}
+
+
+/// walks the operator trie, collecting every operator spelling.
+static NO_NULL void _collect_operators(struct CorpusGen *const gen, const uint32_t node, struct HarbolString *const path)
+{
+	const struct TargumOperatorNode *const nodes = gen->tables->operators;
+	for( uint32_t child = nodes[node].first_child; child != 0; child = nodes[child].next_sibling ) {
+		harbol_string_add_char(path, nodes[child].chr);
+		if( nodes[child].terminal ) {
+			struct HarbolString op = harbol_string_create(harbol_string_cstr(path));
+			harbol_vector_insert(&gen->operators, &op);
+		}
+		_collect_operators(gen, child, path);
+		harbol_string_cstr(path)[--path->len] = 0;
+	}
+}
+
+static NO_NULL void _clear_strings(struct HarbolVector *const vec)
+{
+	for( size_t i=0; i<vec->count; i++ )
+		harbol_string_clear(harbol_vector_get(vec, i));
+	harbol_vector_clear(vec, NULL);
+}
+
+static NO_NULL bool _write_identifier(struct CorpusGen *const gen, struct CorpusWriter *const w)
+{
+	static const char first[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ_";
+	static const char rest[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ_0123456789";
+	const uint32_t len = 1 + _below(gen, 4) + _below(gen, 12);
+	bool ok = _putc(w, first[_below(gen, sizeof first - 1)]);
+	for( uint32_t i=1; ok && i<len; i++ )
+		ok = _putc(w, rest[_below(gen, sizeof rest - 1)]);
+	return ok;
+}
+
+/// `separators` allows Go digit separators, `lex_go_style_number` only takes them in decimal & hex digits.
+static NO_NULL bool _write_digits(struct CorpusGen *const gen, struct CorpusWriter *const w, const char digits[static 1], const uint32_t base, const uint32_t count, const bool separators)
+{
+	bool ok = true;
+	for( uint32_t i=0; ok && i<count; i++ ) {
+		if( separators && gen->golang && i > 0 && i + 1 < count && _below(gen, 6)==0 )
+			ok = _putc(w, '_');
+		ok = ok && _putc(w, digits[_below(gen, base)]);
+	}
+	return ok;
+}
+
+static NO_NULL bool _write_number(struct CorpusGen *const gen, struct CorpusWriter *const w)
+{
+	static const char *const c_suffixes[] = { "u", "l", "ul", "ll", "ull", "U", "L" };
+	bool ok = true;
+	switch( _below(gen, gen->golang ? 6 : 5) ) {
+		case 0: /// decimal
+			ok = _putc(w, "123456789"[_below(gen, 9)]) && _write_digits(gen, w, "0123456789", 10, _below(gen, 9), true);
+			if( !gen->golang && _below(gen, 4)==0 )
+				ok = ok && _puts(w, c_suffixes[_below(gen, 7)]);
+			break;
+		case 1: /// hex
+			ok = _puts(w, _below(gen, 2) ? "0x" : "0X") && _write_digits(gen, w, "0123456789abcdefABCDEF", 22, 1 + _below(gen, 8), true);
+			break;
+		case 2: /// octal
+			ok = _puts(w, gen->golang ? "0o" : "0") && _write_digits(gen, w, "01234567", 8, 1 + _below(gen, 6), false);
+			break;
+		case 3: /// float
+			ok = _putc(w, "123456789"[_below(gen, 9)]) && _write_digits(gen, w, "0123456789", 10, _below(gen, 5), true) && _putc(w, '.') && _write_digits(gen, w, "0123456789", 10, 1 + _below(gen, 6), true);
+			if( _below(gen, 3)==0 ) {
+				ok = ok && _putc(w, 'e');
+				if( _below(gen, 2) )
+					ok = ok && _putc(w, '-');
+				ok = ok && _write_digits(gen, w, "0123456789", 10, 1 + _below(gen, 2), true);
+			}
+			if( !gen->golang && _below(gen, 4)==0 )
+				ok = ok && _putc(w, 'f');
+			break;
+		case 4: /// leading-dot float
+			ok = _putc(w, '.') && _write_digits(gen, w, "0123456789", 10, 1 + _below(gen, 4), true);
+			break;
+		case 5: /// go binary
+			ok = _puts(w, "0b") && _write_digits(gen, w, "01", 2, 1 + _below(gen, 16), false);
+			break;
+	}
+	return ok;
+}
+
+/// one character (or escape) of a string or rune body that's valid in both C and Go.
+static NO_NULL bool _write_str_char(struct CorpusGen *const gen, struct CorpusWriter *const w, const char quote)
+{
+	/// numeric escapes end in a space so the next character can't extend them.
+	static const char *const escapes[] = { "\\n", "\\t", "\\\\", "\\x41 ", "\\101 ", "\\u00e9", "\\r", "\\0 " };
+	const uint32_t r = _below(gen, 16);
+	if( r==0 ) {
+		/// a rune's closing quote already ends the escape.
+		const char *const esc = escapes[_below(gen, 8)];
+		const size_t len = strlen(esc);
+		return _put(w, esc, ( quote=='\'' && esc[len - 1]==' ' ) ? len - 1 : len);
+	}
+	else if( r==1 )
+		return _putc(w, '\\') && _putc(w, quote);
+	else if( r==2 ) {
+		/// a 2 or 3 byte utf-8 glyph.
+		char glyph[4] = {0};
+		const size_t n = write_utf8_cstr(glyph, sizeof glyph, 0xa0 + _below(gen, 0x2000));
+		return _put(w, glyph, n);
+	}
+	return _putc(w, " abcdefghijklmnopqrstuvwxyz0123456789"[_below(gen, 37)]);
+}
+
+static NO_NULL bool _write_string(struct CorpusGen *const gen, struct CorpusWriter *const w)
+{
+	if( gen->golang && _below(gen, 5)==0 ) {
+		/// raw string, may span lines.
+		bool ok = _putc(w, '`');
+		const uint32_t len = _below(gen, 40);
+		for( uint32_t i=0; ok && i<len; i++ )
+			ok = _putc(w, ( _below(gen, 20)==0 ) ? '\n' : "abcdefghij \"'"[_below(gen, 13)]);
+		return ok && _putc(w, '`');
+	}
+	bool ok = _putc(w, '"');
+	const uint32_t len = _below(gen, 32);
+	for( uint32_t i=0; ok && i<len; i++ )
+		ok = _write_str_char(gen, w, '"');
+	return ok && _putc(w, '"');
+}
+
+static NO_NULL bool _write_rune(struct CorpusGen *const gen, struct CorpusWriter *const w)
+{
+	return _putc(w, '\'') && _write_str_char(gen, w, '\'') && _putc(w, '\'');
+}
+
+/// comment text never contains an end token, but may hold other comment openers ("nested" comments).
+static NO_NULL bool _write_comment(struct CorpusGen *const gen, struct CorpusWriter *const w)
+{
+	const struct TargumTables *const tables = gen->tables;
+	const uint32_t count = tables->hdr->cmt_count;
+	if( count==0 )
+		return true;
+
+	const struct TargumCommentRule *const rule = &tables->comments[_below(gen, count)];
+	const bool multi_line = rule->end_len > 0;
+	bool ok = _put(w, targum_tables_str(tables, rule->begin_off), rule->begin_len);
+	const uint32_t words = 1 + _below(gen, 12);
+	for( uint32_t i=0; ok && i<words; i++ ) {
+		ok = _putc(w, ' ');
+		const uint32_t r = _below(gen, 10);
+		if( r==0 ) {
+			/// an opener of some comment rule, but never a closing one.
+			const struct TargumCommentRule *const inner = &tables->comments[_below(gen, count)];
+			ok = ok && _put(w, targum_tables_str(tables, inner->begin_off), inner->begin_len);
+		} else if( r==1 && multi_line ) {
+			ok = ok && _putc(w, '\n');
+		} else {
+			ok = ok && _write_identifier(gen, w);
+		}
+	}
+	if( multi_line )
+		return ok && _putc(w, ' ') && _put(w, targum_tables_str(tables, rule->end_off), rule->end_len);
+	return ok && _putc(w, '\n');
+}
+
+static NO_NULL bool _write_token(struct CorpusGen *const gen, struct CorpusWriter *const w)
+{
+	uint32_t pick = _below(gen, gen->token_total);
+	enum CorpusKind kind = CorpusKind_Identifier;
+	for( ; kind < CorpusKind_Newline; kind++ ) {
+		if( pick < gen->mix[kind] )
+			break;
+		pick -= gen->mix[kind];
+	}
+
+	switch( kind ) {
+		case CorpusKind_Keyword:
+			if( gen->keywords.count > 0 ) {
+				const struct HarbolString *const kw = harbol_vector_get(&gen->keywords, _below(gen, gen->keywords.count));
+				return _put(w, harbol_string_cstr(kw), kw->len);
+			}
+			return _write_identifier(gen, w);
+		case CorpusKind_Operator:
+			if( gen->operators.count > 0 ) {
+				const struct HarbolString *const op = harbol_vector_get(&gen->operators, _below(gen, gen->operators.count));
+				return _put(w, harbol_string_cstr(op), op->len);
+			}
+			return _write_identifier(gen, w);
+		case CorpusKind_Number:  return _write_number(gen, w);
+		case CorpusKind_String:  return _write_string(gen, w);
+		case CorpusKind_Rune:    return _write_rune(gen, w);
+		case CorpusKind_Comment: return _write_comment(gen, w);
+		default:                 return _write_identifier(gen, w);
+	}
+}
+
+/// tokens are always separated so neighbouring operators can't fuse into a different one.
+static NO_NULL bool _write_separator(struct CorpusGen *const gen, struct CorpusWriter *const w)
+{
+	const uint32_t r = _below(gen, 100);
+	if( r < gen->mix[CorpusKind_Newline] ) {
+		bool ok = _putc(w, '\n');
+		for( uint32_t i = _below(gen, 4); ok && i > 0; i-- )
+			ok = _putc(w, '\t');
+		return ok;
+	} else if( r < gen->mix[CorpusKind_Newline] + gen->mix[CorpusKind_Tab] )
+		return _putc(w, '\t');
+	return _putc(w, ' ');
+}
+
+/// parses "ident=30,keyword=5,..." into the weights.
+static NO_NULL bool _parse_mix(uint32_t mix[static CorpusKind_Count], const char spec[static 1])
+{
+	const char *iter = spec;
+	while( *iter != 0 ) {
+		const char *const eq = strchr(iter, '=');
+		if( eq==NULL )
+			return false;
+		const size_t name_len = (uintptr_t)(eq - iter);
+		size_t kind = 0;
+		for( ; kind<CorpusKind_Count; kind++ )
+			if( strlen(g_kind_names[kind])==name_len && !strncmp(iter, g_kind_names[kind], name_len) )
+				break;
+		if( kind==CorpusKind_Count )
+			return false;
+		char *end = NULL;
+		mix[kind] = strtoul(eq + 1, &end, 10);
+		if( end==eq + 1 || (*end != ',' && *end != 0) )
+			return false;
+		iter = ( *end==',' ) ? end + 1 : end;
+	}
+	return true;
+}
+
+/// "512", "64K", "16M", "2G".
+static NO_NULL uint64_t _parse_size(const char str[static 1])
+{
+	char *end = NULL;
+	uint64_t size = strtoull(str, &end, 10);
+	switch( *end ) {
+		case 'k': case 'K': size <<= 10; break;
+		case 'm': case 'M': size <<= 20; break;
+		case 'g': case 'G': size <<= 30; break;
+	}
+	return size;
+}
+
+int32_t main(const int32_t argc, char *argv[restrict static 1])
+{
+	const char *cfg_file = "tokens.cfg", *out_file = "-";
+	uint64_t size = 1u << 20, seed = 1;
+	struct CorpusGen gen = {0};
+	memcpy(gen.mix, g_default_mix, sizeof gen.mix);
+	int32_t style = -1;  /// -1 means use the config's style.
+	for( int32_t i=1; i<argc; i++ ) {
+		if( !strcmp(argv[i], "--help") ) {
+			puts("Targum Corpus Generator - 'targum_corpus [--cfg tokens.cfg] [--out file|-] [--size 16M] [--seed N] [--style c|go] [--mix ident=30,keyword=12,...]'\n"
+				"mix keys: ident, keyword, operator, number, string, rune, comment (token weights), newline, tab (separator percentages).");
+			return 0;
+		} else if( !strcmp(argv[i], "--cfg") && i + 1 < argc ) {
+			cfg_file = argv[++i];
+		} else if( !strcmp(argv[i], "--out") && i + 1 < argc ) {
+			out_file = argv[++i];
+		} else if( !strcmp(argv[i], "--size") && i + 1 < argc ) {
+			size = _parse_size(argv[++i]);
+		} else if( !strcmp(argv[i], "--seed") && i + 1 < argc ) {
+			seed = strtoull(argv[++i], NULL, 0);
+		} else if( !strcmp(argv[i], "--style") && i + 1 < argc ) {
+			++i;
+			style = !strcmp(argv[i], "go") ? 1 : 0;
+		} else if( !strcmp(argv[i], "--mix") && i + 1 < argc ) {
+			if( !_parse_mix(gen.mix, argv[++i]) ) {
+				fprintf(stderr, "Targum Corpus Generator Error: bad mix '%s'.\n", argv[i]);
+				return -1;
+			}
+		} else {
+			fprintf(stderr, "Targum Corpus Generator Error: unknown option '%s'.\n", argv[i]);
+			return -1;
+		}
+	}
+	for( size_t k=0; k<CorpusKind_Newline; k++ )
+		gen.token_total += gen.mix[k];
+	if( gen.token_total==0 ) {
+		fputs("Targum Corpus Generator Error: the mix needs at least one token weight.\n", stderr);
+		return -1;
+	}
+
+	struct HarbolLinkMap *cfg = harbol_cfg_parse_file(cfg_file);
+	struct TargumTables tables = {0};
+	if( cfg==NULL || !targum_tables_compile(&tables, cfg) ) {
+		fprintf(stderr, "Targum Corpus Generator Error: failed to load config '%s'.\n", cfg_file);
+		harbol_cfg_free(&cfg);
+		return -1;
+	}
+
+	gen.tables = &tables;
+	gen.state = seed;
+	gen.golang = ( style < 0 ) ? targum_tables_has(&tables, TargumTablesFlag_GolangStyle) : style==1;
+	gen.keywords = harbol_vector_create(sizeof(struct HarbolString), 0);
+	gen.operators = harbol_vector_create(sizeof(struct HarbolString), 0);
+	for( size_t i=0; i<tables.hdr->kw_cap; i++ ) {
+		const struct TargumKeywordSlot *const slot = &tables.keywords[i];
+		if( slot->len != 0 ) {
+			struct HarbolString kw = harbol_string_create(targum_tables_str(&tables, slot->str_off));
+			harbol_vector_insert(&gen.keywords, &kw);
+		}
+	}
+	/// keep the keyword order independent of the hash table layout.
+	qsort(gen.keywords.table, gen.keywords.count, gen.keywords.datasize, ( int(*)(const void*, const void*) )harbol_string_cmpstr);
+	struct HarbolString path = EMPTY_HARBOL_STRING;
+	_collect_operators(&gen, 0, &path);
+	harbol_string_clear(&path);
+
+	int32_t status = 0;
+	struct CorpusWriter *restrict w = harbol_alloc(1, sizeof *w);
+	if( w==NULL ) {
+		fprintf(stderr, "Targum Corpus Generator Error: out of memory.\n");
+		status = -1;
+		goto targum_corpus_exit;
+	}
+	w->out = !strcmp(out_file, "-") ? stdout : fopen(out_file, "wb");
+	if( w->out==NULL ) {
+		fprintf(stderr, "Targum Corpus Generator Error: failed to create '%s'.\n", out_file);
+		status = -1;
+		goto targum_corpus_exit;
+	}
+
+	bool ok = true;
+	while( ok && _total(w) < size )
+		ok = _write_token(&gen, w) && _write_separator(&gen, w);
+	ok = ok && _putc(w, '\n') && _flush(w);
+	if( w->out != stdout )
+		ok = (fclose(w->out)==0) && ok;
+	else ok = (fflush(stdout)==0) && ok;
+	if( !ok ) {
+		fprintf(stderr, "Targum Corpus Generator Error: failed writing '%s'.\n", out_file);
+		status = -1;
+	}
+
+targum_corpus_exit:;
+	harbol_free(w), w=NULL;
+	_clear_strings(&gen.keywords);
+	_clear_strings(&gen.operators);
+	targum_tables_clear(&tables);
+	harbol_cfg_free(&cfg);
+	return status;
+}
@@ -0,0 +1,377 @@
+#include "targum_lexer.h"
+
+/* targum_gen - emits a C scanner specialized for one config.
+ * Keywords become a switch on length with memcmp per candidate,
+ * operators become nested switches walking the operator trie,
+ * and the literal rules for the config's style are called directly.
+ */
+
+/// length buckets with more keywords than this get a switch on the first char.
+#define KEYWORD_SPLIT_MIN    4
+
+struct KeywordEntry {
+	const char *str;
+	uint32_t len, tag;
+};
+
+static int _cmp_keyword(const void *const a, const void *const b)
+{
+	const struct KeywordEntry *const x = a, *const y = b;
+	if( x->len != y->len )
+		return( x->len > y->len ) - ( x->len < y->len );
+	return memcmp(x->str, y->str, x->len);
+}
+
+static NO_NULL void _indent(FILE *const out, const size_t depth)
+{
+	for( size_t i=0; i<depth; i++ )
+		fputc('\t', out);
+}
+
+/// writes `c` as a C character constant.
+static NO_NULL void _write_char(FILE *const out, const uint8_t c)
+{
+	if( c=='\'' || c=='\\' )
+		fprintf(out, "'\\%c'", c);
+	else if( c >= 0x20 && c < 0x7f )
+		fprintf(out, "'%c'", c);
+	else fprintf(out, "'\\x%02x'", c);
+}
+
+/// writes `len` bytes of `str` as a C string literal.
+static NO_NULL void _write_str(FILE *const out, const char str[static 1], const size_t len)
+{
+	fputc('"', out);
+	for( size_t i=0; i<len; i++ ) {
+		const uint8_t c = str[i];
+		if( c=='"' || c=='\\' )
+			fprintf(out, "\\%c", c);
+		else if( c >= 0x20 && c < 0x7f && c != '?' )
+			fputc(c, out);
+		else fprintf(out, "\\%03o", c);
+	}
+	fputc('"', out);
+}
+
+static NO_NULL void _emit_keywords(FILE *const out, const struct TargumTables *const tables, const char prefix[static 1])
+{
+	const struct TargumTablesHeader *const hdr = tables->hdr;
+	struct KeywordEntry *restrict entries = ( hdr->kw_count > 0 ) ? harbol_alloc(hdr->kw_count, sizeof *entries) : NULL;
+	size_t count = 0;
+	for( size_t i=0; entries != NULL && i<hdr->kw_cap; i++ ) {
+		const struct TargumKeywordSlot *const slot = &tables->keywords[i];
+		if( slot->len==0 )
+			continue;
+		entries[count++] = ( struct KeywordEntry ){ targum_tables_str(tables, slot->str_off), slot->len, slot->tag };
+	}
+	if( count > 0 )
+		qsort(entries, count, sizeof *entries, _cmp_keyword);
+
+	fprintf(out, "static bool %s_keyword(const char s[], const size_t len, uint32_t *const tag)\n{\n", prefix);
+	if( count==0 ) {
+		fputs("\t(void)s; (void)len; (void)tag;\n\treturn false;\n}\n\n", out);
+		return;
+	}
+	fputs("\tswitch( len ) {\n", out);
+	for( size_t i=0; i<count; ) {
+		const uint32_t len = entries[i].len;
+		size_t bucket_end = i;
+		while( bucket_end<count && entries[bucket_end].len==len )
+			bucket_end++;
+		fprintf(out, "\t\tcase %" PRIu32 ":\n", len);
+		/// bigger buckets branch on the first char before comparing the rest.
+		const bool split = bucket_end - i > KEYWORD_SPLIT_MIN;
+		if( split )
+			fputs("\t\t\tswitch( s[0] ) {\n", out);
+		for( ; i<bucket_end; i++ ) {
+			const size_t indent = split ? 5 : 3;
+			if( split && (i==0 || entries[i - 1].len != len || entries[i - 1].str[0] != entries[i].str[0]) ) {
+				fputs("\t\t\t\tcase ", out);
+				_write_char(out, entries[i].str[0]);
+				fputs(":\n", out);
+			}
+			_indent(out, indent);
+			fputs("if( !memcmp(s, ", out);
+			_write_str(out, entries[i].str, entries[i].len);
+			fprintf(out, ", %" PRIu32 ") ) { *tag = %" PRIu32 "u; return true; }\n", len, entries[i].tag);
+			if( split && (i + 1==bucket_end || entries[i + 1].str[0] != entries[i].str[0]) )
+				fputs("\t\t\t\t\tbreak;\n", out);
+		}
+		if( split )
+			fputs("\t\t\t}\n", out);
+		fputs("\t\t\tbreak;\n", out);
+	}
+	fputs("\t}\n\treturn false;\n}\n\n", out);
+	harbol_free(entries), entries=NULL;
+}
+
+/// emits the switch for the children of `node`, `fallback_len`/`fallback_tag` is the longest match so far.
+static NO_NULL void _emit_operator_node(FILE *const out, const struct TargumTables *const tables, const uint32_t node, const size_t depth, const size_t indent, const size_t fallback_len, const uint32_t fallback_tag)
+{
+	const struct TargumOperatorNode *const nodes = tables->operators;
+	_indent(out, indent);
+	fprintf(out, "switch( s[%zu] ) {\n", depth);
+	for( uint32_t child = nodes[node].first_child; child != 0; child = nodes[child].next_sibling ) {
+		const struct TargumOperatorNode *const n = &nodes[child];
+		const size_t len = n->terminal ? depth + 1 : fallback_len;
+		const uint32_t tag = n->terminal ? n->tag : fallback_tag;
+		_indent(out, indent + 1);
+		fputs("case ", out);
+		_write_char(out, n->chr);
+		fputs(":\n", out);
+		if( n->first_child != 0 )
+			_emit_operator_node(out, tables, child, depth + 1, indent + 2, len, tag);
+		_indent(out, indent + 2);
+		if( len > 0 )
+			fprintf(out, "*tag = %" PRIu32 "u; return %zu;\n", tag, len);
+		else fputs("return 0;\n", out);
+	}
+	_indent(out, indent);
+	fputs("}\n", out);
+}
+
+static NO_NULL void _emit_operators(FILE *const out, const struct TargumTables *const tables, const char prefix[static 1])
+{
+	fprintf(out, "static size_t %s_operator(const char s[], uint32_t *const tag)\n{\n", prefix);
+	if( tables->operators[0].first_child==0 ) {
+		fputs("\t(void)s; (void)tag;\n\treturn 0;\n}\n\n", out);
+		return;
+	}
+	_emit_operator_node(out, tables, 0, 0, 1, 0, 0);
+	fputs("\treturn 0;\n}\n\n", out);
+}
+
+static NO_NULL void _emit_error(FILE *const out, const size_t depth, const bool recover, const char start[static 1], const char kind[static 1])
+{
+	if( recover ) {
+		_indent(out, depth); fprintf(out, "targum_lexer_recover_error(lexer, %s, %s, TAG_ERROR);\n", start, kind);
+		_indent(out, depth); fputs("token_count++;\n", out);
+		_indent(out, depth); fputs("continue;\n", out);
+	} else {
+		_indent(out, depth); fputs("goto scan_exit;\n", out);
+	}
+}
+
+static NO_NULL void _emit_scanner(FILE *const out, const struct TargumTables *const tables, const char prefix[static 1], const char cfg_name[static 1])
+{
+	const bool golang = targum_tables_has(tables, TargumTablesFlag_GolangStyle);
+	const bool recover = targum_tables_has(tables, TargumTablesFlag_ErrorRecovery);
+	const size_t on_demand = targum_tables_on_demand(tables);
+
+	fprintf(out, "/* Generated by targum_gen from '%s', do not edit.\n", cfg_name);
+	fprintf(out, " * Hook it up with `targum_lexer_set_scanner(lexer, &%s);`\n */\n", prefix);
+	fputs("#include \"targum_lexer.h\"\n\n", out);
+
+	const char *const tag_names[] = { "IDENTIFIER", "INTEGER", "FLOAT", "STRING", "RUNE", "COMMENT", "ERROR", "SPACE", "TAB", "NEWLINE" };
+	for( size_t i=0; i<TargumTag_Count; i++ )
+		fprintf(out, "#define TAG_%-12s %" PRIu32 "u\n", tag_names[i], targum_tables_tag(tables, i));
+	fputc('\n', out);
+
+	_emit_keywords(out, tables, prefix);
+	_emit_operators(out, tables, prefix);
+
+	/// `kind` feeds the lexer stats, TargumStat_Count for the EOF token which isn't counted.
+	fprintf(out, "static bool %s_push(struct TargumLexer *const lexer, const size_t start, const size_t end, const size_t line, const size_t col, const uint32_t tag, const enum TargumStatKind kind, const char lexeme[const], const size_t len)\n{\n", prefix);
+	fputs("\tstruct TargumTokenInfo tok = {\n"
+		"\t\t.lexeme = targum_lexer_store_lexeme(lexer, lexeme, len),\n"
+		"\t\t.filename = &lexer->filename,\n"
+		"\t\t.start = start, .end = end, .line = line, .col = col,\n"
+		"\t\t.tag = tag\n"
+		"\t};\n"
+		"\tif( kind < TargumStat_Count ) {\n"
+		"\t\tlexer->stats.tokens[kind]++;\n"
+		"\t\tlexer->stats.bytes[kind] += end - start;\n"
+		"\t}\n"
+		"\t/* a token whose lexeme didn't fit in the arena isn't pushed, the token count check fails the run. */\n"
+		"\treturn harbol_string_cstr(&tok.lexeme) != NULL && harbol_seg_vector_push_TargumTokenInfo(&lexer->tokens, &tok);\n}\n\n", out);
+
+	fprintf(out, "static bool %s_generate_tokens(struct TargumLexer *const lexer)\n{\n", prefix);
+	fputs("\tbool result = false;\n"
+		"\tconst size_t diag_count = lexer->diags.count, first_token = lexer->tokens.count;\n"
+		"\tsize_t token_count = 0;\n"
+		"\tif( harbol_string_is_empty(&lexer->src) ) {\n"
+		"\t\ttargum_err(harbol_string_cstr(&lexer->filename), \"critical error\", 1, 0, \"No source file loaded! Failed to generate tokens.\");\n"
+		"\t\tgoto scan_exit;\n"
+		"\t}\n"
+		"\twhile( *lexer->iter != 0 ) {\n"
+		"\t\tconst char *const start = lexer->iter;\n"
+		"\t\tconst size_t start_off = (uintptr_t)(start - harbol_string_cstr(&lexer->src));\n", out);
+	if( on_demand > 0 )
+		fprintf(out, "\t\tif( token_count >= %zu )\n\t\t\treturn lexer->diags.count==diag_count && lexer->tokens.count - first_token==token_count;\n", on_demand);
+
+	/// whitespace.
+	const struct { enum TargumTablesFlag flag; const char *chr, *tag; } ws[] = {
+		{ TargumTablesFlag_HasSpace, "' '", "TAG_SPACE" },
+		{ TargumTablesFlag_HasTab, "'\\t'", "TAG_TAB" },
+		{ TargumTablesFlag_HasNewline, "'\\n'", "TAG_NEWLINE" },
+	};
+	bool any_ws = false;
+	for( size_t i=0; i<sizeof ws / sizeof ws[0]; i++ )
+		any_ws |= targum_tables_has(tables, ws[i].flag);
+	fputs("\t\tif( is_whitespace(*lexer->iter) ) {\n", out);
+	/// same as the runtime lexer: the token's position is the char's own, taken before a newline moves `line`.
+	if( any_ws )
+		fputs("\t\t\tconst size_t ws_line = lexer->line, ws_col = (uintptr_t)(lexer->iter - lexer->line_start);\n", out);
+	fputs("\t\t\tconst int32_t c = *lexer->iter++;\n"
+		"\t\t\tif( c=='\\n' ) {\n"
+		"\t\t\t\tlexer->line++;\n"
+		"\t\t\t\tlexer->line_start = lexer->iter;\n"
+		"\t\t\t}\n", out);
+	if( any_ws ) {
+		fputs("\t\t\tswitch( c ) {\n", out);
+		for( size_t i=0; i<sizeof ws / sizeof ws[0]; i++ ) {
+			if( !targum_tables_has(tables, ws[i].flag) )
+				continue;
+			fprintf(out, "\t\t\t\tcase %s: {\n"
+				"\t\t\t\t\t%s_push(lexer, start_off, start_off + 1, ws_line, ws_col, %s, TargumStat_Whitespace, start, 1);\n"
+				"\t\t\t\t\ttoken_count++;\n"
+				"\t\t\t\t\tbreak;\n"
+				"\t\t\t\t}\n", ws[i].chr, prefix, ws[i].tag);
+		}
+		fputs("\t\t\t}\n", out);
+	}
+	fputs("\t\t\tcontinue;\n\t\t}\n", out);
+
+	/// identifiers & keywords.
+	fprintf(out, "\t\tconst size_t line = lexer->line, col = (uintptr_t)(start - lexer->line_start);\n"
+		"\t\tif( is_alphabetic(*lexer->iter) ) {\n"
+		"\t\t\twhile( *lexer->iter != 0 && is_possible_id(*lexer->iter) )\n"
+		"\t\t\t\tlexer->iter++;\n"
+		"\t\t\tconst size_t len = (uintptr_t)(lexer->iter - start);\n"
+		"\t\t\tuint32_t tag = TAG_IDENTIFIER;\n"
+		"\t\t\tconst bool is_keyword = %s_keyword(start, len, &tag);\n"
+		"\t\t\t%s_push(lexer, start_off, start_off + len, line, col, tag, is_keyword ? TargumStat_Keyword : TargumStat_Identifier, start, len);\n"
+		"\t\t\ttoken_count++;\n"
+		"\t\t\tcontinue;\n"
+		"\t\t}\n", prefix, prefix);
+
+	/// numbers.
+	fprintf(out, "\t\tif( is_decimal(*lexer->iter) || *lexer->iter=='.' ) {\n"
+		"\t\t\tbool is_float = false;\n"
+		"\t\t\tconst char *end = NULL;\n"
+		"\t\t\tif( %s(start, &end, &lexer->scratch, &is_float) ) {\n"
+		"\t\t\t\tlexer->iter = ( char* )end;\n"
+		"\t\t\t\t%s_push(lexer, start_off, (uintptr_t)(lexer->iter - harbol_string_cstr(&lexer->src)), line, col, is_float ? TAG_FLOAT : TAG_INTEGER, is_float ? TargumStat_Float : TargumStat_Integer, harbol_string_cstr(&lexer->scratch), lexer->scratch.len);\n"
+		"\t\t\t\tharbol_string_reset(&lexer->scratch);\n"
+		"\t\t\t\ttoken_count++;\n"
+		"\t\t\t\tcontinue;\n"
+		"\t\t\t}\n"
+		"\t\t\tharbol_string_reset(&lexer->scratch);\n"
+		"\t\t\tif( *start != '.' ) {\n"
+		"\t\t\t\ttargum_err(harbol_string_cstr(&lexer->filename), \"error\", line, col, \"invalid number!\");\n",
+		golang ? "lex_go_style_number" : "lex_c_style_number", prefix);
+	_emit_error(out, 4, recover, "start", "TargumDiag_InvalidNumber");
+	fputs("\t\t\t}\n\t\t}\n", out);
+
+	/// comments, in config order.
+	for( size_t i=0; i<tables->hdr->cmt_count; i++ ) {
+		const struct TargumCommentRule *const rule = &tables->comments[i];
+		const bool single_line = rule->end_len==0;
+		fputs("\t\tif( !strncmp(start, ", out);
+		_write_str(out, targum_tables_str(tables, rule->begin_off), rule->begin_len);
+		fprintf(out, ", %" PRIu32 ") ) {\n", rule->begin_len);
+		if( single_line ) {
+			fputs("\t\t\tconst bool ok = lex_single_line_comment(start, ( const char** )&lexer->iter, &lexer->scratch);\n", out);
+		} else {
+			fputs("\t\t\tconst bool ok = lex_multi_line_comment(start, ( const char** )&lexer->iter, ", out);
+			_write_str(out, targum_tables_str(tables, rule->end_off), rule->end_len);
+			fprintf(out, ", %" PRIu32 ", &lexer->scratch);\n", rule->end_len);
+		}
+		fprintf(out, "\t\t\tif( ok ) {\n"
+			"\t\t\t\t%s_push(lexer, start_off, (uintptr_t)(lexer->iter - harbol_string_cstr(&lexer->src)), line, col, TAG_COMMENT, TargumStat_Comment, harbol_string_cstr(&lexer->scratch), lexer->scratch.len);\n"
+			"\t\t\t\tharbol_string_reset(&lexer->scratch);\n"
+			"\t\t\t\ttoken_count++;\n"
+			"\t\t\t\tcontinue;\n"
+			"\t\t\t}\n"
+			"\t\t\tharbol_string_reset(&lexer->scratch);\n"
+			"\t\t\ttargum_err(harbol_string_cstr(&lexer->filename), \"error\", lexer->line, (uintptr_t)(lexer->iter - lexer->line_start), \"invalid %s comment!\");\n",
+			prefix, single_line ? "single-line" : "multi-line");
+		_emit_error(out, 3, recover, "start", "TargumDiag_InvalidComment");
+		fputs("\t\t}\n", out);
+	}
+
+	/// strings & runes.
+	fprintf(out, "\t\tif( *start=='\"' || *start=='\\''%s ) {\n"
+		"\t\t\tconst bool is_str = *start != '\\'';\n"
+		"\t\t\tif( %s(start, ( const char** )&lexer->iter, &lexer->scratch) ) {\n"
+		"\t\t\t\t%s_push(lexer, start_off, (uintptr_t)(lexer->iter - harbol_string_cstr(&lexer->src)), line, col, is_str ? TAG_STRING : TAG_RUNE, is_str ? TargumStat_String : TargumStat_Rune, harbol_string_cstr(&lexer->scratch), lexer->scratch.len);\n"
+		"\t\t\t\tharbol_string_reset(&lexer->scratch);\n"
+		"\t\t\t\ttoken_count++;\n"
+		"\t\t\t\tcontinue;\n"
+		"\t\t\t}\n"
+		"\t\t\tharbol_string_reset(&lexer->scratch);\n"
+		"\t\t\ttargum_err(harbol_string_cstr(&lexer->filename), \"error\", lexer->line, (uintptr_t)(lexer->iter - lexer->line_start), is_str ? \"invalid string!\" : \"invalid rune\");\n",
+		golang ? " || *start=='`'" : "", golang ? "lex_go_style_str" : "lex_c_style_str", prefix);
+	_emit_error(out, 3, recover, "start", "is_str ? TargumDiag_InvalidString : TargumDiag_InvalidRune");
+	fputs("\t\t}\n", out);
+
+	/// operators.
+	fprintf(out, "\t\tuint32_t tag = 0;\n"
+		"\t\tlexer->stats.operator_attempts++;\n"
+		"\t\tconst size_t operator_size = %s_operator(start, &tag);\n"
+		"\t\tif( operator_size > 0 ) {\n"
+		"\t\t\tlexer->iter += operator_size;\n"
+		"\t\t\t%s_push(lexer, start_off, start_off + operator_size, line, col, tag, TargumStat_Operator, start, operator_size);\n"
+		"\t\t\ttoken_count++;\n"
+		"\t\t\tcontinue;\n"
+		"\t\t}\n"
+		"\t\ttargum_err(harbol_string_cstr(&lexer->filename), \"error\", line, col, \"found no match for symbol(s) '%%c' (%%u) in operators section.\", *start, *start);\n",
+		prefix, prefix);
+	_emit_error(out, 2, recover, "start", "TargumDiag_UnknownOperator");
+	fputs("\t}\n"
+		"\tresult = lexer->diags.count==diag_count;\n"
+		"scan_exit:;\n"
+		"\tconst size_t eof_off = (uintptr_t)(lexer->iter - harbol_string_cstr(&lexer->src));\n", out);
+	fprintf(out, "\tif( lexer->tokens.count - first_token != token_count )\n"
+		"\t\tresult = false;\n"
+		"\tresult &= %s_push(lexer, eof_off, eof_off, lexer->line, (uintptr_t)(lexer->iter - lexer->line_start), 0, TargumStat_Count, \"\", 0);\n"
+		"\treturn lexer->tokens.count > 1 && result;\n}\n\n", prefix);
+
+	fprintf(out, "const struct TargumScanner %s = {\n"
+		"\t.generate = %s_generate_tokens,\n"
+		"\t.on_demand = %zu,\n"
+		"\t.flags = 0x%" PRIx32 "u,\n"
+		"\t.tags = { TAG_IDENTIFIER, TAG_INTEGER, TAG_FLOAT, TAG_STRING, TAG_RUNE, TAG_COMMENT, TAG_ERROR, TAG_SPACE, TAG_TAB, TAG_NEWLINE }\n"
+		"};\n", prefix, prefix, on_demand, tables->hdr->flags);
+}
+
+int32_t main(const int32_t argc, char *argv[restrict static 1])
+{
+	if( argc>1 && !strcmp(argv[1], "--help") ) {
+		puts("Targum Scanner Generator - 'targum_gen config.cfg output.c [scanner_name]'\nExample: 'targum_gen tokens.cfg my_scanner.c my_scanner'");
+		return 0;
+	} else if( argc>1 && !strcmp(argv[1], "--version") ) {
+		puts("Targum Scanner Generator Version " TARGUM_LEXER_VERSION_STRING);
+		return 0;
+	} else if( argc<3 ) {
+		puts("Targum Scanner Generator Error: missing config file or output file.");
+		return -1;
+	}
+
+	const char *const scanner_name = ( argc>3 ) ? argv[3] : "targum_scanner";
+	struct HarbolLinkMap *cfg = harbol_cfg_parse_file(argv[1]);
+	if( cfg==NULL ) {
+		printf("Targum Scanner Generator Error: failed to parse config '%s'.\n", argv[1]);
+		return -1;
+	}
+
+	struct TargumTables tables = {0};
+	int32_t status = -1;
+	if( !targum_tables_compile(&tables, cfg) ) {
+		printf("Targum Scanner Generator Error: config '%s' needs a tokens section with keywords or operators.\n", argv[1]);
+		goto targum_gen_exit;
+	}
+
+	FILE *restrict out = fopen(argv[2], "w");
+	if( out==NULL ) {
+		printf("Targum Scanner Generator Error: failed to create '%s'.\n", argv[2]);
+		goto targum_gen_exit;
+	}
+	_emit_scanner(out, &tables, scanner_name, argv[1]);
+	status = ( fclose(out)==0 ) ? 0 : -1, out = NULL;
+
+targum_gen_exit:;
+	targum_tables_clear(&tables);
+	harbol_cfg_free(&cfg);
+	return status;
+}
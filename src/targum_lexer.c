@@ -1,27 +1,38 @@
+#define HARBOL_ALLOC_CATEGORY    HarbolAllocCategory_Token
 #include <stdarg.h>
 #include <ctype.h>
 #include <assert.h>
 
 #include "targum_lexer.h"
+#include "targum_cache.h"
 
 #ifdef OS_WINDOWS
 #	define TARGUM_LIB
 #endif
 
+#ifdef TARGUM_LEXER_TIMING
+#	if defined(__x86_64__) || defined(__i386__)
+#		include <x86intrin.h>
+#	else
+#		include <time.h>
+#	endif
+#endif
+
 
 TARGUM_API void targum_token_info_clear(struct TargumTokenInfo *const tokinfo)
 {
-	harbol_string_clear(&tokinfo->lexeme);
+	/// the lexeme lives in its lexer's arena, it's released with the arena.
+	tokinfo->lexeme = (struct HarbolString)EMPTY_HARBOL_STRING;
 }
 
 TARGUM_API const char *targum_token_info_get_lexeme(const struct TargumTokenInfo *const tokinfo)
 {
-	return tokinfo->lexeme.cstr;
+	return harbol_string_cstr(&tokinfo->lexeme);
 }
 
 TARGUM_API const char *targum_token_info_get_filename(const struct TargumTokenInfo *const tokinfo)
 {
-	return tokinfo->filename->cstr;
+	return harbol_string_cstr(tokinfo->filename);
 }
 
 TARGUM_API uint32_t targum_token_info_get_token(const struct TargumTokenInfo *const tokinfo)
@@ -49,15 +60,16 @@ TARGUM_API struct TargumLexer *targum_lexer_new_from_file(const char filename[re
 
 NEVER_NULL(1) static void _setup_lexer(struct TargumLexer *const lexer, struct HarbolLinkMap *const cfg)
 {
-	lexer->iter = lexer->line_start = lexer->src.cstr;
+	/// `iter` & `line_start` point into the source, which can't stay inline in a lexer that's returned by value.
+	harbol_string_reserve(&lexer->src, HARBOL_STRING_SSO_CAP + 1);
+	lexer->iter = lexer->line_start = harbol_string_cstr(&lexer->src);
 	lexer->cfg = cfg;
-	lexer->tokens = harbol_vector_create(sizeof(struct TargumTokenInfo), 0);
 	lexer->line = 1;
 }
 
 TARGUM_API struct TargumLexer targum_lexer_create_from_buffer(const char src[restrict static 1], struct HarbolLinkMap *const restrict cfg)
 {
-	struct TargumLexer lexer = {0};
+	struct TargumLexer lexer = { .allocator = harbol_allocator_get() };
 	lexer.src = harbol_string_create(src);
 	harbol_string_format(&lexer.filename, "%p", src);
 	_setup_lexer(&lexer, cfg);
@@ -66,7 +78,7 @@ TARGUM_API struct TargumLexer targum_lexer_create_from_buffer(const char src[res
 
 TARGUM_API struct TargumLexer targum_lexer_create_from_file(const char filename[restrict static 1], struct HarbolLinkMap *const restrict cfg)
 {
-	struct TargumLexer lexer = {0};
+	struct TargumLexer lexer = { .allocator = harbol_allocator_get() };
 	FILE *restrict src_file = fopen(filename, "r");
 	if( src_file==NULL )
 		return lexer;
@@ -82,42 +94,142 @@ TARGUM_API struct TargumLexer targum_lexer_create_from_file(const char filename[
 	return lexer;
 }
 
-static void clear_token(void **const p)
+TARGUM_API struct TargumLexer targum_lexer_create_from_buffer_with_allocator(const char src[restrict static 1], struct HarbolLinkMap *const restrict cfg, const struct HarbolAllocator *const allocator)
 {
-	struct TargumTokenInfo *t = *p;
-	harbol_string_clear(&t->lexeme);
+	const struct HarbolAllocator *const prev = harbol_allocator_swap(allocator);
+	const struct TargumLexer lexer = targum_lexer_create_from_buffer(src, cfg);
+	harbol_allocator_swap(prev);
+	return lexer;
+}
+
+TARGUM_API struct TargumLexer targum_lexer_create_from_file_with_allocator(const char filename[restrict static 1], struct HarbolLinkMap *const restrict cfg, const struct HarbolAllocator *const allocator)
+{
+	const struct HarbolAllocator *const prev = harbol_allocator_swap(allocator);
+	const struct TargumLexer lexer = targum_lexer_create_from_file(filename, cfg);
+	harbol_allocator_swap(prev);
+	return lexer;
 }
 
 TARGUM_API void targum_lexer_clear(struct TargumLexer *const lexer, const bool free_config)
 {
+	const struct HarbolAllocator *const prev = harbol_allocator_swap(lexer->allocator);
 	targum_lexer_clear_tokens(lexer);
+	harbol_seg_vector_clear_TargumTokenInfo(&lexer->tokens);
+	harbol_arena_clear(&lexer->arena);
+	harbol_string_clear(&lexer->scratch);
+	harbol_vector_clear_TargumDiagnostic(&lexer->diags);
 	if( free_config )
 		harbol_cfg_free(&lexer->cfg);
 	harbol_string_clear(&lexer->filename);
 	harbol_string_clear(&lexer->src);
+	harbol_string_clear(&lexer->cache_dir);
+	targum_tables_clear(&lexer->tables);
+	harbol_allocator_swap(prev);
 }
 
 
 TARGUM_API void targum_lexer_clear_tokens(struct TargumLexer *const lexer)
 {
-	harbol_vector_clear(&lexer->tokens, clear_token);
+	/// every lexeme lives in the arena, so there's nothing to free token by token.
+	/// the token blocks are kept for the next run.
+	harbol_seg_vector_truncate_TargumTokenInfo(&lexer->tokens, 0);
+	harbol_arena_reset(&lexer->arena);
 	lexer->index = 0;
+	lexer->curr_tok = NULL;
+}
+
+TARGUM_API struct HarbolString targum_lexer_store_lexeme(struct TargumLexer *const restrict lexer, const char str[restrict], const size_t len)
+{
+	const struct HarbolAllocator *const prev = harbol_allocator_swap(lexer->allocator);
+	char *const lexeme = harbol_arena_dup(&lexer->arena, str, len);
+	harbol_allocator_swap(prev);
+	/// the arena owns the chars, the token only borrows them.
+	return harbol_string_borrow(lexeme, len);
+}
+
+/// a token whose lexeme the arena had no room for isn't pushed, so the token count check fails the run.
+static inline NO_NULL bool _push_token(struct TargumLexer *const restrict lexer, const struct TargumTokenInfo *const restrict tok)
+{
+	return harbol_string_cstr(&tok->lexeme) != NULL && harbol_seg_vector_push_TargumTokenInfo(&lexer->tokens, tok);
+}
+
+/// moves a literal decoded into the scratch buffer over to the arena.
+static NO_NULL struct HarbolString _store_scratch(struct TargumLexer *const lexer)
+{
+	const struct HarbolString lexeme = targum_lexer_store_lexeme(lexer, harbol_string_cstr(&lexer->scratch), lexer->scratch.len);
+	harbol_string_reset(&lexer->scratch);
+	return lexeme;
 }
 
 TARGUM_API void targum_lexer_free(struct TargumLexer **const lexer_ref, const bool free_config)
 {
+	const struct HarbolAllocator *const prev = harbol_allocator_swap((*lexer_ref)->allocator);
 	targum_lexer_clear(*lexer_ref, free_config);
 	harbol_free(*lexer_ref), *lexer_ref = NULL;
+	harbol_allocator_swap(prev);
 }
 
 TARGUM_API bool targum_lexer_load_cfg_file(struct TargumLexer *const restrict lexer, const char filename[restrict static 1])
 {
-	return lexer->cfg = harbol_cfg_parse_file(filename), lexer->cfg != NULL;
+	const struct HarbolAllocator *const prev = harbol_allocator_swap(lexer->allocator);
+	targum_tables_clear(&lexer->tables);
+	lexer->cfg = harbol_cfg_parse_file(filename);
+	harbol_allocator_swap(prev);
+	return lexer->cfg != NULL;
 }
 
 TARGUM_API bool targum_lexer_load_cfg_cstr(struct TargumLexer *const restrict lexer, const char cfg_cstr[restrict static 1])
 {
-	return lexer->cfg = harbol_cfg_parse_cstr(cfg_cstr), lexer->cfg != NULL;
+	const struct HarbolAllocator *const prev = harbol_allocator_swap(lexer->allocator);
+	targum_tables_clear(&lexer->tables);
+	lexer->cfg = harbol_cfg_parse_cstr(cfg_cstr);
+	harbol_allocator_swap(prev);
+	return lexer->cfg != NULL;
+}
+
+/// compiles the config into lookup tables on first use, unless tables were loaded already.
+static NO_NULL bool _ensure_tables(struct TargumLexer *const lexer)
+{
+	if( targum_tables_is_loaded(&lexer->tables) )
+		return true;
+	else if( lexer->cfg==NULL )
+		return false;
+	
+	const struct HarbolAllocator *const prev = harbol_allocator_swap(lexer->allocator);
+	const bool result = targum_tables_compile(&lexer->tables, lexer->cfg);
+	harbol_allocator_swap(prev);
+	return result;
+}
+
+/// token values & flags come from the compiled-in scanner if there is one, else from the tables.
+static NO_NULL bool _lexer_has(struct TargumLexer *const lexer, const enum TargumTablesFlag flag)
+{
+	if( lexer->scanner != NULL )
+		return (lexer->scanner->flags & flag) != 0;
+	else return _ensure_tables(lexer) && targum_tables_has(&lexer->tables, flag);
+}
+
+static NO_NULL uint32_t _lexer_tag(struct TargumLexer *const lexer, const enum TargumTag tag)
+{
+	return( lexer->scanner != NULL ) ? lexer->scanner->tags[tag] : targum_tables_tag(&lexer->tables, tag);
+}
+
+TARGUM_API bool targum_lexer_load_tables_file(struct TargumLexer *const restrict lexer, const char filename[restrict static 1])
+{
+	const struct HarbolAllocator *const prev = harbol_allocator_swap(lexer->allocator);
+	const bool result = targum_tables_load_file(&lexer->tables, filename);
+	harbol_allocator_swap(prev);
+	return result;
+}
+
+TARGUM_API bool targum_lexer_save_tables_file(struct TargumLexer *const restrict lexer, const char filename[restrict static 1])
+{
+	return _ensure_tables(lexer) && targum_tables_save_file(&lexer->tables, filename);
+}
+
+TARGUM_API const struct TargumTables *targum_lexer_get_tables(struct TargumLexer *const lexer)
+{
+	return _ensure_tables(lexer) ? &lexer->tables : NULL;
 }
 
 TARGUM_API struct HarbolLinkMap *targum_lexer_get_cfg(const struct TargumLexer *const lexer)
@@ -125,9 +237,32 @@ TARGUM_API struct HarbolLinkMap *targum_lexer_get_cfg(const struct TargumLexer *
 	return lexer->cfg;
 }
 
+TARGUM_API void targum_lexer_set_scanner(struct TargumLexer *const restrict lexer, const struct TargumScanner *const restrict scanner)
+{
+	lexer->scanner = scanner;
+}
+
+TARGUM_API bool targum_lexer_set_cache_dir(struct TargumLexer *const restrict lexer, const char cache_dir[restrict], const size_t max_bytes)
+{
+	if( cache_dir==NULL ) {
+		const struct HarbolAllocator *const prev = harbol_allocator_swap(lexer->allocator);
+		harbol_string_clear(&lexer->cache_dir);
+		harbol_allocator_swap(prev);
+		return true;
+	} else {
+		lexer->cache_limit = ( max_bytes==0 ) ? TARGUM_CACHE_DEFAULT_LIMIT : max_bytes;
+		/// the directory's size isn't known yet, the first store measures it.
+		lexer->cache_size = SIZE_MAX;
+		const struct HarbolAllocator *const prev = harbol_allocator_swap(lexer->allocator);
+		const bool result = harbol_string_copy_cstr(&lexer->cache_dir, cache_dir);
+		harbol_allocator_swap(prev);
+		return result;
+	}
+}
+
 TARGUM_API const char *targum_lexer_get_filename(const struct TargumLexer *const lexer)
 {
-	return lexer->filename.cstr;
+	return harbol_string_cstr(&lexer->filename);
 }
 
 TARGUM_API size_t targum_lexer_get_token_index(const struct TargumLexer *const lexer)
@@ -147,296 +282,502 @@ TARGUM_API struct TargumTokenInfo *targum_lexer_get_token(const struct TargumLex
 
 TARGUM_API struct TargumTokenInfo *targum_lexer_advance(struct TargumLexer *const lexer, const bool flush_old_tokens)
 {
-	if( lexer->cfg==NULL )
+	if( lexer->scanner==NULL && !_ensure_tables(lexer) )
 		return lexer->curr_tok;
 	
-	const intmax_t max_toks = *harbol_cfg_get_int(lexer->cfg, "tokens.on demand");
+	const size_t max_toks = ( lexer->scanner != NULL ) ? lexer->scanner->on_demand : targum_tables_on_demand(&lexer->tables);
 	if( lexer->index < lexer->tokens.count ) {
-		lexer->curr_tok = harbol_vector_get(&lexer->tokens, lexer->index++);
+		lexer->curr_tok = harbol_seg_vector_get_TargumTokenInfo(&lexer->tokens, lexer->index++);
 	} else if( max_toks > 0 ) {
 		if( flush_old_tokens )
 			targum_lexer_clear_tokens(lexer);
 		targum_lexer_generate_tokens(lexer);
-		lexer->curr_tok = harbol_vector_get(&lexer->tokens, lexer->index++);
+		lexer->curr_tok = harbol_seg_vector_get_TargumTokenInfo(&lexer->tokens, lexer->index++);
 	}
 	return lexer->curr_tok;
 }
 
 TARGUM_API void targum_lexer_reset(struct TargumLexer *lexer)
 {
+	const struct HarbolAllocator *const prev = harbol_allocator_swap(lexer->allocator);
 	targum_lexer_clear_tokens(lexer);
+	harbol_vector_clear_TargumDiagnostic(&lexer->diags);
+	targum_lexer_reset_stats(lexer);
+	/// the config may have been edited since, recompile it on the next run.
+	if( lexer->cfg != NULL )
+		targum_tables_clear(&lexer->tables);
 	_setup_lexer(lexer, lexer->cfg);
+	harbol_allocator_swap(prev);
 }
 
 TARGUM_API void targum_lexer_reset_token_index(struct TargumLexer *lexer)
 {
 	lexer->index = 0;
-	lexer->curr_tok = harbol_vector_get(&lexer->tokens, lexer->index++);
+	lexer->curr_tok = harbol_seg_vector_get_TargumTokenInfo(&lexer->tokens, lexer->index++);
 }
 
-TARGUM_API bool targum_lexer_generate_tokens(struct TargumLexer *const lexer)
+static inline NO_NULL void _count_token(struct TargumLexer *const lexer, const enum TargumStatKind kind, const size_t bytes)
+{
+	lexer->stats.tokens[kind]++;
+	lexer->stats.bytes[kind] += bytes;
+}
+
+/// the phase a loop iteration of `targum_lexer_generate_tokens` is charged to.
+struct TargumPhaseClock {
+	uint64_t start;
+	enum TargumPhase phase;
+};
+
+#ifdef TARGUM_LEXER_TIMING
+static inline uint64_t _ticks(void)
+{
+#	if defined(__x86_64__) || defined(__i386__)
+	return __rdtsc();
+#	else
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ( uint64_t )ts.tv_sec * 1000000000u + ts.tv_nsec;
+#	endif
+}
+#endif
+
+/// charges the time since the last tick to the phase that was running.
+static inline NO_NULL void _tick_phase(struct TargumLexer *const lexer, struct TargumPhaseClock *const clock)
+{
+#ifdef TARGUM_LEXER_TIMING
+	const uint64_t now = _ticks();
+	if( clock->phase < TargumPhase_Count )
+		lexer->stats.phase_ticks[clock->phase] += now - clock->start;
+	clock->start = now;
+	lexer->stats.timed = true;
+#else
+	( void )lexer;
+#endif
+	clock->phase = TargumPhase_Count;
+}
+
+/// finds where lexing can pick up again after a bad token that began at `start`.
+static NO_NULL const char *_resync_point(const char start[static 1], const enum TargumDiagKind kind)
+{
+	const char *iter = start;
+	switch( kind ) {
+		case TargumDiag_InvalidNumber:
+			/// skip the rest of the malformed literal, suffixes and all.
+			while( *iter != 0 && (is_possible_id(*iter) || *iter=='.') )
+				iter++;
+			break;
+		case TargumDiag_InvalidString: case TargumDiag_InvalidRune: {
+			/// stop at the closing quote or, if it's missing, at the end of the line.
+			const int32_t quote = *iter++;
+			while( *iter != 0 && *iter != '\n' && *iter != quote )
+				iter += ( *iter=='\\' && iter[1] != 0 && iter[1] != '\n' ) ? 2 : 1;
+			if( *iter==quote )
+				iter++;
+			break;
+		}
+		case TargumDiag_InvalidComment:
+			while( *iter != 0 && *iter != '\n' )
+				iter++;
+			break;
+		case TargumDiag_UnknownOperator: {
+			/// skip the entire (possibly multi-byte) glyph.
+			const size_t glyph_len = get_utf8_len(*iter);
+			for( size_t i=0; *iter != 0 && i < (glyph_len==0 ? 1 : glyph_len); i++ )
+				iter++;
+			break;
+		}
+	}
+	return( iter==start && *iter != 0 ) ? iter + 1 : iter;
+}
+
+/// records a diagnostic + an error token covering the bad span, then resyncs the lexer past it.
+TARGUM_API void targum_lexer_recover_error(struct TargumLexer *const restrict lexer, const char start[restrict static 1], const enum TargumDiagKind kind, const uint32_t err_tag)
+{
+	const struct HarbolAllocator *const prev = harbol_allocator_swap(lexer->allocator);
+	const char *const resync = _resync_point(start, kind);
+	struct TargumDiagnostic diag = {
+		.start = (uintptr_t)(start - harbol_string_cstr(&lexer->src)),
+		.end = (uintptr_t)(resync - harbol_string_cstr(&lexer->src)),
+		.line = lexer->line,
+		.col = (uintptr_t)(start - lexer->line_start),
+		.kind = kind
+	};
+	harbol_vector_push_TargumDiagnostic(&lexer->diags, &diag);
+	
+	struct TargumTokenInfo tok = {
+		.start = diag.start,
+		.end = diag.end,
+		.line = diag.line,
+		.col = diag.col,
+		.filename = &lexer->filename,
+		.tag = err_tag
+	};
+	tok.lexeme = targum_lexer_store_lexeme(lexer, start, diag.end - diag.start);
+	_push_token(lexer, &tok);
+	_count_token(lexer, TargumStat_Error, diag.end - diag.start);
+	lexer->iter = ( char* )resync;
+	harbol_allocator_swap(prev);
+}
+
+static NO_NULL bool _generate_tokens(struct TargumLexer *const lexer)
 {
-	bool result = false;
-	if( harbol_string_is_empty(&lexer->src) ) {
-		targum_err(lexer->filename.cstr, "critical error", 1, 0, "No source file loaded! Failed to generate tokens.");
+	bool result = false, cacheable = false;
+	const size_t diag_count = lexer->diags.count, first_token = lexer->tokens.count;
+	size_t token_count = 0;
+	struct TargumCacheKey cache_key = {0};
+	struct TargumPhaseClock clock = { .phase = TargumPhase_Count };
+	const char *const src = harbol_string_cstr(&lexer->src);
+	if( lexer->scanner != NULL ) {
+		return lexer->scanner->generate(lexer);
+	} else if( harbol_string_is_empty(&lexer->src) ) {
+		targum_err(harbol_string_cstr(&lexer->filename), "critical error", 1, 0, "No source file loaded! Failed to generate tokens.");
 		goto targum_lex_err_exit;
-	} else if( lexer->cfg==NULL ) {
-		targum_err(lexer->filename.cstr, "critical error", 1, 0, "No config loaded! Failed to generate tokens.");
+	} else if( lexer->cfg==NULL && !targum_tables_is_loaded(&lexer->tables) ) {
+		targum_err(harbol_string_cstr(&lexer->filename), "critical error", 1, 0, "No config loaded! Failed to generate tokens.");
 		goto targum_lex_err_exit;
 	} else {
-		struct HarbolLinkMap *const tokens = harbol_cfg_get_section(lexer->cfg, "tokens");
-		if( tokens==NULL ) {
-			targum_err(lexer->filename.cstr, "critical error", 1, 0, "missing tokens section in config file/string! Failed to generate tokens.");
-			goto targum_lex_err_exit;
-		}
-		struct HarbolLinkMap
-			*const whitespace = harbol_cfg_get_section(tokens, "whitespace"),
-			*const comments = harbol_cfg_get_section(tokens, "comments"),
-			*const keywords = harbol_cfg_get_section(tokens, "keywords"),
-			*const operators = harbol_cfg_get_section(tokens, "operators")
-		;
-		const bool golang_style = *harbol_cfg_get_bool(tokens, "use golang-style");
-		const size_t max_toks = ( size_t ) *harbol_cfg_get_int(tokens, "on demand");
-		if( keywords==NULL && operators==NULL ) {
-			targum_err(lexer->filename.cstr, "critical error", 1, 0, "Missing both keywords and operators sections in config file/string! Either have a keyword or operator section. Failed to generate tokens.");
-			goto targum_lex_err_exit;
+		if( !targum_tables_is_loaded(&lexer->tables) ) {
+			if( harbol_cfg_get_section(lexer->cfg, "tokens")==NULL ) {
+				targum_err(harbol_string_cstr(&lexer->filename), "critical error", 1, 0, "missing tokens section in config file/string! Failed to generate tokens.");
+				goto targum_lex_err_exit;
+			} else if( !targum_tables_compile(&lexer->tables, lexer->cfg) ) {
+				targum_err(harbol_string_cstr(&lexer->filename), "critical error", 1, 0, "Missing both keywords and operators sections in config file/string! Either have a keyword or operator section. Failed to generate tokens.");
+				goto targum_lex_err_exit;
+			}
 		}
+		const struct TargumTables *const tables = &lexer->tables;
+		const bool golang_style = targum_tables_has(tables, TargumTablesFlag_GolangStyle);
+		const size_t max_toks = targum_tables_on_demand(tables);
+		const bool recover_errors = targum_tables_has(tables, TargumTablesFlag_ErrorRecovery);
+		const uint32_t err_tag = targum_tables_tag(tables, TargumTag_Error);
+		
+		/// only whole-file lexes are cached, on-demand lexing hands out partial token streams.
+		cacheable = !harbol_string_is_empty(&lexer->cache_dir) && max_toks==0
+				&& lexer->iter==src && lexer->tokens.count==0
+				&& targum_cache_make_key(lexer, &cache_key);
+		if( cacheable && targum_cache_load(lexer, &cache_key) )
+			return lexer->tokens.count > 1;
 		
-		size_t token_count = 0;
 		while( *lexer->iter != 0 ) {
+			_tick_phase(lexer, &clock);
 			if( max_toks > 0 && token_count >= max_toks )
-				return true;
+				return lexer->diags.count==diag_count && lexer->tokens.count - first_token==token_count;
 			/// check white space if they're considered legit tokens.
 			else if( is_whitespace(*lexer->iter) ) {
+				clock.phase = TargumPhase_Whitespace;
+				/// the token's position is the char's own, a newline belongs to the line it ends.
+				const size_t ws_line = lexer->line, ws_col = (uintptr_t)(lexer->iter - lexer->line_start);
 				const int32_t s = *lexer->iter++;
 				if( s=='\n' ) {
 					lexer->line++;
 					lexer->line_start = lexer->iter;
 				}
 				
-				if( whitespace != NULL ) {
-					const char *restrict whitespace_key = NULL;
-					switch( s ) {
-						case ' ' : whitespace_key = "space";   break;
-						case '\t': whitespace_key = "tab";     break;
-						case '\n': whitespace_key = "newline"; break;
-					}
-					intmax_t *token_value = harbol_cfg_get_int(whitespace, whitespace_key);
-					if( token_value != NULL ) {
-						struct TargumTokenInfo tok = {
-							.start = (uintptr_t)(lexer->iter - lexer->src.cstr),
-							.end = (uintptr_t)(lexer->iter - lexer->src.cstr + 1),
-							.col = (uintptr_t)(lexer->iter - lexer->line_start),
-							.line = lexer->line,
-							.filename = &lexer->filename,
-							.tag = *token_value
-						};
-						harbol_string_add_char(&tok.lexeme, s);
-						harbol_vector_insert(&lexer->tokens, &tok);
-						token_count++;
+				enum TargumTag ws_tag = TargumTag_Count;
+				switch( s ) {
+					case ' ' : if( targum_tables_has(tables, TargumTablesFlag_HasSpace) )   ws_tag = TargumTag_Space;   break;
+					case '\t': if( targum_tables_has(tables, TargumTablesFlag_HasTab) )     ws_tag = TargumTag_Tab;     break;
+					case '\n': if( targum_tables_has(tables, TargumTablesFlag_HasNewline) ) ws_tag = TargumTag_Newline; break;
+				}
+				if( ws_tag != TargumTag_Count ) {
+					/// built straight in its slot, a failed grow or lexeme copy shows up in the token count check at the end.
+					struct TargumTokenInfo *const tok = harbol_seg_vector_emplace_TargumTokenInfo(&lexer->tokens);
+					if( tok != NULL ) {
+						/// `iter` is already past the whitespace char.
+						tok->start = (uintptr_t)(lexer->iter - 1 - src);
+						tok->end = (uintptr_t)(lexer->iter - src);
+						tok->col = ws_col;
+						tok->line = ws_line;
+						tok->filename = &lexer->filename;
+						tok->tag = targum_tables_tag(tables, ws_tag);
+						tok->lexeme = targum_lexer_store_lexeme(lexer, lexer->iter - 1, 1);
+						if( harbol_string_cstr(&tok->lexeme)==NULL )
+							harbol_seg_vector_truncate_TargumTokenInfo(&lexer->tokens, lexer->tokens.count - 1);
 					}
+					_count_token(lexer, TargumStat_Whitespace, 1);
+					token_count++;
 				}
 				continue;
 			} else if( is_alphabetic(*lexer->iter) ) {
+				clock.phase = TargumPhase_Identifiers;
 				/// check identifiers or keywords.
 				struct TargumTokenInfo tok = {
-					.start = (uintptr_t)(lexer->iter - lexer->src.cstr),
+					.start = (uintptr_t)(lexer->iter - src),
 					.col = (uintptr_t)(lexer->iter - lexer->line_start),
 					.line = lexer->line,
 					.filename = &lexer->filename,
 				};
 				while( *lexer->iter != 0 && is_possible_id(*lexer->iter) )
-					harbol_string_add_char(&tok.lexeme, *lexer->iter++);
+					lexer->iter++;
 				
-				tok.end = (uintptr_t)(lexer->iter - lexer->src.cstr);
+				tok.end = (uintptr_t)(lexer->iter - src);
+				tok.lexeme = targum_lexer_store_lexeme(lexer, src + tok.start, tok.end - tok.start);
 				
 				/// check if we got a keyword or identifier.
-				intmax_t *const keyword = harbol_cfg_get_int(keywords, tok.lexeme.cstr);
-				tok.tag = ( keyword != NULL ) ? *keyword : *harbol_cfg_get_int(tokens, "identifier");
-				harbol_vector_insert(&lexer->tokens, &tok);
+				const bool is_keyword = targum_tables_keyword(tables, src + tok.start, tok.end - tok.start, &tok.tag);
+				if( !is_keyword )
+					tok.tag = targum_tables_tag(tables, TargumTag_Identifier);
+				_push_token(lexer, &tok);
+				_count_token(lexer, is_keyword ? TargumStat_Keyword : TargumStat_Identifier, tok.end - tok.start);
 				token_count++;
 			} else if( is_decimal(*lexer->iter) || *lexer->iter=='.' ) {
 				const bool dot = *lexer->iter=='.';
+				clock.phase = TargumPhase_Numbers;
 				/// Check number literal.
 				struct TargumTokenInfo tok = {
-					.start = (uintptr_t)(lexer->iter - lexer->src.cstr),
+					.start = (uintptr_t)(lexer->iter - src),
 					.col = (uintptr_t)(lexer->iter - lexer->line_start),
 					.line = lexer->line,
 					.filename = &lexer->filename
 				};
 				bool is_float = false;
 				char *end = NULL;
-				const bool result = (golang_style ? lex_go_style_number : lex_c_style_number)(( const char* )lexer->iter, ( const char** )&end, &tok.lexeme, &is_float);
+				const bool result = (golang_style ? lex_go_style_number : lex_c_style_number)(( const char* )lexer->iter, ( const char** )&end, &lexer->scratch, &is_float);
 				if( (!result && !dot) ) {
-					targum_err(lexer->filename.cstr, "error", lexer->line, (uintptr_t)(lexer->iter - lexer->line_start), "invalid number!");
-					harbol_string_clear(&tok.lexeme);
-					goto targum_lex_err_exit;
+					targum_err(harbol_string_cstr(&lexer->filename), "error", lexer->line, (uintptr_t)(lexer->iter - lexer->line_start), "invalid number!");
+					harbol_string_reset(&lexer->scratch);
+					if( !recover_errors )
+						goto targum_lex_err_exit;
+					targum_lexer_recover_error(lexer, lexer->iter, TargumDiag_InvalidNumber, err_tag);
+					token_count++;
 				} else if( !result && dot ) {
 					/// invalid number, jump to the operators section.
-					harbol_string_clear(&tok.lexeme);
+					harbol_string_reset(&lexer->scratch);
 					goto check_operators;
 				} else {
 					lexer->iter = end;
-					tok.end = (uintptr_t)(lexer->iter - lexer->src.cstr);
-					tok.tag = is_float ? *harbol_cfg_get_int(tokens, "float") : *harbol_cfg_get_int(tokens, "integer");
-					harbol_vector_insert(&lexer->tokens, &tok);
+					tok.end = (uintptr_t)(lexer->iter - src);
+					tok.tag = targum_tables_tag(tables, is_float ? TargumTag_Float : TargumTag_Integer);
+					tok.lexeme = _store_scratch(lexer);
+					_push_token(lexer, &tok);
+					_count_token(lexer, is_float ? TargumStat_Float : TargumStat_Integer, tok.end - tok.start);
 					token_count++;
 				}
 			} else {
 			check_operators:;
 				/// check operators and comments!
-				if( comments != NULL ) {
-					bool got_something = false;
-					const struct HarbolKeyVal **const end = harbol_linkmap_get_iter_end_count(comments);
-					for( const struct HarbolKeyVal **iter = harbol_linkmap_get_iter(comments); iter != NULL && iter<end; iter++ ) {
-						/// Match largest operator first.
-						const struct HarbolKeyVal *const kv = *iter;
-						if( !strncmp(lexer->iter, kv->key.cstr, kv->key.len) ) {
-							struct TargumTokenInfo tok = {
-								.start = (uintptr_t)(lexer->iter - lexer->src.cstr),
-								.col = (uintptr_t)(lexer->iter - lexer->line_start),
-								.line = lexer->line,
-								.filename = &lexer->filename
-							};
-							tok.tag = *harbol_cfg_get_int(tokens, "comment");
-							const struct HarbolString *const end_comment = harbol_cfg_get_str(comments, kv->key.cstr);
-							const bool result = ( end_comment==NULL || end_comment->len==0 )
-									? lex_single_line_comment(( const char* )lexer->iter, ( const char** )&lexer->iter, &tok.lexeme)
-									: lex_multi_line_comment(( const char* )lexer->iter, ( const char** )&lexer->iter, end_comment->cstr, end_comment->len, &tok.lexeme);
-							if( !result ) {
-								targum_err(lexer->filename.cstr, "error", lexer->line, (uintptr_t)(lexer->iter - lexer->line_start), "invalid %s comment!", ( end_comment==NULL || end_comment->len==0 ) ? "single-line" : "multi-line");
-								harbol_string_clear(&tok.lexeme);
-								goto targum_lex_err_exit;
-							}
-							tok.end = (uintptr_t)(lexer->iter - lexer->src.cstr);
-							harbol_vector_insert(&lexer->tokens, &tok);
-							token_count++;
-							got_something = true;
-							break;
-						}
+				const struct TargumCommentRule *const comment = targum_tables_comment(tables, lexer->iter);
+				if( comment != NULL ) {
+					clock.phase = TargumPhase_Comments;
+					struct TargumTokenInfo tok = {
+						.start = (uintptr_t)(lexer->iter - src),
+						.col = (uintptr_t)(lexer->iter - lexer->line_start),
+						.line = lexer->line,
+						.filename = &lexer->filename,
+						.tag = targum_tables_tag(tables, TargumTag_Comment)
+					};
+					const bool single_line = comment->end_len==0;
+					const bool result = single_line
+							? lex_single_line_comment(( const char* )lexer->iter, ( const char** )&lexer->iter, &lexer->scratch)
+							: lex_multi_line_comment(( const char* )lexer->iter, ( const char** )&lexer->iter, targum_tables_str(tables, comment->end_off), comment->end_len, &lexer->scratch);
+					if( !result ) {
+						targum_err(harbol_string_cstr(&lexer->filename), "error", lexer->line, (uintptr_t)(lexer->iter - lexer->line_start), "invalid %s comment!", single_line ? "single-line" : "multi-line");
+						harbol_string_reset(&lexer->scratch);
+						if( !recover_errors )
+							goto targum_lex_err_exit;
+						targum_lexer_recover_error(lexer, src + tok.start, TargumDiag_InvalidComment, err_tag);
+					} else {
+						tok.end = (uintptr_t)(lexer->iter - src);
+						tok.lexeme = _store_scratch(lexer);
+						_push_token(lexer, &tok);
+						_count_token(lexer, TargumStat_Comment, tok.end - tok.start);
 					}
-					if( got_something )
-						continue;
+					token_count++;
+					continue;
 				}
 				
 				/// placing this code here so we don't glitch out "string-like" comments.
 				if( *lexer->iter=='\'' || *lexer->iter=='"' || (golang_style && *lexer->iter=='`') ) {
 					/// check strings!
+					clock.phase = TargumPhase_Strings;
 					const int32_t quote = *lexer->iter;
 					struct TargumTokenInfo tok = {
-						.start = (uintptr_t)(lexer->iter - lexer->src.cstr),
+						.start = (uintptr_t)(lexer->iter - src),
 						.col = (uintptr_t)(lexer->iter - lexer->line_start),
 						.line = lexer->line,
 						.filename = &lexer->filename
 					};
-					const bool result = (golang_style ? lex_go_style_str : lex_c_style_str)(( const char* )lexer->iter, ( const char** )&lexer->iter, &tok.lexeme);
+					const bool is_str = quote=='"' || (golang_style && quote=='`');
+					const bool result = (golang_style ? lex_go_style_str : lex_c_style_str)(( const char* )lexer->iter, ( const char** )&lexer->iter, &lexer->scratch);
 					if( !result ) {
-						targum_err(lexer->filename.cstr, "error", lexer->line, (uintptr_t)(lexer->iter - lexer->line_start), (quote=='"' || (golang_style && quote=='`')) ? "invalid string!" : "invalid rune");
-						harbol_string_clear(&tok.lexeme);
-						goto targum_lex_err_exit;
+						targum_err(harbol_string_cstr(&lexer->filename), "error", lexer->line, (uintptr_t)(lexer->iter - lexer->line_start), is_str ? "invalid string!" : "invalid rune");
+						harbol_string_reset(&lexer->scratch);
+						if( !recover_errors )
+							goto targum_lex_err_exit;
+						targum_lexer_recover_error(lexer, src + tok.start, is_str ? TargumDiag_InvalidString : TargumDiag_InvalidRune, err_tag);
+						token_count++;
+						continue;
 					}
-					tok.end = (uintptr_t)(lexer->iter - lexer->src.cstr);
-					tok.tag = (quote=='"' || (golang_style && quote=='`')) ? *harbol_cfg_get_int(tokens, "string") : *harbol_cfg_get_int(tokens, "rune");
-					harbol_vector_insert(&lexer->tokens, &tok);
+					tok.end = (uintptr_t)(lexer->iter - src);
+					tok.tag = targum_tables_tag(tables, is_str ? TargumTag_String : TargumTag_Rune);
+					tok.lexeme = _store_scratch(lexer);
+					_push_token(lexer, &tok);
+					_count_token(lexer, is_str ? TargumStat_String : TargumStat_Rune, tok.end - tok.start);
 					token_count++;
 					continue;
 				}
 				
-				if( operators != NULL ) {
-					size_t operator_size = 0;
-					const struct HarbolKeyVal *match = NULL;
-					const struct HarbolKeyVal **const end = harbol_linkmap_get_iter_end_count(operators);
-					for( const struct HarbolKeyVal **iter = harbol_linkmap_get_iter(operators); iter != NULL && iter < end; iter++ ) {
-						/// Match largest operator first.
-						const struct HarbolKeyVal *const kv = *iter;
-						if( !strncmp(lexer->iter, kv->key.cstr, kv->key.len) && operator_size < kv->key.len ) {
-							operator_size = kv->key.len;
-							match = kv;
-						}
-					}
-					if( match != NULL ) {
-						struct TargumTokenInfo tok = {
-							.start = (uintptr_t)(lexer->iter - lexer->src.cstr),
-							.col = (uintptr_t)(lexer->iter - lexer->line_start),
-							.line = lexer->line,
-							.filename = &lexer->filename,
-						};
-						const struct HarbolVariant *const v = ( const struct HarbolVariant* )match->data;
-						tok.tag = *( const intmax_t* )v->data;
-						harbol_string_add_str(&tok.lexeme, &match->key);
-						lexer->iter += operator_size;
-						tok.end = (uintptr_t)(lexer->iter - lexer->src.cstr);
-						harbol_vector_insert(&lexer->tokens, &tok);
-						token_count++;
-					} else {
-						targum_err(lexer->filename.cstr, "error", lexer->line, (uintptr_t)(lexer->iter - lexer->line_start), "found no match for symbol(s) '%c' (%u) in operators section.", *lexer->iter, *lexer->iter);
+				/// the operator trie hands back the longest match.
+				clock.phase = TargumPhase_Operators;
+				lexer->stats.operator_attempts++;
+				uint32_t operator_tag = 0;
+				const size_t operator_size = targum_tables_operator(tables, lexer->iter, &operator_tag);
+				if( operator_size > 0 ) {
+					struct TargumTokenInfo tok = {
+						.start = (uintptr_t)(lexer->iter - src),
+						.col = (uintptr_t)(lexer->iter - lexer->line_start),
+						.line = lexer->line,
+						.filename = &lexer->filename,
+						.tag = operator_tag
+					};
+					tok.lexeme = targum_lexer_store_lexeme(lexer, lexer->iter, operator_size);
+					lexer->iter += operator_size;
+					tok.end = (uintptr_t)(lexer->iter - src);
+					_push_token(lexer, &tok);
+					_count_token(lexer, TargumStat_Operator, operator_size);
+					token_count++;
+				} else {
+					targum_err(harbol_string_cstr(&lexer->filename), "error", lexer->line, (uintptr_t)(lexer->iter - lexer->line_start), "found no match for symbol(s) '%c' (%u) in operators section.", *lexer->iter, *lexer->iter);
+					if( !recover_errors )
 						goto targum_lex_err_exit;
-					}
+					targum_lexer_recover_error(lexer, lexer->iter, TargumDiag_UnknownOperator, err_tag);
+					token_count++;
 				}
 			}
 		}
 	}
-	result = true;
+	result = lexer->diags.count==diag_count;
 targum_lex_err_exit:;
+	_tick_phase(lexer, &clock);
+	/// a token the allocator had no room for fails the run like a lexing error.
+	if( lexer->tokens.count - first_token != token_count )
+		result = false;
 	struct TargumTokenInfo eof_tok = {
-		.start = (uintptr_t)(lexer->iter - lexer->src.cstr),
+		.start = (uintptr_t)(lexer->iter - src),
 		.col = (uintptr_t)(lexer->iter - lexer->line_start),
-		.end = (uintptr_t)(lexer->iter - lexer->src.cstr),
+		.end = (uintptr_t)(lexer->iter - src),
 		.line = lexer->line,
 		.filename = &lexer->filename,
-		.lexeme = harbol_string_create(""),
+		.lexeme = targum_lexer_store_lexeme(lexer, "", 0),
 		.tag = 0
 	};
-	harbol_vector_insert(&lexer->tokens, &eof_tok);
-	return lexer->tokens.count > 1 && result;
+	result &= _push_token(lexer, &eof_tok);
+	/// only runs that succeed get cached, so a cache hit can return the same thing the miss did.
+	result = result && lexer->tokens.count > 1;
+	if( cacheable && result )
+		targum_cache_store(lexer, &cache_key);
+	return result;
+}
+
+TARGUM_API bool targum_lexer_generate_tokens(struct TargumLexer *const lexer)
+{
+	/// everything lexing allocates has to come from the allocator the lexer was created with.
+	const struct HarbolAllocator *const prev = harbol_allocator_swap(lexer->allocator);
+	const bool result = _generate_tokens(lexer);
+	harbol_allocator_swap(prev);
+	return result;
 }
 
 TARGUM_API bool targum_lexer_remove_token(struct TargumLexer *const lexer, const uint32_t tag)
 {
-	bool deleted_something = false;
+	/// one pass sliding the kept tokens down over the removed ones.
+	size_t kept = 0;
 	for( uindex_t i=0; i<lexer->tokens.count; i++ ) {
-		struct TargumTokenInfo *const ti = harbol_vector_get(&lexer->tokens, i);
-		if( ti->tag==tag ) {
-			harbol_vector_del(&lexer->tokens, i, clear_token);
-			i = 0;
-			deleted_something |= true;
-			continue;
-		}
+		const struct TargumTokenInfo *const tok = harbol_seg_vector_get_TargumTokenInfo(&lexer->tokens, i);
+		if( tok->tag != tag )
+			*harbol_seg_vector_get_TargumTokenInfo(&lexer->tokens, kept++) = *tok;
 	}
+	
+	const bool deleted_something = kept < lexer->tokens.count;
+	harbol_seg_vector_truncate_TargumTokenInfo(&lexer->tokens, kept);
 	return deleted_something;
 }
 
 TARGUM_API bool targum_lexer_remove_comments(struct TargumLexer *const lexer)
 {
-	if( lexer->tokens.count <= 1 || lexer->cfg==NULL ) {
+	if( lexer->tokens.count <= 1 || !_lexer_has(lexer, TargumTablesFlag_HasComment) ) {
 		return false;
 	} else {
-		const intmax_t *const value_ptr = harbol_cfg_get_int(lexer->cfg, "tokens.comment");
-		return( value_ptr==NULL ) ? false : targum_lexer_remove_token(lexer, *value_ptr);
+		return targum_lexer_remove_token(lexer, _lexer_tag(lexer, TargumTag_Comment));
 	}
 }
 
 TARGUM_API bool targum_lexer_remove_whitespace(struct TargumLexer *const lexer)
 {
 	bool deleted_something = false;
-	if( lexer->tokens.count <= 1 || lexer->cfg==NULL ) {
+	if( lexer->tokens.count <= 1 ) {
 		return deleted_something;
 	} else {
-		struct HarbolLinkMap *const whitespace = harbol_cfg_get_section(lexer->cfg, "tokens.whitespace");
-		if( whitespace==NULL ) {
-			return deleted_something;
-		} else {
-			const intmax_t *whitespaces[] = {
-				harbol_cfg_get_int(whitespace, "space"),
-				harbol_cfg_get_int(whitespace, "tab"),
-				harbol_cfg_get_int(whitespace, "newline")
-			};
-			for( const intmax_t **iter=&whitespaces[0]; iter<1[&whitespaces]; iter++ ) {
-				if( *iter==NULL )
-					continue;
-				else deleted_something = targum_lexer_remove_token(lexer, **iter);
-			}
-			return deleted_something;
+		const enum TargumTablesFlag ws_flags[] = { TargumTablesFlag_HasSpace, TargumTablesFlag_HasTab, TargumTablesFlag_HasNewline };
+		for( size_t i=0; i<sizeof ws_flags / sizeof ws_flags[0]; i++ ) {
+			if( !_lexer_has(lexer, ws_flags[i]) )
+				continue;
+			else deleted_something = targum_lexer_remove_token(lexer, _lexer_tag(lexer, TargumTag_Space + i));
 		}
+		return deleted_something;
+	}
+}
+
+TARGUM_API size_t targum_lexer_get_diagnostic_count(const struct TargumLexer *const lexer)
+{
+	return lexer->diags.count;
+}
+
+TARGUM_API const struct TargumDiagnostic *targum_lexer_get_diagnostic(const struct TargumLexer *const lexer, const size_t index)
+{
+	return harbol_vector_get_TargumDiagnostic(&lexer->diags, index);
+}
+
+TARGUM_API const char *targum_diag_kind_to_cstr(const enum TargumDiagKind kind)
+{
+	switch( kind ) {
+		case TargumDiag_InvalidNumber:   return "invalid number";
+		case TargumDiag_InvalidString:   return "invalid string";
+		case TargumDiag_InvalidRune:     return "invalid rune";
+		case TargumDiag_InvalidComment:  return "invalid comment";
+		case TargumDiag_UnknownOperator: return "unknown operator";
+	}
+	return "unknown diagnostic";
+}
+
+TARGUM_API const struct TargumLexerStats *targum_lexer_get_stats(const struct TargumLexer *const lexer)
+{
+	return &lexer->stats;
+}
+
+TARGUM_API void targum_lexer_reset_stats(struct TargumLexer *const lexer)
+{
+	memset(&lexer->stats, 0, sizeof lexer->stats);
+}
+
+TARGUM_API const char *targum_stat_kind_to_cstr(const enum TargumStatKind kind)
+{
+	switch( kind ) {
+		case TargumStat_Identifier: return "identifier";
+		case TargumStat_Keyword:    return "keyword";
+		case TargumStat_Integer:    return "integer";
+		case TargumStat_Float:      return "float";
+		case TargumStat_String:     return "string";
+		case TargumStat_Rune:       return "rune";
+		case TargumStat_Comment:    return "comment";
+		case TargumStat_Operator:   return "operator";
+		case TargumStat_Whitespace: return "whitespace";
+		case TargumStat_Error:      return "error";
+		case TargumStat_Count:      break;
+	}
+	return "unknown stat";
+}
+
+TARGUM_API const char *targum_phase_to_cstr(const enum TargumPhase phase)
+{
+	switch( phase ) {
+		case TargumPhase_Identifiers: return "identifiers";
+		case TargumPhase_Numbers:     return "numbers";
+		case TargumPhase_Strings:     return "strings";
+		case TargumPhase_Comments:    return "comments";
+		case TargumPhase_Operators:   return "operators";
+		case TargumPhase_Whitespace:  return "whitespace";
+		case TargumPhase_Count:       break;
 	}
+	return "unknown phase";
 }
@@ -6,8 +6,11 @@ extern "C" {
 #endif
 
 #include "targum_err.h"
+#include "alloc/alloc.h"
+#include "arena/arena.h"
 #include "linkmap/linkmap.h"
 #include "cfg/cfg.h"
+#include "targum_tables.h"
 
 #define TARGUM_LEXER_VERSION_MAJOR    1
 #define TARGUM_LEXER_VERSION_MINOR    0
@@ -40,6 +43,14 @@ struct TargumTokenInfo {
 	uint32_t tag;
 };
 
+#ifndef TARGUM_TOKEN_BLOCK_SHIFT
+#	define TARGUM_TOKEN_BLOCK_SHIFT    8   /// 256 tokens a block.
+#endif
+
+/// the token stream, `struct TargumTokenInfoSegVector` with its `harbol_seg_vector_*_TargumTokenInfo` functions.
+/// tokens never move as the stream grows, a token pointer stays good until the tokens are cleared.
+HARBOL_SEG_VECTOR_DEFINE(TargumTokenInfo, TARGUM_TOKEN_BLOCK_SHIFT)
+
 TARGUM_API NO_NULL void targum_token_info_clear(struct TargumTokenInfo *tokinfo);
 
 TARGUM_API NO_NULL const char *targum_token_info_get_lexeme(const struct TargumTokenInfo *tokinfo);
@@ -47,13 +58,90 @@ TARGUM_API NO_NULL const char *targum_token_info_get_filename(const struct Targu
 TARGUM_API NO_NULL uint32_t targum_token_info_get_token(const struct TargumTokenInfo *tokinfo);
 
 
+enum TargumDiagKind {
+	TargumDiag_InvalidNumber,
+	TargumDiag_InvalidString,
+	TargumDiag_InvalidRune,
+	TargumDiag_InvalidComment,
+	TargumDiag_UnknownOperator,
+};
+
+struct TargumDiagnostic {
+	size_t
+		start,  /// start offset of the bad span.
+		end,    /// end offset of the bad span.
+		line,   /// line in source code.
+		col     /// column in source code.
+	;
+	enum TargumDiagKind kind;
+};
+
+/// diagnostics of a run, `struct TargumDiagnosticVector` with its `harbol_vector_*_TargumDiagnostic` functions.
+HARBOL_VECTOR_DEFINE(TargumDiagnostic)
+
+
+/// uncomment (or build the library with -DTARGUM_LEXER_TIMING) to time each lexing phase.
+//#define TARGUM_LEXER_TIMING
+
+enum TargumStatKind {
+	TargumStat_Identifier,
+	TargumStat_Keyword,
+	TargumStat_Integer,
+	TargumStat_Float,
+	TargumStat_String,
+	TargumStat_Rune,
+	TargumStat_Comment,
+	TargumStat_Operator,
+	TargumStat_Whitespace,
+	TargumStat_Error,
+	TargumStat_Count
+};
+
+enum TargumPhase {
+	TargumPhase_Identifiers,  /// keyword lookups included.
+	TargumPhase_Numbers,
+	TargumPhase_Strings,
+	TargumPhase_Comments,
+	TargumPhase_Operators,
+	TargumPhase_Whitespace,
+	TargumPhase_Count
+};
+
+struct TargumLexerStats {
+	size_t
+		tokens[TargumStat_Count],  /// tokens made, per kind.
+		bytes[TargumStat_Count],   /// source bytes those tokens cover, per kind.
+		operator_attempts          /// operator trie lookups, matched or not.
+	;
+	uint64_t phase_ticks[TargumPhase_Count];  /// rdtsc cycles on x86, nanoseconds elsewhere.
+	bool timed;                               /// whether `phase_ticks` was filled in.
+};
+
+
+struct TargumLexer;
+
+/// a scanner compiled in from C source emitted by `targum_gen`, takes over from the config/tables path.
+struct TargumScanner {
+	bool (*generate)(struct TargumLexer *lexer);
+	size_t on_demand;
+	uint32_t flags;                   /// `enum TargumTablesFlag` bits.
+	uint32_t tags[TargumTag_Count];
+};
+
 struct TargumLexer {
-	struct HarbolVector tokens;
-	struct HarbolString filename, src;
+	struct TargumTokenInfoSegVector tokens;
+	struct TargumDiagnosticVector diags;
+	struct HarbolString filename, src, cache_dir;
 	struct HarbolLinkMap *cfg;
+	struct TargumTables tables;
+	const struct TargumScanner *scanner;
 	char *iter, *line_start;
-	size_t line, index;
+	size_t line, index, cache_limit, cache_size;
 	struct TargumTokenInfo *curr_tok;
+	struct TargumLexerStats stats;
+	struct HarbolArena arena;      /// owns every token lexeme.
+	struct HarbolString scratch;   /// decode buffer for literals before they're moved into the arena.
+	const struct HarbolAllocator *allocator;   /// installed whenever the lexer allocates or frees, NULL is the built-in one.
 };
 
 
@@ -63,14 +151,29 @@ TARGUM_API NEVER_NULL(1) struct TargumLexer *targum_lexer_new_from_file(const ch
 TARGUM_API NEVER_NULL(1) struct TargumLexer targum_lexer_create_from_buffer(const char src[], struct HarbolLinkMap *cfg);
 TARGUM_API NEVER_NULL(1) struct TargumLexer targum_lexer_create_from_file(const char filename[], struct HarbolLinkMap *cfg);
 
+/// the lexer, its tokens & any config it loads come from `allocator`.
+TARGUM_API NEVER_NULL(1) struct TargumLexer targum_lexer_create_from_buffer_with_allocator(const char src[], struct HarbolLinkMap *cfg, const struct HarbolAllocator *allocator);
+TARGUM_API NEVER_NULL(1) struct TargumLexer targum_lexer_create_from_file_with_allocator(const char filename[], struct HarbolLinkMap *cfg, const struct HarbolAllocator *allocator);
+
 TARGUM_API NO_NULL void targum_lexer_clear(struct TargumLexer *lexer, bool free_cfg);
 TARGUM_API NO_NULL void targum_lexer_free(struct TargumLexer **lexer_ref, bool free_cfg);
 TARGUM_API NO_NULL void targum_lexer_clear_tokens(struct TargumLexer *lexer);
 
+/// copies a lexeme into the lexer's arena, it stays valid until the tokens are cleared. the string's cstr is NULL if the arena is out of memory.
+TARGUM_API NEVER_NULL(1) struct HarbolString targum_lexer_store_lexeme(struct TargumLexer *lexer, const char str[], size_t len);
+
 TARGUM_API NO_NULL bool targum_lexer_load_cfg_file(struct TargumLexer *lexer, const char cfg_file[]);
 TARGUM_API NO_NULL bool targum_lexer_load_cfg_cstr(struct TargumLexer *lexer, const char cfg_cstr[]);
 TARGUM_API NO_NULL struct HarbolLinkMap *targum_lexer_get_cfg(const struct TargumLexer *lexer);
 
+TARGUM_API NO_NULL bool targum_lexer_load_tables_file(struct TargumLexer *lexer, const char filename[]);
+TARGUM_API NO_NULL bool targum_lexer_save_tables_file(struct TargumLexer *lexer, const char filename[]);
+TARGUM_API NO_NULL const struct TargumTables *targum_lexer_get_tables(struct TargumLexer *lexer);
+
+TARGUM_API NEVER_NULL(1) void targum_lexer_set_scanner(struct TargumLexer *lexer, const struct TargumScanner *scanner);
+
+TARGUM_API NEVER_NULL(1) bool targum_lexer_set_cache_dir(struct TargumLexer *lexer, const char cache_dir[], size_t max_bytes);
+
 TARGUM_API NO_NULL const char *targum_lexer_get_filename(const struct TargumLexer *lexer);
 TARGUM_API NO_NULL size_t targum_lexer_get_token_index(const struct TargumLexer *lexer);
 TARGUM_API NO_NULL size_t targum_lexer_get_token_count(const struct TargumLexer *lexer);
@@ -85,6 +188,16 @@ TARGUM_API NO_NULL bool targum_lexer_remove_token(struct TargumLexer *lexer, uin
 TARGUM_API NO_NULL bool targum_lexer_remove_comments(struct TargumLexer *lexer);
 TARGUM_API NO_NULL bool targum_lexer_remove_whitespace(struct TargumLexer *lexer);
 
+TARGUM_API NO_NULL void targum_lexer_recover_error(struct TargumLexer *lexer, const char start[], enum TargumDiagKind kind, uint32_t err_tag);
+TARGUM_API NO_NULL size_t targum_lexer_get_diagnostic_count(const struct TargumLexer *lexer);
+TARGUM_API NO_NULL const struct TargumDiagnostic *targum_lexer_get_diagnostic(const struct TargumLexer *lexer, size_t index);
+TARGUM_API NO_NULL const char *targum_diag_kind_to_cstr(enum TargumDiagKind kind);
+
+TARGUM_API NO_NULL const struct TargumLexerStats *targum_lexer_get_stats(const struct TargumLexer *lexer);
+TARGUM_API NO_NULL void targum_lexer_reset_stats(struct TargumLexer *lexer);
+TARGUM_API NO_NULL const char *targum_stat_kind_to_cstr(enum TargumStatKind kind);
+TARGUM_API NO_NULL const char *targum_phase_to_cstr(enum TargumPhase phase);
+
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,465 @@
+#ifndef _POSIX_C_SOURCE
+#	define _POSIX_C_SOURCE 200809L
+#endif
+#define HARBOL_ALLOC_CATEGORY    HarbolAllocCategory_Token
+
+#include "targum_tables.h"
+
+#ifdef OS_WINDOWS
+#	define TARGUM_LIB
+#endif
+
+#if defined(OS_LINUX_UNIX) || defined(OS_MAC)
+#	define TARGUM_TABLES_POSIX
+#	include <sys/types.h>
+#	include <sys/stat.h>
+#	include <sys/mman.h>
+#	include <fcntl.h>
+#	include <unistd.h>
+#endif
+
+static const char _g_tables_magic[8] = "TRGMTBL";
+
+/// sections start on 8-byte boundaries so the mmap'd blob can be read in place.
+#define TARGUM_TABLES_ALIGN(n)    (((n) + 7u) & ~( size_t )7u)
+
+
+static inline uint32_t _hash_keyword(const char str[static 1], const size_t len)
+{
+	return ( uint32_t )bytes_hash64(str, len, TARGUM_TABLES_VERSION);
+}
+
+static NO_NULL intmax_t _get_int_or(struct HarbolLinkMap *const section, const char key[static 1], const intmax_t def)
+{
+	const intmax_t *const i = harbol_cfg_get_int(section, key);
+	return( i != NULL ) ? *i : def;
+}
+
+static NO_NULL bool _get_bool_or(struct HarbolLinkMap *const section, const char key[static 1], const bool def)
+{
+	const bool *const b = harbol_cfg_get_bool(section, key);
+	return( b != NULL ) ? *b : def;
+}
+
+/// counts how many entries of a cfg section hold an int (keywords + operators).
+static size_t _count_int_entries(const struct HarbolLinkMap *const section, size_t *const restrict str_bytes)
+{
+	size_t count = 0;
+	if( section==NULL )
+		return count;
+	for( uindex_t i=0; i<harbol_linkmap_count(section); i++ ) {
+		const struct HarbolVariant *const v = harbol_linkmap_index_get(section, i);
+		const size_t key_len = harbol_linkmap_index_get_key(section, i).len;
+		if( v->tag==HarbolCfgType_Int && key_len > 0 ) {
+			count++;
+			*str_bytes += key_len + 1;
+		}
+	}
+	return count;
+}
+
+static NO_NULL uint32_t _pool_add(uint8_t *const blob, uint32_t *const restrict pool_len, const uint32_t pool_off, const char str[static 1], const size_t len)
+{
+	const uint32_t offset = *pool_len;
+	memcpy(&blob[pool_off + offset], str, len);
+	blob[pool_off + offset + len] = 0;
+	*pool_len += len + 1;
+	return offset;
+}
+
+static NO_NULL void _resolve_sections(struct TargumTables *const tables)
+{
+	const struct TargumTablesHeader *const hdr = ( const struct TargumTablesHeader* )tables->blob;
+	tables->hdr = hdr;
+	tables->pool = ( const char* )&tables->blob[hdr->pool_off];
+	tables->keywords = ( const struct TargumKeywordSlot* )&tables->blob[hdr->kw_off];
+	tables->operators = ( const struct TargumOperatorNode* )&tables->blob[hdr->op_off];
+	tables->comments = ( const struct TargumCommentRule* )&tables->blob[hdr->cmt_off];
+}
+
+TARGUM_API bool targum_tables_compile(struct TargumTables *const restrict tables, struct HarbolLinkMap *const restrict cfg)
+{
+	struct HarbolLinkMap *const tokens = harbol_cfg_get_section(cfg, "tokens");
+	if( tokens==NULL )
+		return false;
+
+	struct HarbolLinkMap
+		*const whitespace = harbol_cfg_get_section(tokens, "whitespace"),
+		*const comments = harbol_cfg_get_section(tokens, "comments"),
+		*const keywords = harbol_cfg_get_section(tokens, "keywords"),
+		*const operators = harbol_cfg_get_section(tokens, "operators")
+	;
+	if( keywords==NULL && operators==NULL )
+		return false;
+
+	/// first pass: size every section so the whole blob is a single allocation.
+	size_t pool_size = 0;
+	const size_t kw_count = _count_int_entries(keywords, &pool_size);
+	size_t op_chars = 0;
+	const size_t op_count = _count_int_entries(operators, &op_chars);
+	const size_t cmt_count = ( comments != NULL ) ? harbol_linkmap_count(comments) : 0;
+	if( comments != NULL ) {
+		for( uindex_t i=0; i<cmt_count; i++ ) {
+			const struct HarbolVariant *const v = harbol_linkmap_index_get(comments, i);
+			pool_size += harbol_linkmap_index_get_key(comments, i).len + 1;
+			if( v->tag==HarbolCfgType_String )
+				pool_size += (*( const struct HarbolString *const* )harbol_variant_get(v))->len + 1;
+		}
+	}
+
+	size_t kw_cap = 0;
+	if( kw_count > 0 ) {
+		/// keep the load factor at or under 1/2 so probes stay short.
+		kw_cap = 8;
+		while( kw_cap < kw_count * 2 )
+			kw_cap <<= 1;
+	}
+	/// worst case every operator character is its own trie node, plus the root.
+	const size_t op_cap = op_chars + 1;
+
+	const size_t pool_off = TARGUM_TABLES_ALIGN(sizeof(struct TargumTablesHeader));
+	const size_t kw_off   = TARGUM_TABLES_ALIGN(pool_off + pool_size);
+	const size_t op_off   = TARGUM_TABLES_ALIGN(kw_off + kw_cap * sizeof(struct TargumKeywordSlot));
+	const size_t cmt_off  = TARGUM_TABLES_ALIGN(op_off + op_cap * sizeof(struct TargumOperatorNode));
+	const size_t max_size = TARGUM_TABLES_ALIGN(cmt_off + cmt_count * sizeof(struct TargumCommentRule));
+	if( max_size > UINT32_MAX )
+		return false;
+
+	uint8_t *restrict blob = harbol_alloc(max_size, sizeof *blob);
+	if( blob==NULL )
+		return false;
+
+	struct TargumTablesHeader *const hdr = ( struct TargumTablesHeader* )blob;
+	memcpy(hdr->magic, _g_tables_magic, sizeof hdr->magic);
+	hdr->version = TARGUM_TABLES_VERSION;
+	hdr->pool_off = pool_off;
+	hdr->kw_off = kw_off;
+	hdr->kw_cap = kw_cap;
+	hdr->op_off = op_off;
+	hdr->cmt_off = cmt_off;
+
+	hdr->flags |= _get_bool_or(tokens, "use golang-style", false) ? TargumTablesFlag_GolangStyle : 0;
+	hdr->flags |= _get_bool_or(tokens, "error recovery", false) ? TargumTablesFlag_ErrorRecovery : 0;
+	hdr->flags |= ( keywords != NULL ) ? TargumTablesFlag_HasKeywords : 0;
+	hdr->flags |= ( operators != NULL ) ? TargumTablesFlag_HasOperators : 0;
+	hdr->flags |= ( comments != NULL ) ? TargumTablesFlag_HasComment : 0;
+	hdr->on_demand = ( uint64_t )_get_int_or(tokens, "on demand", 0);
+
+	hdr->tags[TargumTag_Identifier] = _get_int_or(tokens, "identifier", 0);
+	hdr->tags[TargumTag_Integer]    = _get_int_or(tokens, "integer", 0);
+	hdr->tags[TargumTag_Float]      = _get_int_or(tokens, "float", 0);
+	hdr->tags[TargumTag_String]     = _get_int_or(tokens, "string", 0);
+	hdr->tags[TargumTag_Rune]       = _get_int_or(tokens, "rune", 0);
+	hdr->tags[TargumTag_Comment]    = _get_int_or(tokens, "comment", 0);
+	hdr->tags[TargumTag_Error]      = _get_int_or(tokens, "error", TARGUM_ERROR_TOKEN);
+	if( whitespace != NULL ) {
+		const char *const ws_keys[] = { "space", "tab", "newline" };
+		const enum TargumTablesFlag ws_flags[] = { TargumTablesFlag_HasSpace, TargumTablesFlag_HasTab, TargumTablesFlag_HasNewline };
+		for( size_t i=0; i<3; i++ ) {
+			const intmax_t *const value = harbol_cfg_get_int(whitespace, ws_keys[i]);
+			if( value != NULL ) {
+				hdr->flags |= ws_flags[i];
+				hdr->tags[TargumTag_Space + i] = *value;
+			}
+		}
+	}
+
+	uint32_t pool_len = 0;
+
+	/// keywords: open-addressing hash table with linear probing.
+	if( kw_count > 0 ) {
+		struct TargumKeywordSlot *const slots = ( struct TargumKeywordSlot* )&blob[kw_off];
+		for( uindex_t k=0; k<harbol_linkmap_count(keywords); k++ ) {
+			const struct HarbolStrView key = harbol_linkmap_index_get_key(keywords, k);
+			const struct HarbolVariant *const v = harbol_linkmap_index_get(keywords, k);
+			if( v->tag != HarbolCfgType_Int || key.len==0 )
+				continue;
+			const uint32_t hash = _hash_keyword(key.cstr, key.len);
+			size_t i = hash & (kw_cap - 1);
+			while( slots[i].len != 0 )
+				i = (i + 1) & (kw_cap - 1);
+			slots[i].hash = hash;
+			slots[i].len = key.len;
+			slots[i].tag = *( const intmax_t* )harbol_variant_get(v);
+			slots[i].str_off = _pool_add(blob, &pool_len, pool_off, key.cstr, key.len);
+			hdr->kw_count++;
+		}
+	}
+
+	/// operators: a character trie, children kept as sibling lists.
+	struct TargumOperatorNode *const nodes = ( struct TargumOperatorNode* )&blob[op_off];
+	hdr->op_count = 1;
+	if( op_count > 0 ) {
+		for( uindex_t i=0; i<harbol_linkmap_count(operators); i++ ) {
+			const struct HarbolStrView key = harbol_linkmap_index_get_key(operators, i);
+			const struct HarbolVariant *const v = harbol_linkmap_index_get(operators, i);
+			if( v->tag != HarbolCfgType_Int || key.len==0 )
+				continue;
+			uint32_t node = 0;
+			for( size_t n=0; n<key.len; n++ ) {
+				const uint8_t c = key.cstr[n];
+				uint32_t child = nodes[node].first_child, last = 0;
+				while( child != 0 && nodes[child].chr != c )
+					last = child, child = nodes[child].next_sibling;
+				if( child==0 ) {
+					/// new children go at the end of the sibling list, so every link points to a later node.
+					child = hdr->op_count++;
+					nodes[child].chr = c;
+					if( last==0 )
+						nodes[node].first_child = child;
+					else nodes[last].next_sibling = child;
+				}
+				node = child;
+			}
+			nodes[node].terminal = 1;
+			nodes[node].tag = *( const intmax_t* )harbol_variant_get(v);
+		}
+	}
+
+	/// comments: kept in config order, the first matching opener wins.
+	if( cmt_count > 0 ) {
+		struct TargumCommentRule *const rules = ( struct TargumCommentRule* )&blob[cmt_off];
+		for( uindex_t i=0; i<cmt_count; i++ ) {
+			const struct HarbolStrView key = harbol_linkmap_index_get_key(comments, i);
+			const struct HarbolVariant *const v = harbol_linkmap_index_get(comments, i);
+			struct TargumCommentRule *const rule = &rules[hdr->cmt_count++];
+			rule->begin_len = key.len;
+			rule->begin_off = _pool_add(blob, &pool_len, pool_off, key.cstr, key.len);
+			if( v->tag==HarbolCfgType_String ) {
+				const struct HarbolString *const end_comment = *( const struct HarbolString *const* )harbol_variant_get(v);
+				rule->end_len = end_comment->len;
+				rule->end_off = _pool_add(blob, &pool_len, pool_off, ( harbol_string_cstr(end_comment) != NULL ) ? harbol_string_cstr(end_comment) : "", end_comment->len);
+			}
+		}
+	}
+	hdr->pool_size = pool_len;
+
+	/// trim the unused trie nodes off the end.
+	const size_t size = TARGUM_TABLES_ALIGN(op_off + hdr->op_count * sizeof(struct TargumOperatorNode));
+	if( hdr->cmt_count > 0 ) {
+		memmove(&blob[size], &blob[cmt_off], hdr->cmt_count * sizeof(struct TargumCommentRule));
+		hdr->cmt_off = size;
+	} else {
+		hdr->cmt_off = size;
+	}
+	hdr->size = TARGUM_TABLES_ALIGN(hdr->cmt_off + hdr->cmt_count * sizeof(struct TargumCommentRule));
+
+	targum_tables_clear(tables);
+	tables->blob = blob;
+	tables->size = hdr->size;
+	tables->mapped = false;
+	_resolve_sections(tables);
+	return true;
+}
+
+/// checks a blob before its offsets are trusted.
+static NO_NULL bool _validate_blob(const uint8_t *const blob, const size_t size)
+{
+	if( size < sizeof(struct TargumTablesHeader) )
+		return false;
+
+	const struct TargumTablesHeader *const hdr = ( const struct TargumTablesHeader* )blob;
+	if( memcmp(hdr->magic, _g_tables_magic, sizeof hdr->magic) != 0 || hdr->version != TARGUM_TABLES_VERSION || hdr->size != size )
+		return false;
+
+	const uint32_t offsets[] = { hdr->pool_off, hdr->kw_off, hdr->op_off, hdr->cmt_off };
+	for( size_t i=0; i<sizeof offsets / sizeof offsets[0]; i++ )
+		if( offsets[i] % 8 != 0 || offsets[i] > size )
+			return false;
+
+	if( ( uint64_t )hdr->pool_off + hdr->pool_size > size
+			|| (hdr->kw_cap & (hdr->kw_cap - 1)) != 0 || hdr->kw_count > hdr->kw_cap
+			|| ( uint64_t )hdr->kw_off + ( uint64_t )hdr->kw_cap * sizeof(struct TargumKeywordSlot) > size
+			|| hdr->op_count==0
+			|| ( uint64_t )hdr->op_off + ( uint64_t )hdr->op_count * sizeof(struct TargumOperatorNode) > size
+			|| ( uint64_t )hdr->cmt_off + ( uint64_t )hdr->cmt_count * sizeof(struct TargumCommentRule) > size )
+	{
+		return false;
+	}
+
+	/// every string reference must stay inside the pool, including its NUL.
+	/// keyword probing stops at an empty slot, so there has to be one.
+	const struct TargumKeywordSlot *const slots = ( const struct TargumKeywordSlot* )&blob[hdr->kw_off];
+	size_t used_slots = 0;
+	for( size_t i=0; i<hdr->kw_cap; i++ ) {
+		if( slots[i].len==0 )
+			continue;
+		else if( ( uint64_t )slots[i].str_off + slots[i].len >= hdr->pool_size )
+			return false;
+		used_slots++;
+	}
+	if( used_slots != hdr->kw_count || (hdr->kw_cap > 0 && used_slots >= hdr->kw_cap) )
+		return false;
+
+	/// links only ever point forward, so walking the trie can't loop.
+	const struct TargumOperatorNode *const nodes = ( const struct TargumOperatorNode* )&blob[hdr->op_off];
+	for( size_t i=0; i<hdr->op_count; i++ ) {
+		const uint32_t links[] = { nodes[i].first_child, nodes[i].next_sibling };
+		for( size_t n=0; n<sizeof links / sizeof links[0]; n++ )
+			if( links[n] != 0 && (links[n] <= i || links[n] >= hdr->op_count) )
+				return false;
+	}
+
+	const struct TargumCommentRule *const rules = ( const struct TargumCommentRule* )&blob[hdr->cmt_off];
+	for( size_t i=0; i<hdr->cmt_count; i++ )
+		if( ( uint64_t )rules[i].begin_off + rules[i].begin_len >= hdr->pool_size || ( uint64_t )rules[i].end_off + rules[i].end_len >= hdr->pool_size )
+			return false;
+	return true;
+}
+
+#ifdef TARGUM_TABLES_POSIX
+TARGUM_API bool targum_tables_load_file(struct TargumTables *const restrict tables, const char filename[restrict static 1])
+{
+	const int fd = open(filename, O_RDONLY);
+	if( fd < 0 )
+		return false;
+
+	struct stat st;
+	if( fstat(fd, &st) != 0 || st.st_size <= 0 ) {
+		close(fd);
+		return false;
+	}
+	const size_t filesize = st.st_size;
+	uint8_t *const blob = mmap(NULL, filesize, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if( blob==MAP_FAILED )
+		return false;
+	else if( !_validate_blob(blob, filesize) ) {
+		munmap(blob, filesize);
+		return false;
+	}
+
+	targum_tables_clear(tables);
+	tables->blob = blob;
+	tables->size = filesize;
+	tables->mapped = true;
+	_resolve_sections(tables);
+	return true;
+}
+#else
+TARGUM_API bool targum_tables_load_file(struct TargumTables *const restrict tables, const char filename[restrict static 1])
+{
+	FILE *restrict file = fopen(filename, "rb");
+	if( file==NULL )
+		return false;
+
+	const ssize_t filesize = get_file_size(file);
+	uint8_t *restrict blob = ( filesize > 0 ) ? harbol_alloc(filesize, sizeof *blob) : NULL;
+	const bool read_ok = blob != NULL && fread(blob, sizeof *blob, filesize, file)==( size_t )filesize;
+	fclose(file), file=NULL;
+	if( !read_ok || !_validate_blob(blob, filesize) ) {
+		harbol_free(blob), blob=NULL;
+		return false;
+	}
+
+	targum_tables_clear(tables);
+	tables->blob = blob;
+	tables->size = filesize;
+	tables->mapped = false;
+	_resolve_sections(tables);
+	return true;
+}
+#endif
+
+TARGUM_API bool targum_tables_save_file(const struct TargumTables *const restrict tables, const char filename[restrict static 1])
+{
+	if( tables->blob==NULL )
+		return false;
+
+	FILE *restrict file = fopen(filename, "wb");
+	if( file==NULL )
+		return false;
+
+	const bool written = fwrite(tables->blob, tables->size, 1, file)==1;
+	return( fclose(file)==0 ) && written;
+}
+
+TARGUM_API void targum_tables_clear(struct TargumTables *const tables)
+{
+	if( tables->blob != NULL ) {
+#ifdef TARGUM_TABLES_POSIX
+		if( tables->mapped )
+			munmap(tables->blob, tables->size);
+		else harbol_free(tables->blob);
+#else
+		harbol_free(tables->blob);
+#endif
+	}
+	*tables = ( struct TargumTables ){0};
+}
+
+TARGUM_API bool targum_tables_is_loaded(const struct TargumTables *const tables)
+{
+	return tables->blob != NULL;
+}
+
+
+TARGUM_API bool targum_tables_has(const struct TargumTables *const tables, const enum TargumTablesFlag flag)
+{
+	return (tables->hdr->flags & flag) != 0;
+}
+
+TARGUM_API uint32_t targum_tables_tag(const struct TargumTables *const tables, const enum TargumTag tag)
+{
+	return tables->hdr->tags[tag];
+}
+
+TARGUM_API size_t targum_tables_on_demand(const struct TargumTables *const tables)
+{
+	return tables->hdr->on_demand;
+}
+
+TARGUM_API bool targum_tables_keyword(const struct TargumTables *const restrict tables, const char str[restrict static 1], const size_t len, uint32_t *const restrict tag)
+{
+	const size_t cap = tables->hdr->kw_cap;
+	if( cap==0 || len==0 )
+		return false;
+
+	const uint32_t hash = _hash_keyword(str, len);
+	for( size_t i = hash & (cap - 1);; i = (i + 1) & (cap - 1) ) {
+		const struct TargumKeywordSlot *const slot = &tables->keywords[i];
+		if( slot->len==0 )
+			return false;
+		else if( slot->hash==hash && slot->len==len && !memcmp(&tables->pool[slot->str_off], str, len) ) {
+			*tag = slot->tag;
+			return true;
+		}
+	}
+}
+
+TARGUM_API size_t targum_tables_operator(const struct TargumTables *const restrict tables, const char str[restrict static 1], uint32_t *const restrict tag)
+{
+	/// walk the trie as far as the input goes, remembering the longest terminal.
+	const struct TargumOperatorNode *const nodes = tables->operators;
+	size_t match_len = 0;
+	uint32_t node = 0;
+	for( size_t n=0; str[n] != 0; n++ ) {
+		const uint8_t c = str[n];
+		uint32_t child = nodes[node].first_child;
+		while( child != 0 && nodes[child].chr != c )
+			child = nodes[child].next_sibling;
+		if( child==0 )
+			break;
+		node = child;
+		if( nodes[node].terminal ) {
+			match_len = n + 1;
+			*tag = nodes[node].tag;
+		}
+	}
+	return match_len;
+}
+
+TARGUM_API const struct TargumCommentRule *targum_tables_comment(const struct TargumTables *const restrict tables, const char str[restrict static 1])
+{
+	for( size_t i=0; i<tables->hdr->cmt_count; i++ ) {
+		const struct TargumCommentRule *const rule = &tables->comments[i];
+		if( !strncmp(str, &tables->pool[rule->begin_off], rule->begin_len) )
+			return rule;
+	}
+	return NULL;
+}
+
+TARGUM_API const char *targum_tables_str(const struct TargumTables *const tables, const uint32_t offset)
+{
+	return &tables->pool[offset];
+}
@@ -0,0 +1,106 @@
+#ifndef TARGUM_TABLES_INCLUDED
+#	define TARGUM_TABLES_INCLUDED
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "targum_err.h"
+#include "linkmap/linkmap.h"
+#include "cfg/cfg.h"
+
+#define TARGUM_TABLES_VERSION    2
+
+/// default tag of error tokens if the config has no 'error' token value.
+#define TARGUM_ERROR_TOKEN    UINT32_MAX
+
+enum TargumTablesFlag {
+	TargumTablesFlag_GolangStyle   = 1u << 0u,
+	TargumTablesFlag_ErrorRecovery = 1u << 1u,
+	TargumTablesFlag_HasKeywords   = 1u << 2u,
+	TargumTablesFlag_HasOperators  = 1u << 3u,
+	TargumTablesFlag_HasSpace      = 1u << 4u,
+	TargumTablesFlag_HasTab        = 1u << 5u,
+	TargumTablesFlag_HasNewline    = 1u << 6u,
+	TargumTablesFlag_HasComment    = 1u << 7u,
+};
+
+enum TargumTag {
+	TargumTag_Identifier,
+	TargumTag_Integer,
+	TargumTag_Float,
+	TargumTag_String,
+	TargumTag_Rune,
+	TargumTag_Comment,
+	TargumTag_Error,
+	TargumTag_Space,
+	TargumTag_Tab,
+	TargumTag_Newline,
+	TargumTag_Count
+};
+
+/* Compiled lexer tables blob layout.
+ * Every section is referenced by a byte offset from the start of the blob,
+ * so a blob can be written to disk and mmap'd back as-is.
+ */
+struct TargumTablesHeader {
+	char magic[8];
+	uint32_t version, size, flags;
+	uint32_t tags[TargumTag_Count];
+	uint64_t on_demand;
+	uint32_t pool_off, pool_size;
+	uint32_t kw_off, kw_cap, kw_count;
+	uint32_t op_off, op_count;
+	uint32_t cmt_off, cmt_count;
+};
+
+/// open-addressing slot of the keyword hash table, `len` of 0 marks an empty slot.
+struct TargumKeywordSlot {
+	uint32_t hash, str_off, len, tag;
+};
+
+/// operator trie node, node 0 is the root. child/sibling index of 0 means none.
+struct TargumOperatorNode {
+	uint32_t first_child, next_sibling, tag;
+	uint8_t chr, terminal;
+};
+
+/// comment rule, single-line comments have an `end_len` of 0.
+struct TargumCommentRule {
+	uint32_t begin_off, begin_len, end_off, end_len;
+};
+
+struct TargumTables {
+	uint8_t *blob;
+	size_t size;
+	bool mapped;
+	/// section pointers into `blob`, resolved after compiling or loading.
+	const struct TargumTablesHeader *hdr;
+	const char *pool;
+	const struct TargumKeywordSlot *keywords;
+	const struct TargumOperatorNode *operators;
+	const struct TargumCommentRule *comments;
+};
+
+
+TARGUM_API NO_NULL bool targum_tables_compile(struct TargumTables *tables, struct HarbolLinkMap *cfg);
+TARGUM_API NO_NULL bool targum_tables_load_file(struct TargumTables *tables, const char filename[]);
+TARGUM_API NO_NULL bool targum_tables_save_file(const struct TargumTables *tables, const char filename[]);
+TARGUM_API NO_NULL void targum_tables_clear(struct TargumTables *tables);
+TARGUM_API NO_NULL bool targum_tables_is_loaded(const struct TargumTables *tables);
+
+TARGUM_API NO_NULL bool targum_tables_has(const struct TargumTables *tables, enum TargumTablesFlag flag);
+TARGUM_API NO_NULL uint32_t targum_tables_tag(const struct TargumTables *tables, enum TargumTag tag);
+TARGUM_API NO_NULL size_t targum_tables_on_demand(const struct TargumTables *tables);
+
+TARGUM_API NO_NULL bool targum_tables_keyword(const struct TargumTables *tables, const char str[], size_t len, uint32_t *tag);
+TARGUM_API NO_NULL size_t targum_tables_operator(const struct TargumTables *tables, const char str[], uint32_t *tag);
+TARGUM_API NO_NULL const struct TargumCommentRule *targum_tables_comment(const struct TargumTables *tables, const char str[]);
+TARGUM_API NO_NULL const char *targum_tables_str(const struct TargumTables *tables, uint32_t offset);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /** TARGUM_TABLES_INCLUDED */
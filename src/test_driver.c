@@ -15,12 +15,16 @@ int32_t main(const int32_t argc, char *argv[restrict static 1])
 		assert( targum_lexer_load_cfg_file(&lexer, "tokens.cfg") && "failed to load tokens.cfg!" );
 		const bool result = targum_lexer_generate_tokens(&lexer);
 		printf("tokenization? '%s'\n", result ? "success!" : "failure!");
+		for( size_t i=0; i<targum_lexer_get_diagnostic_count(&lexer); i++ ) {
+			const struct TargumDiagnostic *const diag = targum_lexer_get_diagnostic(&lexer, i);
+			printf("diagnostic: %s at line %zu, col %zu (offsets %zu-%zu)\n", targum_diag_kind_to_cstr(diag->kind), diag->line, diag->col, diag->start, diag->end);
+		}
 		//targum_lexer_remove_comments(&lexer);
 		///*
 		FILE *restrict print_text = fopen("targum_lexer_tokens.txt", "w");
 		assert( print_text != NULL && "failed to create targum_lexer_tokens.txt!" );
 		for( const struct TargumTokenInfo *ti = targum_lexer_advance(&lexer, true); ti != NULL && ti->tag != 0; ti = targum_lexer_advance(&lexer, true) ) {
-			fprintf(print_text, "token info:\n\tlexeme: '%s' | len: %zu\n\tfilename: '%s'\n\ttoken value: '%u'\n\tpos:: start: '%zu', end: '%zu', line: '%zu', col: '%zu'\n\n", ti->lexeme.cstr, ti->lexeme.len, ti->filename->cstr, ti->tag, ti->start, ti->end, ti->line, ti->col);
+			fprintf(print_text, "token info:\n\tlexeme: '%s' | len: %zu\n\tfilename: '%s'\n\ttoken value: '%u'\n\tpos:: start: '%zu', end: '%zu', line: '%zu', col: '%zu'\n\n", harbol_string_cstr(&ti->lexeme), ti->lexeme.len, harbol_string_cstr(ti->filename), ti->tag, ti->start, ti->end, ti->line, ti->col);
 		}
 		fclose(print_text), print_text=NULL;
 		//*/
@@ -1,3 +1,4 @@
+#define HARBOL_ALLOC_CATEGORY    HarbolAllocCategory_Cfg
 #include "variant.h"
 
 #ifdef OS_WINDOWS
@@ -15,23 +16,36 @@ HARBOL_EXPORT struct HarbolVariant *harbol_variant_new(void *const restrict val,
 
 HARBOL_EXPORT struct HarbolVariant harbol_variant_create(void *const restrict val, const size_t datasize, const int32_t type_flags)
 {
-	struct HarbolVariant v = {NULL, datasize, type_flags};
-	v.data = harbol_alloc(v.datasize, sizeof *v.data);
-	if( v.data != NULL ) {
-		memcpy(v.data, val, v.datasize);
+	struct HarbolVariant v = { .datasize = datasize, .tag = type_flags };
+	if( v.datasize <= HARBOL_VARIANT_INLINE_SIZE ) {
+		if( v.datasize != 0 )
+			memcpy(v.data.buf, val, v.datasize);
+	} else {
+		v.data.ptr = harbol_alloc(v.datasize, sizeof *v.data.ptr);
+		if( v.data.ptr != NULL )
+			memcpy(v.data.ptr, val, v.datasize);
 	}
 	return v;
 }
 
 HARBOL_EXPORT bool harbol_variant_clear(struct HarbolVariant *const variant, void dtor(void**))
 {
-	if( variant->datasize==0 || variant->data==NULL )
+	if( variant->datasize==0 )
+		return false;
+	else if( variant->datasize <= HARBOL_VARIANT_INLINE_SIZE ) {
+		if( dtor != NULL ) {
+			void *val = variant->data.buf;
+			dtor(&val);
+		}
+		memset(variant->data.buf, 0, sizeof variant->data.buf);
+		return true;
+	} else if( variant->data.ptr==NULL ) {
 		return false;
-	else {
+	} else {
 		if( dtor != NULL )
-			dtor((void**)&variant->data);
-		if( variant->data != NULL )
-			harbol_free(variant->data), variant->data=NULL;
+			dtor((void**)&variant->data.ptr);
+		if( variant->data.ptr != NULL )
+			harbol_free(variant->data.ptr), variant->data.ptr=NULL;
 		return true;
 	}
 }
@@ -43,21 +57,18 @@ HARBOL_EXPORT bool harbol_variant_free(struct HarbolVariant **const variantref,
 	return true;
 }
 
-HARBOL_EXPORT void *harbol_variant_get(const struct HarbolVariant *const variant)
-{
-	return( variant->datasize==0 || variant->data==NULL ) ? NULL : variant->data;
-}
+extern void *harbol_variant_get(const struct HarbolVariant *variant);
 
 HARBOL_EXPORT bool harbol_variant_set(struct HarbolVariant *const restrict variant, void *const restrict val)
 {
 	if( variant->datasize==0 )
 		return false;
-	else if( variant->data==NULL ) {
-		variant->data = harbol_alloc(variant->datasize, sizeof *variant->data);
-		return( variant->data==NULL ) ? false : memcpy(variant->data, val, variant->datasize) != NULL;
-	} else {
-		return memcpy(variant->data, val, variant->datasize) != NULL;
+	else if( variant->datasize > HARBOL_VARIANT_INLINE_SIZE && variant->data.ptr==NULL ) {
+		variant->data.ptr = harbol_alloc(variant->datasize, sizeof *variant->data.ptr);
+		if( variant->data.ptr==NULL )
+			return false;
 	}
+	return memcpy(harbol_variant_get(variant), val, variant->datasize) != NULL;
 }
 
 HARBOL_EXPORT NO_NULL int32_t harbol_variant_tag(const struct HarbolVariant *variant)
@@ -33,21 +33,42 @@ enum HarbolType {
 	HarbolType_Ptr = 0x40000000,
 };
 
+#ifndef HARBOL_VARIANT_INLINE_SIZE
+#	define HARBOL_VARIANT_INLINE_SIZE    16
+#endif
+
+/* values up to HARBOL_VARIANT_INLINE_SIZE bytes are kept inside the struct, bigger ones go to a heap buffer at `data.ptr`.
+ * an inline value moves with the struct so always go through `harbol_variant_get` for it.
+ */
 struct HarbolVariant {
-	uint8_t *data; size_t datasize;
+	union {
+		uint8_t   *ptr;
+		uint8_t    buf[HARBOL_VARIANT_INLINE_SIZE];
+		intmax_t   align_int;
+		floatmax_t align_float;
+	} data;
+	size_t datasize;
 	int32_t tag;
 };
 
 
 HARBOL_EXPORT NO_NULL struct HarbolVariant *harbol_variant_new(void *val, size_t datasize, int32_t type_flags);
 HARBOL_EXPORT NO_NULL struct HarbolVariant harbol_variant_create(void *val, size_t datasize, int32_t type_flags);
+/// an inline value can't be freed, `dtor` gets a pointer to it & must only release what the value owns.
 HARBOL_EXPORT NEVER_NULL(1) bool harbol_variant_clear(struct HarbolVariant *variant, void dtor(void**));
 HARBOL_EXPORT NEVER_NULL(1) bool harbol_variant_free(struct HarbolVariant **variantref, void dtor(void**));
 
-HARBOL_EXPORT NO_NULL void *harbol_variant_get(const struct HarbolVariant *variant);
 HARBOL_EXPORT NO_NULL bool harbol_variant_set(struct HarbolVariant *variant, void *val);
 HARBOL_EXPORT NO_NULL int32_t harbol_variant_tag(const struct HarbolVariant *variant);
 
+/// the stored value, NULL if there's none.
+inline NO_NULL void *harbol_variant_get(const struct HarbolVariant *const variant)
+{
+	if( variant->datasize > HARBOL_VARIANT_INLINE_SIZE )
+		return variant->data.ptr;
+	else return( variant->datasize==0 ) ? NULL : ( uint8_t* )variant->data.buf;
+}
+
 
 /********************************************************************/
 
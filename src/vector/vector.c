@@ -1,3 +1,4 @@
+#define HARBOL_ALLOC_CATEGORY    HarbolAllocCategory_Vector
 #include "vector.h"
 
 #ifdef OS_WINDOWS
@@ -95,8 +96,9 @@ HARBOL_EXPORT bool harbol_vector_insert(struct HarbolVector *const restrict v, v
 	if( v->datasize==0 )
 		return false;
 	else {
-		if( v->table==NULL || v->count >= v->len )
-			harbol_vector_resize(v);
+		/// out of memory (or over an allocator's quota), don't write past the table.
+		if( (v->table==NULL || v->count >= v->len) && !harbol_vector_resize(v) )
+			return false;
 		
 		memcpy(&v->table[v->count * v->datasize], val, v->datasize);
 		v->count++;
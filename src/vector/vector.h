@@ -45,6 +45,136 @@ HARBOL_EXPORT NO_NULL void harbol_vector_copy(struct HarbolVector *vecA, const s
 
 HARBOL_EXPORT size_t harbol_vector_count_item(const struct HarbolVector *v, void *val);
 HARBOL_EXPORT NO_NULL index_t harbol_vector_index_of(const struct HarbolVector *v, void *val, uindex_t starting_index);
+
+
+/* HARBOL_VECTOR_DEFINE(T) makes `struct TVector`, a vector of `struct T` with the element size known at compile time,
+ * plus static inline `harbol_vector_{reserve,emplace,push,get,clear}_T` for it.
+ * a zeroed struct is an empty vector & a full one doubles through realloc.
+ * HARBOL_VECTOR_DEFINE_NAMED(name, type) does the same for any element type, naming everything after `name`.
+ */
+#define HARBOL_VECTOR_DEFINE(T)    HARBOL_VECTOR_DEFINE_NAMED(T, struct T)
+
+#define HARBOL_VECTOR_DEFINE_NAMED(name, type) \
+	struct name##Vector { \
+		type *table; \
+		size_t len, count; \
+	}; \
+	\
+	static inline NO_NULL bool harbol_vector_reserve_##name(struct name##Vector *const vec, const size_t cap) \
+	{ \
+		if( cap <= vec->len ) \
+			return true; \
+		else if( cap > SIZE_MAX / sizeof *vec->table ) \
+			return false; \
+		\
+		type *const table = harbol_realloc(vec->table, cap * sizeof *table); \
+		if( table==NULL ) \
+			return false; \
+		vec->table = table; \
+		vec->len = cap; \
+		return true; \
+	} \
+	\
+	/* a new slot at the end for the caller to fill in, NULL if the vector couldn't grow. */ \
+	static inline NO_NULL type *harbol_vector_emplace_##name(struct name##Vector *const vec) \
+	{ \
+		if( vec->count==vec->len && !harbol_vector_reserve_##name(vec, (vec->len==0) ? VEC_DEFAULT_SIZE : vec->len << 1) ) \
+			return NULL; \
+		return &vec->table[vec->count++]; \
+	} \
+	\
+	static inline NO_NULL bool harbol_vector_push_##name(struct name##Vector *const restrict vec, const type *const restrict val) \
+	{ \
+		type *const slot = harbol_vector_emplace_##name(vec); \
+		if( slot==NULL ) \
+			return false; \
+		*slot = *val; \
+		return true; \
+	} \
+	\
+	static inline NO_NULL type *harbol_vector_get_##name(const struct name##Vector *const vec, const size_t index) \
+	{ \
+		return( index < vec->count ) ? &vec->table[index] : NULL; \
+	} \
+	\
+	static inline NO_NULL void harbol_vector_clear_##name(struct name##Vector *const vec) \
+	{ \
+		harbol_free(vec->table), vec->table=NULL; \
+		vec->len = vec->count = 0; \
+	}
+
+/* HARBOL_SEG_VECTOR_DEFINE(T, shift) makes `struct TSegVector`, a vector of `struct T` kept in blocks of `1 << shift` elements
+ * plus static inline `harbol_seg_vector_{reserve,emplace,push,get,truncate,clear}_T` for it.
+ * only the block directory is ever reallocated, so an element never moves & pointers to it stay valid until the vector is cleared.
+ * truncating keeps the blocks around to be reused by the next pushes.
+ */
+#define HARBOL_SEG_VECTOR_DEFINE(T, shift)    HARBOL_SEG_VECTOR_DEFINE_NAMED(T, struct T, shift)
+
+#define HARBOL_SEG_VECTOR_DEFINE_NAMED(name, type, shift) \
+	struct name##SegVector { \
+		type **blocks; \
+		size_t dir_len, block_count, count; \
+	}; \
+	\
+	static inline NO_NULL bool harbol_seg_vector_reserve_##name(struct name##SegVector *const vec, const size_t cap) \
+	{ \
+		const size_t blocks_needed = (cap >> (shift)) + ((cap & (((size_t)1 << (shift)) - 1)) != 0); \
+		if( blocks_needed > vec->dir_len ) { \
+			size_t dir_len = ( vec->dir_len==0 ) ? VEC_DEFAULT_SIZE : vec->dir_len; \
+			while( dir_len < blocks_needed ) \
+				dir_len <<= 1; \
+			if( dir_len > SIZE_MAX / sizeof *vec->blocks ) \
+				return false; \
+			type **const blocks = harbol_realloc(vec->blocks, dir_len * sizeof *blocks); \
+			if( blocks==NULL ) \
+				return false; \
+			vec->blocks = blocks; \
+			vec->dir_len = dir_len; \
+		} \
+		for( ; vec->block_count < blocks_needed; vec->block_count++ ) { \
+			vec->blocks[vec->block_count] = harbol_alloc((size_t)1 << (shift), sizeof **vec->blocks); \
+			if( vec->blocks[vec->block_count]==NULL ) \
+				return false; \
+		} \
+		return true; \
+	} \
+	\
+	/* a new slot at the end for the caller to fill in, NULL if there was no room for another block. */ \
+	static inline NO_NULL type *harbol_seg_vector_emplace_##name(struct name##SegVector *const vec) \
+	{ \
+		const size_t block = vec->count >> (shift); \
+		if( block==vec->block_count && !harbol_seg_vector_reserve_##name(vec, vec->count + 1) ) \
+			return NULL; \
+		return &vec->blocks[block][vec->count++ & (((size_t)1 << (shift)) - 1)]; \
+	} \
+	\
+	static inline NO_NULL bool harbol_seg_vector_push_##name(struct name##SegVector *const restrict vec, const type *const restrict val) \
+	{ \
+		type *const slot = harbol_seg_vector_emplace_##name(vec); \
+		if( slot==NULL ) \
+			return false; \
+		*slot = *val; \
+		return true; \
+	} \
+	\
+	static inline NO_NULL type *harbol_seg_vector_get_##name(const struct name##SegVector *const vec, const size_t index) \
+	{ \
+		return( index < vec->count ) ? &vec->blocks[index >> (shift)][index & (((size_t)1 << (shift)) - 1)] : NULL; \
+	} \
+	\
+	static inline NO_NULL void harbol_seg_vector_truncate_##name(struct name##SegVector *const vec, const size_t count) \
+	{ \
+		if( count < vec->count ) \
+			vec->count = count; \
+	} \
+	\
+	static inline NO_NULL void harbol_seg_vector_clear_##name(struct name##SegVector *const vec) \
+	{ \
+		for( size_t i=0; i<vec->block_count; i++ ) \
+			harbol_free(vec->blocks[i]); \
+		harbol_free(vec->blocks), vec->blocks=NULL; \
+		vec->dir_len = vec->block_count = vec->count = 0; \
+	}
 /********************************************************************/
 
 